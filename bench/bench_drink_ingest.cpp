@@ -0,0 +1,200 @@
+// 多来源饮水汇入的竞争测试：1/2/4/8 个生产者线程同时 submit，状态线程把记录
+// 依次应用到 PlantSystem (含事件日志与按日日志写盘)，同时两个读者线程不停
+// 读取 snapshot()。报告端到端吞吐、submit() 与 snapshot() 的延迟分位数；
+// 另测只有 MpscQueue 本身时的吞吐，以及无人写入时的读取延迟作对照。
+// 同一天的记录越多，每次写入分离复制今日记录的开销越大，故默认每轮只喝
+// <drinks> 杯 (默认 2000)。用法: bench_drink_ingest [drinks]
+#include "../src/core/drink_ingest.hpp"
+#include "../src/core/mpsc_queue.hpp"
+#include "../src/core/plant_system.hpp"
+#include <QCoreApplication>
+#include <QDir>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock SteadyClock;
+
+const int kReaders = 2;
+const size_t kMaxSamples = 1 << 18; // 每个线程最多保留的延迟样本
+
+std::atomic<quint64> g_sink(0); // 防止读取被优化掉
+
+qint64 nanosSince(SteadyClock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             SteadyClock::now() - start)
+      .count();
+}
+
+struct Samples {
+  Samples() : count(0) { values.reserve(kMaxSamples); }
+  void add(qint64 ns) {
+    if (values.size() < kMaxSamples)
+      values.push_back(ns);
+    else
+      values[count % kMaxSamples] = ns; // 写满后循环覆盖
+    ++count;
+  }
+  std::vector<qint64> values;
+  quint64 count;
+};
+
+void merge(std::vector<Samples> &parts, std::vector<qint64> *out) {
+  out->clear();
+  for (const Samples &part : parts)
+    out->insert(out->end(), part.values.begin(), part.values.end());
+  std::sort(out->begin(), out->end());
+}
+
+qint64 percentile(const std::vector<qint64> &sorted, double p) {
+  if (sorted.empty())
+    return 0;
+  return sorted[std::min(sorted.size() - 1, size_t(sorted.size() * p))];
+}
+
+void printLatency(QTextStream &out, const char *label,
+                  const std::vector<qint64> &sorted) {
+  out << "  " << label << " p50 " << percentile(sorted, 0.5) << " ns, p99 "
+      << percentile(sorted, 0.99) << " ns, max "
+      << (sorted.empty() ? 0 : sorted.back()) << " ns" << endl;
+}
+
+// 读者线程：直到 stop 置位前不停取快照，记录每次 snapshot() 的耗时
+void runReaders(PlantSystem *plant, std::atomic<bool> *stop,
+                std::vector<Samples> *samples,
+                std::vector<std::thread> *threads) {
+  samples->assign(kReaders, Samples());
+  for (int r = 0; r < kReaders; ++r) {
+    threads->emplace_back([plant, stop, samples, r]() {
+      Samples &mine = (*samples)[r];
+      quint64 sink = 0;
+      while (!stop->load(std::memory_order_relaxed)) {
+        SteadyClock::time_point start = SteadyClock::now();
+        PlantSnapshotPtr snapshot = plant->snapshot();
+        mine.add(nanosSince(start));
+        sink += snapshot->state.dayIntake;
+      }
+      g_sink.fetch_add(sink, std::memory_order_relaxed);
+    });
+  }
+}
+
+void runIngest(QTextStream &out, PlantSystem *plant, DrinkIngest *ingest,
+               int producers, int drinks) {
+  std::atomic<bool> stop(false);
+  std::vector<Samples> readSamples;
+  std::vector<std::thread> readers;
+  runReaders(plant, &stop, &readSamples, &readers);
+
+  const int perProducer = drinks / producers;
+  const quint64 target =
+      ingest->applied() + quint64(perProducer) * quint64(producers);
+  std::vector<Samples> submitSamples(producers);
+  std::vector<std::thread> writers;
+  SteadyClock::time_point start = SteadyClock::now();
+  for (int p = 0; p < producers; ++p) {
+    writers.emplace_back([ingest, perProducer, p, &submitSamples]() {
+      for (int i = 0; i < perProducer; ++i) {
+        SteadyClock::time_point t = SteadyClock::now();
+        ingest->submit(200 + i % 100, DrinkIngest::Cli);
+        submitSamples[p].add(nanosSince(t));
+      }
+    });
+  }
+  for (std::thread &writer : writers)
+    writer.join();
+  while (ingest->applied() < target)
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  const double seconds = nanosSince(start) / 1e9;
+  stop.store(true);
+  for (std::thread &reader : readers)
+    reader.join();
+
+  std::vector<qint64> sorted;
+  out << producers << " producer(s): "
+      << qRound(perProducer * producers / seconds) << " drinks/s applied"
+      << endl;
+  merge(submitSamples, &sorted);
+  printLatency(out, "submit()  ", sorted);
+  merge(readSamples, &sorted);
+  printLatency(out, "snapshot()", sorted);
+}
+
+// 只有队列本身：生产者 push，一个消费者 pop
+void runQueueOnly(QTextStream &out, int producers, int items) {
+  MpscQueue<int> queue;
+  const int perProducer = items / producers;
+  std::vector<std::thread> writers;
+  SteadyClock::time_point start = SteadyClock::now();
+  for (int p = 0; p < producers; ++p) {
+    writers.emplace_back([&queue, perProducer]() {
+      for (int i = 0; i < perProducer; ++i)
+        queue.push(i);
+    });
+  }
+  int value = 0;
+  for (int received = 0; received < perProducer * producers;) {
+    if (queue.pop(&value))
+      ++received;
+  }
+  const double seconds = nanosSince(start) / 1e9;
+  for (std::thread &writer : writers)
+    writer.join();
+  out << "  queue only, " << producers << " producer(s): "
+      << qRound(perProducer * producers / seconds / 1e3) << "k items/s"
+      << endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QLoggingCategory::setFilterRules("*.debug=false");
+  QTextStream out(stdout);
+  const int drinks = argc > 1 ? QByteArray(argv[1]).toInt() : 2000;
+
+  // PlantSystem 固定写 ./logs，放进临时目录
+  QTemporaryDir dir;
+  QDir::setCurrent(dir.path());
+
+  QThread plantThread;
+  PlantSystem *plant = new PlantSystem();
+  DrinkIngest *ingest = new DrinkIngest(plant);
+  plant->moveToThread(&plantThread);
+  QObject::connect(&plantThread, &QThread::finished, plant,
+                   &QObject::deleteLater);
+  plantThread.start();
+
+  {
+    // 无人写入时的读取延迟
+    std::atomic<bool> stop(false);
+    std::vector<Samples> samples;
+    std::vector<std::thread> readers;
+    runReaders(plant, &stop, &samples, &readers);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    stop.store(true);
+    for (std::thread &reader : readers)
+      reader.join();
+    std::vector<qint64> sorted;
+    merge(samples, &sorted);
+    out << "idle readers:" << endl;
+    printLatency(out, "snapshot()", sorted);
+  }
+
+  for (int producers : {1, 2, 4, 8}) {
+    runIngest(out, plant, ingest, producers, drinks);
+    runQueueOnly(out, producers, 1000000);
+  }
+
+  plantThread.quit();
+  plantThread.wait();
+  return 0;
+}
@@ -0,0 +1,96 @@
+// 十年历史 (每天 8 杯) 上一年区间的 HistoryQuery 各分组耗时，以及每杯水
+// 追加增量日志与整体重写快照的落盘耗时对比。
+// 用法: bench_history_query [iterations]
+#include "../src/core/history_index.hpp"
+#include "../src/core/history_query.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+const QDate kFirstDay(2016, 1, 1);
+const QDate kLastDay(2025, 12, 31);
+const int kDrinksPerDay = 8;
+
+qint64 g_sink = 0; // 防止查询被优化掉
+
+void fill(HistoryIndex *index) {
+  for (QDate day = kFirstDay; day <= kLastDay; day = day.addDays(1)) {
+    for (int i = 0; i < kDrinksPerDay; ++i)
+      index->add(QDateTime(day, QTime(8 + i * 2, 15)), 200 + i * 10);
+  }
+}
+
+void printNanos(QTextStream &out, const char *label,
+                std::vector<qint64> &samples) {
+  std::sort(samples.begin(), samples.end());
+  out << "  " << label << " p50 " << samples[samples.size() / 2] / 1000.0
+      << " us, p99 " << samples[samples.size() * 99 / 100] / 1000.0
+      << " us" << endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QLoggingCategory::setFilterRules("*.debug=false");
+  QTextStream out(stdout);
+  const int iterations = argc > 1 ? QByteArray(argv[1]).toInt() : 2000;
+
+  QTemporaryDir dir;
+  HistoryIndex index(dir.path());
+  fill(&index);
+  out << "days: " << index.dayCount() << ", one-year range, " << iterations
+      << " iterations" << endl;
+
+  const struct {
+    const char *label;
+    HistoryQuery::GroupBy groupBy;
+  } groups[] = {{"ByHour   ", HistoryQuery::ByHour},
+                {"ByWeekday", HistoryQuery::ByWeekday},
+                {"ByDay    ", HistoryQuery::ByDay},
+                {"ByWeek   ", HistoryQuery::ByWeek},
+                {"ByMonth  ", HistoryQuery::ByMonth}};
+  std::vector<qint64> samples(iterations);
+  QElapsedTimer timer;
+  for (const auto &group : groups) {
+    for (int i = 0; i < iterations; ++i) {
+      // 每次换一个起点，避免总在同一段缓存里
+      const QDate from = kFirstDay.addDays(i % 3000);
+      timer.start();
+      QVector<qint64> totals = HistoryQuery(&index)
+                                   .range(from, from.addDays(364))
+                                   .groupBy(group.groupBy)
+                                   .totals();
+      samples[i] = timer.nsecsElapsed();
+      g_sink += totals.isEmpty() ? 0 : totals.first();
+    }
+    printNanos(out, group.label, samples);
+  }
+
+  // 落盘：先写一次快照，之后每杯水只追加增量日志
+  index.save();
+  const int drinks = qMin(iterations, 1000); // 不触发日志压缩
+  std::vector<qint64> appendSamples(drinks);
+  for (int i = 0; i < drinks; ++i) {
+    timer.start();
+    index.recordDrink(QDateTime(kLastDay, QTime(20, i % 60)), 250);
+    appendSamples[i] = timer.nsecsElapsed();
+  }
+  printNanos(out, "recordDrink (journal)", appendSamples);
+
+  std::vector<qint64> saveSamples(100);
+  for (size_t i = 0; i < saveSamples.size(); ++i) {
+    timer.start();
+    index.save();
+    saveSamples[i] = timer.nsecsElapsed();
+  }
+  printNanos(out, "save() full snapshot ", saveSamples);
+
+  return g_sink == 42 ? 1 : 0;
+}
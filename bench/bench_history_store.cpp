@@ -0,0 +1,92 @@
+// 对比按日文本日志与 SQLite (WAL) 两种历史存储的写入速率与区间查询延迟。
+#include "../src/core/sqlite_history_store.hpp"
+#include "../src/core/text_log_store.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+
+namespace {
+
+const int kDays = 365;
+const int kDrinksPerDay = 8;
+const int kSingleAppends = 2000; // 逐条写入 (与界面上每次记一杯相同)
+const int kQueryRuns = 20;
+const qint64 kStartEpoch = 1700000000; // 2023-11-14
+
+QVector<DrinkEntry> makeEntries() {
+  QVector<DrinkEntry> entries;
+  entries.reserve(kDays * kDrinksPerDay);
+  for (int d = 0; d < kDays; ++d) {
+    for (int i = 0; i < kDrinksPerDay; ++i) {
+      DrinkEntry entry = {
+          QDateTime::fromSecsSinceEpoch(kStartEpoch + d * 86400 + i * 5400),
+          200 + (d + i) % 100, 0, 0, QString("萌芽期")};
+      entries.append(entry);
+    }
+  }
+  return entries;
+}
+
+double medianMs(QVector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+void run(const char *label, HistoryStore *store,
+         const QVector<DrinkEntry> &entries, QTextStream &out) {
+  // 逐条写入
+  QElapsedTimer timer;
+  timer.start();
+  for (int i = 0; i < kSingleAppends; ++i)
+    store->append(entries[i]);
+  double singleRate = kSingleAppends * 1000.0 / qMax<qint64>(1, timer.elapsed());
+
+  // 批量写入其余记录
+  timer.restart();
+  store->appendBatch(entries.mid(kSingleAppends));
+  double batchRate = (entries.size() - kSingleAppends) * 1000.0 /
+                     qMax<qint64>(1, timer.elapsed());
+
+  // 30 天区间查询
+  QVector<double> samples;
+  qint64 sum = 0;
+  for (int r = 0; r < kQueryRuns; ++r) {
+    qint64 from = kStartEpoch + (r * 11 % (kDays - 30)) * 86400;
+    timer.restart();
+    store->readRange(from, from + 30 * 86400,
+                     [&sum](qint64, int ml) { sum += ml; });
+    samples.append(timer.nsecsElapsed() / 1e6);
+  }
+
+  out << label << " append " << qRound64(singleRate) << " rec/s single, "
+      << qRound64(batchRate) << " rec/s batched; 30-day range query median "
+      << medianMs(samples) << " ms (checksum " << sum << ")" << endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QTextStream out(stdout);
+  const QVector<DrinkEntry> entries = makeEntries();
+  out << "records: " << entries.size() << endl;
+
+  QTemporaryDir textDir, sqliteDir;
+  {
+    TextLogStore store(textDir.path());
+    run("text  ", &store, entries, out);
+  }
+  {
+    SqliteHistoryStore store(sqliteDir.path(), HistoryStore::ReadWrite);
+    if (!store.isOpen()) {
+      out << "无法打开 SQLite 数据库" << endl;
+      return 1;
+    }
+    run("sqlite", &store, entries, out);
+  }
+  return 0;
+}
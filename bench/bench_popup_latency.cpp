@@ -0,0 +1,82 @@
+// 测量提醒弹窗从触发到首帧绘制的延迟，并检查预热后的延迟预算。
+// 同时对比 PopupWidget 与 RasterPopup 两种实现。
+// 使用 offscreen 平台插件，可在无显示器的 CI 上运行。
+#include "../src/core/metrics.hpp"
+#include "../src/ui/popup_widget.hpp"
+#include "../src/ui/raster_popup.hpp"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+
+namespace {
+
+const int kIterations = 50;
+const double kBudgetP95Ms = 16.0; // 预热后一帧以内
+
+// 两种弹窗都在首帧绘制时记录一次 popupLatency，以此判断首帧已完成
+template <typename Popup> double triggerToFirstPaintMs(Popup *popup) {
+  const Metrics::Histogram &latency = Metrics::registry().popupLatency;
+  quint64 before = latency.count();
+  QElapsedTimer timer;
+  timer.start();
+  popup->showAnimated();
+  while (latency.count() == before && timer.elapsed() < 5000)
+    QApplication::processEvents(QEventLoop::AllEvents, 1);
+  return timer.nsecsElapsed() / 1e6;
+}
+
+double percentile(QVector<double> samples, double p) {
+  std::sort(samples.begin(), samples.end());
+  int index = qBound(0, static_cast<int>(p * (samples.size() - 1) + 0.5),
+                     samples.size() - 1);
+  return samples[index];
+}
+
+template <typename Popup>
+bool run(const char *label, QTextStream &out) {
+  // 冷启动：构造后立即触发，预热尚未在事件循环中执行
+  double coldMs = 0;
+  {
+    Popup popup;
+    coldMs = triggerToFirstPaintMs(&popup);
+  }
+
+  Popup popup;
+  QVector<double> warm;
+  for (int i = 0; i < kIterations; ++i) {
+    popup.setReminderStyle(i % 4);
+    QApplication::processEvents(); // 空闲：执行预热
+    warm.append(triggerToFirstPaintMs(&popup));
+    popup.hide();
+    QApplication::processEvents();
+  }
+
+  double p95 = percentile(warm, 0.95);
+  out << label << ": cold " << coldMs << " ms, warm p50 "
+      << percentile(warm, 0.5) << " ms, p95 " << p95 << " ms, "
+      << popup.template findChildren<QObject *>().size() + 1 << " QObjects"
+      << endl;
+  return p95 <= kBudgetP95Ms;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  QApplication app(argc, argv);
+  QTextStream out(stdout);
+
+  out << "trigger-to-first-paint (budget p95 " << kBudgetP95Ms << " ms)"
+      << endl;
+  bool widgetOk = run<PopupWidget>("PopupWidget ", out);
+  bool rasterOk = run<RasterPopup>("RasterPopup ", out);
+
+  if (!widgetOk || !rasterOk) {
+    out << "OVER BUDGET" << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+// 对比旧的 QList<{QDateTime, int}> 与列式 DrinkRecordStore 在 100 万条记录
+// 下的内存占用与扫描耗时。
+#include "../src/core/drink_record_store.hpp"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QTextStream>
+#include <limits>
+#include <unistd.h>
+
+namespace {
+
+const int kRecords = 1000000;
+const qint64 kStartEpoch = 1700000000; // 2023-11-14
+
+struct LegacyRecord {
+  QDateTime timestamp;
+  int amount;
+};
+
+qint64 currentRss() {
+  QFile statm("/proc/self/statm");
+  if (!statm.open(QIODevice::ReadOnly))
+    return 0;
+  QList<QByteArray> fields = statm.readAll().split(' ');
+  return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE)
+                           : 0;
+}
+
+} // namespace
+
+int main() {
+  QTextStream out(stdout);
+  out << "records: " << kRecords << endl;
+
+  qint64 legacySum = 0, storeSum = 0;
+  // 先测小的一方，避免旧结构释放后的堆被复用导致 RSS 差值失真
+  {
+    qint64 rssBefore = currentRss();
+    QElapsedTimer timer;
+    timer.start();
+    DrinkRecordStore store;
+    store.reserve(kRecords);
+    for (int i = 0; i < kRecords; ++i)
+      store.append(kStartEpoch + i * 600, 200 + i % 100);
+    qint64 buildMs = timer.elapsed();
+    qint64 bytes = currentRss() - rssBefore;
+
+    timer.restart();
+    storeSum =
+        store.totalAmount(kStartEpoch + 86400 * 30,
+                          std::numeric_limits<qint64>::max());
+    qint64 scanUs = timer.nsecsElapsed() / 1000;
+
+    out << "DrinkRecordStore    build " << buildMs << " ms, ~"
+        << bytes / kRecords << " B/record (" << store.memoryUsage() / kRecords
+        << " B allocated), range scan " << scanUs << " us" << endl;
+  }
+
+  {
+    qint64 rssBefore = currentRss();
+    QElapsedTimer timer;
+    timer.start();
+    QList<LegacyRecord> legacy;
+    legacy.reserve(kRecords);
+    for (int i = 0; i < kRecords; ++i) {
+      LegacyRecord record;
+      record.timestamp = QDateTime::fromSecsSinceEpoch(kStartEpoch + i * 600);
+      record.amount = 200 + i % 100;
+      legacy.append(record);
+    }
+    qint64 buildMs = timer.elapsed();
+    qint64 bytes = currentRss() - rssBefore;
+
+    timer.restart();
+    qint64 fromEpoch = kStartEpoch + 86400 * 30;
+    QDateTime from = QDateTime::fromSecsSinceEpoch(fromEpoch);
+    for (const LegacyRecord &record : legacy) {
+      if (record.timestamp >= from)
+        legacySum += record.amount;
+    }
+    qint64 scanUs = timer.nsecsElapsed() / 1000;
+
+    out << "QList<DrinkRecord>  build " << buildMs << " ms, ~"
+        << bytes / kRecords << " B/record, range scan " << scanUs << " us"
+        << endl;
+  }
+
+  if (legacySum != storeSum) {
+    out << "MISMATCH: " << legacySum << " != " << storeSum << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,137 @@
+// 多用户守护进程的扩展性：在虚拟时钟上模拟 <users> 个用户 (默认 500) 一整天，
+// 对比每个用户一个 ReminderEngine (即各自的 Oasis 进程中的调度部分) 与共享
+// 一个 ReminderScheduler 时的唤醒次数和每用户内存。另以十分之一的用户数再跑
+// 一遍，看两者随用户数的增长。用法: bench_reminder_daemon [users]
+#include "../src/core/clock.hpp"
+#include "../src/core/metrics.hpp"
+#include "../src/core/reminder_engine.hpp"
+#include "../src/core/reminder_scheduler.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include <QVector>
+#include <unistd.h>
+
+namespace {
+
+const qint64 kStartMSecs = 1736121600000LL; // 2025-01-06 00:00 UTC
+const qint64 kDayMSecs = 24 * 3600 * 1000LL;
+
+qint64 currentRss() {
+  QFile statm("/proc/self/statm");
+  if (!statm.open(QIODevice::ReadOnly))
+    return 0;
+  QList<QByteArray> fields = statm.readAll().split(' ');
+  return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE)
+                           : 0;
+}
+
+// 用户设置有一定分布：间隔 30..90 分钟，约四分之一用固定时刻，
+// 一半开启免打扰，少数暂停
+ReminderScheduler::Config configFor(int user) {
+  ReminderScheduler::Config config;
+  config.intervalMinutes = 30 + (user * 7) % 61;
+  config.fixedMode = user % 4 == 0;
+  config.moments << QTime(9 + user % 3, (user * 5) % 60)
+                 << QTime(14, (user * 11) % 60) << QTime(17, 30);
+  config.dndEnabled = user % 2 == 0;
+  config.paused = user % 50 == 0;
+  config.style = user % 4;
+  return config;
+}
+
+struct Result {
+  quint64 wakeups;
+  quint64 reminders;
+  qint64 bytesPerUser;
+  qint64 elapsedMs;
+};
+
+Result runScheduler(int users) {
+  VirtualClock clock(kStartMSecs);
+  Clock::setInstance(&clock);
+  Result result = {0, 0, 0, 0};
+  QElapsedTimer timer;
+  timer.start();
+  {
+    qint64 rssBefore = currentRss();
+    ReminderScheduler scheduler;
+    QObject::connect(&scheduler, &ReminderScheduler::reminderDue,
+                     [&result](quint32, int, int) { ++result.reminders; });
+    for (int u = 0; u < users; ++u)
+      scheduler.setUser(1000 + u, configFor(u));
+    result.bytesPerUser = (currentRss() - rssBefore) / users;
+    clock.advanceBy(kDayMSecs);
+    result.wakeups = scheduler.wakeups();
+  }
+  result.elapsedMs = timer.elapsed();
+  Clock::setInstance(nullptr);
+  return result;
+}
+
+// 每个用户一个 ReminderEngine：每次提醒到期都是一次唤醒，免打扰期间被跳过的
+// 提醒同样需要唤醒 (固定时刻模式的整点兜底唤醒未计入，实际只多不少)
+Result runEngines(int users) {
+  VirtualClock clock(kStartMSecs);
+  Clock::setInstance(&clock);
+  Metrics::Registry &metrics = Metrics::registry();
+  const quint64 firedBefore = metrics.remindersFired.value();
+  const quint64 suppressedBefore = metrics.remindersSuppressed.value();
+  Result result = {0, 0, 0, 0};
+  QElapsedTimer timer;
+  timer.start();
+  {
+    qint64 rssBefore = currentRss();
+    QVector<ReminderEngine *> engines;
+    for (int u = 0; u < users; ++u) {
+      ReminderScheduler::Config config = configFor(u);
+      ReminderEngine *engine = new ReminderEngine();
+      engine->setMode(config.fixedMode ? ReminderEngine::FixedMomentMode
+                                       : ReminderEngine::IntervalMode);
+      engine->setInterval(config.intervalMinutes);
+      engine->setFixedMoments(config.moments);
+      engine->setDNDRange(config.dndStart, config.dndEnd);
+      engine->setDNDEnabled(config.dndEnabled);
+      engine->setDND(config.paused);
+      engine->start();
+      engines.append(engine);
+    }
+    result.bytesPerUser = (currentRss() - rssBefore) / users;
+    clock.advanceBy(kDayMSecs);
+    result.reminders = metrics.remindersFired.value() - firedBefore;
+    result.wakeups = result.reminders +
+                     (metrics.remindersSuppressed.value() - suppressedBefore);
+    qDeleteAll(engines);
+  }
+  result.elapsedMs = timer.elapsed();
+  Clock::setInstance(nullptr);
+  return result;
+}
+
+void report(QTextStream &out, const char *label, int users,
+            const Result &result) {
+  out << label << " users " << users << ": " << result.wakeups
+      << " wakeups/day, " << result.reminders << " reminders, ~"
+      << result.bytesPerUser << " B/user, " << result.elapsedMs << " ms"
+      << endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QLoggingCategory::setFilterRules("*.debug=false");
+  QTextStream out(stdout);
+  const int users = argc > 1 ? QByteArray(argv[1]).toInt() : 500;
+  out << "Schedule struct: " << ReminderScheduler::scheduleBytes() << " B"
+      << endl;
+
+  // 先测小的一方，避免释放后的堆被复用导致 RSS 差值失真
+  for (int n : {qMax(1, users / 10), users}) {
+    report(out, "scheduler", n, runScheduler(n));
+    report(out, "engines  ", n, runEngines(n));
+  }
+  return 0;
+}
@@ -0,0 +1,101 @@
+// 团队汇总的吞吐与增量耗时：生成 <users> 个用户 × <years> 年的同步日志
+// (默认 1000 × 5，约 1400 万条)，先全量汇总，再追加一天后增量汇总，
+// 同时报告峰值 RSS。用法: bench_team_aggregate [users] [years]
+#include "../src/core/clock.hpp"
+#include "../src/core/team_aggregator.hpp"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <sys/resource.h>
+
+namespace {
+
+const int kTeams = 20;
+const int kDrinksPerDay = 8;
+
+qint64 peakRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// 每个用户一个设备日志，每天 8 杯，时间与水量带一点扰动
+void writeJournal(const QString &path, int user, qint64 fromDay, int days,
+                  QIODevice::OpenMode mode) {
+  QFile file(path);
+  file.open(QIODevice::WriteOnly | mode);
+  QByteArray buffer;
+  const QDate epoch(1970, 1, 1);
+  for (int d = 0; d < days; ++d) {
+    const QDate day = epoch.addDays(fromDay + d);
+    const qint64 midnight = QDateTime(day, QTime(0, 0)).toSecsSinceEpoch();
+    for (int i = 0; i < kDrinksPerDay; ++i) {
+      qint64 ts = midnight + 8 * 3600 + i * 5400 + (user * 37 + d * 11) % 1800;
+      int ml = 150 + (user * 13 + d * 7 + i * 29) % 200;
+      buffer.append("D ").append(QByteArray::number(ts)).append(' ');
+      buffer.append(QByteArray::number(ml)).append(" @dev").append(
+          QByteArray::number(user));
+      buffer.append(':').append(QByteArray::number(qint64(d) * 8 + i));
+      buffer.append('\n');
+    }
+    if (buffer.size() > (1 << 20)) {
+      file.write(buffer);
+      buffer.clear();
+    }
+  }
+  file.write(buffer);
+}
+
+qint64 runOnce(const QString &root, const QString &out, QTextStream &log,
+               const char *label) {
+  TeamAggregator aggregator(root, out);
+  qint64 events = 0;
+  QObject::connect(&aggregator, &TeamAggregator::finished,
+                   [&](bool ok, qint64 count, qint64, const QString &error) {
+                     if (!ok)
+                       log << "failed: " << error << endl;
+                     events = count;
+                   });
+  QElapsedTimer timer;
+  timer.start();
+  aggregator.run();
+  log << label << ": " << events << " events in " << timer.elapsed()
+      << " ms" << endl;
+  return events;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QTextStream log(stdout);
+  const int users = argc > 1 ? QByteArray(argv[1]).toInt() : 1000;
+  const int years = argc > 2 ? QByteArray(argv[2]).toInt() : 5;
+  const int days = years * 365;
+
+  QTemporaryDir root, out;
+  const qint64 today = QDate(1970, 1, 1).daysTo(Clock::instance()->today());
+  QElapsedTimer timer;
+  timer.start();
+  QVector<QString> paths;
+  for (int u = 0; u < users; ++u) {
+    QDir dir(root.path());
+    QString userDir = QString("team%1/user%2").arg(u % kTeams).arg(u);
+    dir.mkpath(userDir);
+    paths << dir.filePath(userDir + QString("/oasis-dev%1.journal").arg(u));
+    writeJournal(paths.last(), u, today - days, days, QIODevice::Truncate);
+  }
+  log << "generated " << users << " users x " << days << " days in "
+      << timer.elapsed() << " ms" << endl;
+
+  runOnce(root.path(), out.path(), log, "full");
+  for (int u = 0; u < users; ++u)
+    writeJournal(paths[u], u, today, 1, QIODevice::Append);
+  runOnce(root.path(), out.path(), log, "incremental");
+  log << "peak RSS " << peakRssKb() / 1024 << " MB" << endl;
+  return 0;
+}
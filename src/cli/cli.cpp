@@ -0,0 +1,348 @@
+#include "cli.hpp"
+#include "../core/history_exporter.hpp"
+#include "../core/settings_manager.hpp"
+#include "../core/simulation.hpp"
+#include "../core/team_aggregator.hpp"
+#include "../ui/soak.hpp"
+#ifdef Q_OS_UNIX
+#include "../daemon/daemon_protocol.hpp"
+#include "../daemon/reminder_daemon.hpp"
+#endif
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include <cstring>
+
+namespace {
+
+const char *const kCommands[] = {"--export", "--simulate", "--soak",
+                                   "--aggregate", "--daemon"};
+
+// argv 中是否有 command，支持 "--export file" 与 "--export=file" 两种写法
+bool hasCommand(int argc, char *argv[], const char *command) {
+  size_t length = std::strlen(command);
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], command, length) == 0 &&
+        (argv[i][length] == '\0' || argv[i][length] == '='))
+      return true;
+  }
+  return false;
+}
+
+QTextStream &err() {
+  static QTextStream stream(stderr);
+  return stream;
+}
+
+int runExport(const QCommandLineParser &parser) {
+  QString path = parser.value("export");
+  QDate from, to;
+  if (parser.isSet("from")) {
+    from = QDate::fromString(parser.value("from"), "yyyy-MM-dd");
+    if (!from.isValid()) {
+      err() << "无效的 --from 日期: " << parser.value("from") << endl;
+      return 2;
+    }
+  }
+  if (parser.isSet("to")) {
+    to = QDate::fromString(parser.value("to"), "yyyy-MM-dd");
+    if (!to.isValid()) {
+      err() << "无效的 --to 日期: " << parser.value("to") << endl;
+      return 2;
+    }
+  }
+
+  HistoryExporter::Format format = HistoryExporter::formatForPath(path);
+  if (parser.isSet("format"))
+    format = parser.value("format") == "jsonl" ? HistoryExporter::JsonLines
+                                               : HistoryExporter::Csv;
+
+  // 命令行下没有事件循环要守护，直接在当前线程流式导出
+  SettingsManager settings;
+  HistoryExporter exporter("logs", settings.historyBackend());
+  int exitCode = 1;
+  QObject::connect(&exporter, &HistoryExporter::progress,
+                   [](int done, int total) {
+                     err() << QString("\r导出中 %1/%2 天").arg(done).arg(total)
+                           << flush;
+                   });
+  QObject::connect(&exporter, &HistoryExporter::finished,
+                   [&exitCode](bool ok, qint64 records, const QString &error) {
+                     if (ok) {
+                       err() << "\n导出完成，共 " << records << " 条记录"
+                             << endl;
+                       exitCode = 0;
+                     } else {
+                       err() << "\n导出失败: " << error << endl;
+                     }
+                   });
+  exporter.run(from, to, path, format);
+  return exitCode;
+}
+
+QTime parseTime(const QString &text) {
+  return QTime::fromString(text, "HH:mm");
+}
+
+int runSimulate(const QCommandLineParser &parser) {
+  Simulation::Scenario scenario;
+  bool ok = false;
+  scenario.days = parser.value("simulate").toInt(&ok);
+  if (!ok || scenario.days <= 0) {
+    err() << "无效的 --simulate 天数: " << parser.value("simulate") << endl;
+    return 2;
+  }
+  if (parser.isSet("interval")) {
+    scenario.intervalMinutes = parser.value("interval").toInt(&ok);
+    if (!ok || scenario.intervalMinutes <= 0) {
+      err() << "无效的 --interval: " << parser.value("interval") << endl;
+      return 2;
+    }
+  }
+  if (parser.isSet("moments")) {
+    for (const QString &item :
+         parser.value("moments").split(',', QString::SkipEmptyParts)) {
+      QTime moment = parseTime(item.trimmed());
+      if (!moment.isValid()) {
+        err() << "无效的 --moments 时刻: " << item << endl;
+        return 2;
+      }
+      scenario.fixedMoments.append(moment);
+    }
+  }
+  if (parser.isSet("dnd")) {
+    QStringList range = parser.value("dnd").split('-');
+    if (range.size() != 2 || !parseTime(range[0]).isValid() ||
+        !parseTime(range[1]).isValid()) {
+      err() << "无效的 --dnd 时段: " << parser.value("dnd") << endl;
+      return 2;
+    }
+    scenario.dndStart = parseTime(range[0]);
+    scenario.dndEnd = parseTime(range[1]);
+  }
+  if (parser.isSet("pattern") &&
+      !Simulation::parseDrinkPattern(parser.value("pattern"),
+                                     &scenario.drinks)) {
+    err() << "无效的 --pattern: " << parser.value("pattern") << endl;
+    return 2;
+  }
+  if (parser.isSet("skip-every")) {
+    scenario.skipEvery = parser.value("skip-every").toInt(&ok);
+    if (!ok || scenario.skipEvery < 0) {
+      err() << "无效的 --skip-every: " << parser.value("skip-every") << endl;
+      return 2;
+    }
+  }
+
+  // 模拟过程中的调试输出没有意义，只看最终报告
+  QLoggingCategory::setFilterRules("*.debug=false");
+  Simulation::Report report = Simulation::run(scenario);
+
+  QTextStream out(stdout);
+  out << "模拟 " << scenario.days << " 天，耗时 " << report.elapsedMs << " ms"
+      << endl;
+  out << "  提醒: " << report.remindersFired << " (应为 "
+      << report.expectedFired << ")" << endl;
+  out << "  免打扰跳过: " << report.remindersSuppressed << " (应为 "
+      << report.expectedSuppressed << ")" << endl;
+  out << "  饮水: " << report.drinks << " 次" << endl;
+  out << "  枯萎: " << report.wiltingEpisodes << " (应为 "
+      << report.expectedWiltingEpisodes << ")" << endl;
+  out << "  跨天: " << report.rollovers << " (应为 " << scenario.days << ")"
+      << endl;
+  for (const QString &failure : report.failures)
+    err() << "不符: " << failure << endl;
+  out << (report.ok() ? "通过" : "失败") << endl;
+  return report.ok() ? 0 : 1;
+}
+
+int runSoak(const QCommandLineParser &parser) {
+  Soak::Options options;
+  bool ok = false;
+  options.days = parser.value("soak").toInt(&ok);
+  if (!ok || options.days <= 0) {
+    err() << "无效的 --soak 天数: " << parser.value("soak") << endl;
+    return 2;
+  }
+  if (parser.isSet("warmup")) {
+    options.warmupDays = parser.value("warmup").toInt(&ok);
+    if (!ok || options.warmupDays <= 0 || options.warmupDays >= options.days) {
+      err() << "无效的 --warmup: " << parser.value("warmup") << endl;
+      return 2;
+    }
+  }
+  if (parser.isSet("heap-slack")) {
+    options.heapSlackKb = parser.value("heap-slack").toInt(&ok);
+    if (!ok || options.heapSlackKb < 0) {
+      err() << "无效的 --heap-slack: " << parser.value("heap-slack") << endl;
+      return 2;
+    }
+  }
+
+  QLoggingCategory::setFilterRules("*.debug=false");
+  Soak::Report report = Soak::run(options);
+
+  QTextStream out(stdout);
+  out << "耐久测试 " << options.days << " 天，耗时 " << report.elapsedMs
+      << " ms" << endl;
+  out << "  提醒 " << report.reminders << " 次，饮水 " << report.drinks
+      << " 次，刷新 " << report.refreshes << " 次，改设置 "
+      << report.settingsChanges << " 次，周报 " << report.weeklyReports
+      << " 份" << endl;
+  // 大约十行的内存曲线，最后一天总是列出
+  const int step = qMax(1, report.days.size() / 10);
+  for (int i = 0; i < report.days.size(); ++i) {
+    if ((i + 1) % step != 0 && i + 1 != report.days.size())
+      continue;
+    const Soak::DayStats &day = report.days[i];
+    out << QString("  第 %1 天: 对象 %2，RSS %3 KB，堆 %4 KB")
+               .arg(i + 1, 3)
+               .arg(day.liveObjects)
+               .arg(day.rssBytes / 1024)
+               .arg(day.heapBytes / 1024)
+        << endl;
+  }
+  const QList<QPair<QByteArray, int> > grown =
+      ObjectCensus::growth(report.baseline, report.last);
+  for (int i = 0; i < grown.size() && i < 10; ++i)
+    out << "  预热后增加: " << grown[i].first << " +" << grown[i].second
+        << endl;
+  for (const QString &failure : report.failures)
+    err() << "不符: " << failure << endl;
+  out << (report.ok() ? "通过" : "失败") << endl;
+  return report.ok() ? 0 : 1;
+}
+
+int runAggregate(const QCommandLineParser &parser) {
+  TeamAggregator aggregator(parser.value("aggregate"),
+                            parser.isSet("out") ? parser.value("out")
+                                                : QString("aggregate"));
+  if (parser.isSet("goal")) {
+    bool ok = false;
+    int goal = parser.value("goal").toInt(&ok);
+    if (!ok || goal <= 0) {
+      err() << "无效的 --goal: " << parser.value("goal") << endl;
+      return 2;
+    }
+    aggregator.setDefaultGoal(goal);
+  }
+
+  int exitCode = 1;
+  QObject::connect(&aggregator, &TeamAggregator::progress,
+                   [](int done, int total) {
+                     err() << QString("\r汇总中 %1/%2 天").arg(done).arg(total)
+                           << flush;
+                   });
+  QObject::connect(
+      &aggregator, &TeamAggregator::finished,
+      [&exitCode](bool ok, qint64 events, qint64 late, const QString &error) {
+        if (ok) {
+          err() << "\n汇总完成，新增 " << events << " 条饮水记录";
+          if (late > 0)
+            err() << "，累计跳过 " << late << " 条迟到记录";
+          err() << endl;
+          exitCode = 0;
+        } else {
+          err() << "\n汇总失败: " << error << endl;
+        }
+      });
+  aggregator.run();
+  return exitCode;
+}
+
+#ifdef Q_OS_UNIX
+int runDaemon(QCoreApplication &app, const QCommandLineParser &parser) {
+  ReminderDaemon daemon;
+  QString socketPath = parser.isSet("socket")
+                           ? parser.value("socket")
+                           : QString(OasisDaemon::kDefaultSocketPath);
+  if (!daemon.listen(socketPath)) {
+    err() << "无法监听 " << socketPath << endl;
+    return 1;
+  }
+  return app.exec();
+}
+#endif
+
+} // namespace
+
+namespace Cli {
+
+bool isCliInvocation(int argc, char *argv[]) {
+  for (const char *command : kCommands) {
+    if (hasCommand(argc, argv, command))
+      return true;
+  }
+  return false;
+}
+
+bool needsWidgets(int argc, char *argv[]) {
+  return hasCommand(argc, argv, "--soak");
+}
+
+int run(QCoreApplication &app) {
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Oasis 饮水助手命令行工具");
+  parser.addHelpOption();
+  parser.addOption(QCommandLineOption(
+      "export", "把饮水记录导出到 <file> (.csv 或 .jsonl)。", "file"));
+  parser.addOption(
+      QCommandLineOption("from", "起始日期 (yyyy-MM-dd)，默认最早。", "date"));
+  parser.addOption(
+      QCommandLineOption("to", "结束日期 (yyyy-MM-dd)，默认今天。", "date"));
+  parser.addOption(QCommandLineOption(
+      "format", "导出格式 csv|jsonl，默认按扩展名判断。", "format"));
+  parser.addOption(QCommandLineOption(
+      "simulate", "在虚拟时钟上快进模拟 <days> 天并核对结果。", "days"));
+  parser.addOption(QCommandLineOption(
+      "interval", "模拟的提醒间隔 (分钟)，默认 45。", "minutes"));
+  parser.addOption(QCommandLineOption(
+      "moments", "模拟固定时刻提醒，如 09:00,14:00。", "times"));
+  parser.addOption(QCommandLineOption(
+      "dnd", "模拟的免打扰时段，默认 23:00-08:00。", "range"));
+  parser.addOption(QCommandLineOption(
+      "pattern", "每日饮水脚本，如 08:30=250,13:00=300。", "drinks"));
+  parser.addOption(QCommandLineOption(
+      "skip-every", "每隔 <n> 天整天不喝水，默认 7，0 表示不跳过。", "n"));
+  parser.addOption(QCommandLineOption(
+      "soak", "在虚拟时钟上驱动完整界面运行 <days> 天，检查内存是否平稳。",
+      "days"));
+  parser.addOption(QCommandLineOption(
+      "warmup", "耐久测试的预热天数，之后的采样作为基线，默认 7。", "days"));
+  parser.addOption(QCommandLineOption(
+      "heap-slack", "预热后允许的堆内存增长 (KB)，默认 256。", "kb"));
+  parser.addOption(QCommandLineOption(
+      "aggregate", "汇总 <root>/<团队>/<用户>/ 下的同步日志，生成团队看板。",
+      "root"));
+  parser.addOption(QCommandLineOption(
+      "out", "汇总结果与检查点的目录，默认 ./aggregate。", "dir"));
+  parser.addOption(QCommandLineOption(
+      "goal", "用户未设定目标时使用的每日目标 (ml)，默认 2000。", "ml"));
+#ifdef Q_OS_UNIX
+  parser.addOption(QCommandLineOption(
+      "daemon", "以多用户守护进程运行，各会话用 oasis-notifier 接收提醒。"));
+  parser.addOption(QCommandLineOption(
+      "socket", "守护进程的套接字路径，默认 /run/oasis/daemon.sock。",
+      "path"));
+#endif
+  parser.process(app);
+
+  if (parser.isSet("export"))
+    return runExport(parser);
+  if (parser.isSet("simulate"))
+    return runSimulate(parser);
+  if (parser.isSet("soak"))
+    return runSoak(parser);
+  if (parser.isSet("aggregate"))
+    return runAggregate(parser);
+#ifdef Q_OS_UNIX
+  if (parser.isSet("daemon"))
+    return runDaemon(app, parser);
+#endif
+
+  parser.showHelp(2);
+  return 2;
+}
+
+} // namespace Cli
@@ -0,0 +1,21 @@
+#ifndef CLI_HPP
+#define CLI_HPP
+
+class QCoreApplication;
+
+// 无界面的命令行模式，例如:
+//   Oasis --export history.csv --from 2025-01-01 --to 2025-12-31
+//   Oasis --simulate 90 --interval 45 --dnd 23:00-08:00
+//   Oasis --soak 90
+namespace Cli {
+
+// 命令行中是否包含需要以无界面模式运行的命令
+bool isCliInvocation(int argc, char *argv[]);
+// 命令需要驱动真实窗口 (耐久测试)，要用 QApplication 而不是 QCoreApplication
+bool needsWidgets(int argc, char *argv[]);
+
+int run(QCoreApplication &app);
+
+} // namespace Cli
+
+#endif // CLI_HPP
@@ -0,0 +1,109 @@
+#include "clock.hpp"
+#include <QTimer>
+
+namespace {
+
+SystemClock s_systemClock;
+Clock *s_clock = &s_systemClock;
+
+// 每线程的日历缓存
+struct CalendarCache {
+  CalendarCache() : clock(nullptr), secs(0) {}
+  const Clock *clock;
+  qint64 secs;
+  QDateTime dateTime;
+};
+
+} // namespace
+
+QDateTime Clock::now() const {
+  static thread_local CalendarCache cache;
+  const qint64 secs = currentSecs();
+  if (cache.clock != this || cache.secs != secs || !cache.dateTime.isValid()) {
+    cache.clock = this;
+    cache.secs = secs;
+    cache.dateTime = QDateTime::fromSecsSinceEpoch(secs);
+  }
+  return cache.dateTime;
+}
+
+Clock *Clock::instance() { return s_clock; }
+
+void Clock::setInstance(Clock *clock) {
+  s_clock = clock ? clock : &s_systemClock;
+}
+
+qint64 SystemClock::currentMSecs() const {
+  return QDateTime::currentMSecsSinceEpoch();
+}
+
+VirtualClock::VirtualClock(qint64 startMSecs) : m_now(startMSecs) {}
+
+void VirtualClock::advanceTo(qint64 msecs) {
+  while (!m_timers.isEmpty() && m_timers.firstKey() <= msecs) {
+    QMultiMap<qint64, ClockTimer *>::iterator it = m_timers.begin();
+    ClockTimer *timer = it.value();
+    m_now = qMax(m_now, it.key());
+    m_timers.erase(it);
+    timer->fireVirtual();
+  }
+  m_now = qMax(m_now, msecs);
+}
+
+void VirtualClock::registerTimer(ClockTimer *timer, qint64 deadline) {
+  m_timers.insert(deadline, timer);
+}
+
+void VirtualClock::unregisterTimer(ClockTimer *timer, qint64 deadline) {
+  m_timers.remove(deadline, timer);
+}
+
+ClockTimer::ClockTimer(QObject *parent)
+    : QObject(parent), m_timer(new QTimer(this)), m_virtualClock(nullptr),
+      m_deadline(0), m_interval(0), m_singleShot(false) {
+  connect(m_timer, &QTimer::timeout, this, &ClockTimer::timeout);
+}
+
+ClockTimer::~ClockTimer() { stop(); }
+
+void ClockTimer::setTimerType(Qt::TimerType type) {
+  m_timer->setTimerType(type);
+}
+
+void ClockTimer::start(int msec) {
+  stop();
+  m_interval = msec;
+  Clock *clock = Clock::instance();
+  if (clock->isVirtual()) {
+    m_virtualClock = static_cast<VirtualClock *>(clock);
+    m_deadline = m_virtualClock->currentMSecs() + qMax(0, msec);
+    m_virtualClock->registerTimer(this, m_deadline);
+  } else {
+    m_timer->setSingleShot(m_singleShot);
+    m_timer->start(msec);
+  }
+}
+
+void ClockTimer::stop() {
+  m_timer->stop();
+  if (m_virtualClock) {
+    m_virtualClock->unregisterTimer(this, m_deadline);
+    m_virtualClock = nullptr;
+  }
+}
+
+bool ClockTimer::isActive() const {
+  return m_virtualClock != nullptr || m_timer->isActive();
+}
+
+void ClockTimer::fireVirtual() {
+  // VirtualClock 已移除登记；重复定时器按原节拍续期，不累积漂移
+  VirtualClock *clock = m_virtualClock;
+  m_virtualClock = nullptr;
+  if (!m_singleShot) {
+    m_virtualClock = clock;
+    m_deadline += qMax(1, m_interval);
+    clock->registerTimer(this, m_deadline);
+  }
+  emit timeout();
+}
@@ -0,0 +1,91 @@
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <QDateTime>
+#include <QMultiMap>
+#include <QObject>
+
+class ClockTimer;
+class QTimer;
+
+// 可注入的时钟。核心逻辑统一通过 Clock::instance() 取当前时间，
+// 模拟时换成 VirtualClock 即可快进数月。
+// now()/today()/time() 按秒缓存本地日历字段 (每线程一份)，
+// 同一秒内的重复调用不再做时区换算。
+class Clock {
+public:
+  virtual ~Clock() {}
+
+  virtual qint64 currentMSecs() const = 0; // Unix 毫秒
+  virtual bool isVirtual() const { return false; }
+
+  qint64 currentSecs() const { return currentMSecs() / 1000; }
+  QDateTime now() const; // 秒级精度的本地时间
+  QDate today() const { return now().date(); }
+  QTime time() const { return now().time(); }
+
+  static Clock *instance();
+  static void setInstance(Clock *clock); // nullptr 恢复系统时钟；不取得所有权
+};
+
+class SystemClock : public Clock {
+public:
+  qint64 currentMSecs() const override;
+};
+
+// 手动推进的虚拟时钟：advanceTo 按截止时间顺序触发到期的 ClockTimer，
+// 触发时当前时间恰好等于该定时器的截止时间。只能在单一线程中使用。
+class VirtualClock : public Clock {
+public:
+  explicit VirtualClock(qint64 startMSecs);
+
+  qint64 currentMSecs() const override { return m_now; }
+  bool isVirtual() const override { return true; }
+
+  void advanceTo(qint64 msecs);
+  void advanceBy(qint64 msecs) { advanceTo(m_now + msecs); }
+  int pendingTimers() const { return m_timers.size(); }
+
+private:
+  friend class ClockTimer;
+  void registerTimer(ClockTimer *timer, qint64 deadline);
+  void unregisterTimer(ClockTimer *timer, qint64 deadline);
+
+  qint64 m_now;
+  QMultiMap<qint64, ClockTimer *> m_timers;
+};
+
+// 与 QTimer 用法一致的定时器。系统时钟下委托给 QTimer，
+// 虚拟时钟下把截止时间登记到 VirtualClock。
+class ClockTimer : public QObject {
+  Q_OBJECT
+public:
+  explicit ClockTimer(QObject *parent = nullptr);
+  ~ClockTimer();
+
+  void setSingleShot(bool singleShot) { m_singleShot = singleShot; }
+  bool isSingleShot() const { return m_singleShot; }
+  void setInterval(int msec) { m_interval = msec; }
+  int interval() const { return m_interval; }
+  void setTimerType(Qt::TimerType type);
+
+  void start(int msec);
+  void start() { start(m_interval); }
+  void stop();
+  bool isActive() const;
+
+signals:
+  void timeout();
+
+private:
+  friend class VirtualClock;
+  void fireVirtual();
+
+  QTimer *m_timer;
+  VirtualClock *m_virtualClock; // 非空表示已在虚拟时钟上登记
+  qint64 m_deadline;
+  int m_interval;
+  bool m_singleShot;
+};
+
+#endif // CLOCK_HPP
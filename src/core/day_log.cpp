@@ -0,0 +1,131 @@
+#include "day_log.hpp"
+#include <QDir>
+#include <QFile>
+#include <QPair>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+
+namespace {
+
+// "成长值: 20" 取冒号后的部分
+QString fieldValue(const QStringList &parts, int index) {
+  if (index >= parts.size())
+    return QString();
+  const QString &part = parts[index];
+  return part.mid(part.indexOf(':') + 1).trimmed();
+}
+
+int fieldNumber(const QStringList &parts, int index) {
+  QString value = fieldValue(parts, index);
+  value.remove("ml");
+  bool ok = false;
+  const int number = value.toInt(&ok);
+  return ok ? number : -1;
+}
+
+} // namespace
+
+namespace DayLog {
+
+QString fileName(const QDate &day, const QString &dir) {
+  return QString("%1/%2.log").arg(dir, day.toString("yyyy-MM-dd"));
+}
+
+QList<QDate> availableDays(const QString &dir) {
+  QList<QDate> days;
+  const QStringList names =
+      QDir(dir).entryList(QStringList() << "????-??-??.log", QDir::Files,
+                          QDir::Name);
+  for (const QString &name : names) {
+    QDate day = QDate::fromString(name.left(10), "yyyy-MM-dd");
+    if (day.isValid())
+      days << day;
+  }
+  return days;
+}
+
+bool parseLine(const QString &line, QTime *time, int *ml) {
+  QStringList parts = line.split(" | ");
+  if (parts.size() < 4)
+    return false;
+
+  *time = QTime::fromString(parts[0].trimmed(), "hh:mm:ss");
+
+  QString amountStr = parts[1].trimmed();
+  amountStr.remove("ml");
+  bool ok = false;
+  *ml = amountStr.toInt(&ok);
+  return ok && time->isValid();
+}
+
+int readDay(const QDate &day,
+            const std::function<void(const QTime &, int)> &onRecord,
+            const QString &dir) {
+  QFile file(fileName(day, dir));
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return 0;
+
+  QTextStream in(&file);
+  in.setCodec("UTF-8");
+  QVector<QPair<QTime, int> > records;
+  bool sorted = true;
+  QTime time;
+  int ml = 0;
+  while (!in.atEnd()) {
+    if (parseLine(in.readLine(), &time, &ml)) {
+      sorted = sorted && (records.isEmpty() || records.last().first <= time);
+      records.append(qMakePair(time, ml));
+    }
+  }
+  // 同步合并来的较早记录追加在文件末尾，按时间排好再交给调用方
+  if (!sorted)
+    std::stable_sort(records.begin(), records.end(),
+                     [](const QPair<QTime, int> &a,
+                        const QPair<QTime, int> &b) {
+                       return a.first < b.first;
+                     });
+  for (const QPair<QTime, int> &record : records)
+    onRecord(record.first, record.second);
+  return records.size();
+}
+
+bool parseEntry(const QString &line, const QDate &day, DrinkEntry *entry) {
+  QTime time;
+  int ml = 0;
+  if (!parseLine(line, &time, &ml))
+    return false;
+
+  const QStringList parts = line.split(" | ");
+  entry->timestamp = QDateTime(day, time);
+  entry->ml = ml;
+  entry->dayTotal = fieldNumber(parts, 2);
+  entry->growth = fieldNumber(parts, 3);
+  entry->status = fieldValue(parts, 4);
+  if (entry->status == "-")
+    entry->status.clear();
+  return true;
+}
+
+int readEntries(const QDate &day,
+                const std::function<void(const DrinkEntry &)> &onEntry,
+                const QString &dir) {
+  QFile file(fileName(day, dir));
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return 0;
+
+  QTextStream in(&file);
+  in.setCodec("UTF-8");
+  int count = 0;
+  DrinkEntry entry = {QDateTime(), 0, -1, -1, QString()};
+  while (!in.atEnd()) {
+    if (parseEntry(in.readLine(), day, &entry)) {
+      onEntry(entry);
+      ++count;
+    }
+  }
+  return count;
+}
+
+} // namespace DayLog
@@ -0,0 +1,35 @@
+#ifndef DAY_LOG_HPP
+#define DAY_LOG_HPP
+
+#include "history_store.hpp"
+#include <QDate>
+#include <QList>
+#include <QString>
+#include <QTime>
+#include <functional>
+
+// logs/yyyy-MM-dd.log 按日文本日志的命名与解析
+namespace DayLog {
+
+QString fileName(const QDate &day, const QString &dir = "logs");
+
+// 目录中所有存在日志的日期，升序
+QList<QDate> availableDays(const QString &dir = "logs");
+
+// 解析一行 "14:30:25 | 250ml | 今日总量: 500ml | 成长值: 20 | 状态: 萌芽期"
+bool parseLine(const QString &line, QTime *time, int *ml);
+
+// 按时间顺序逐条读取某日日志 (文件中可能乱序)，返回成功解析的记录数
+int readDay(const QDate &day,
+            const std::function<void(const QTime &, int)> &onRecord,
+            const QString &dir = "logs");
+
+// 连同今日总量、成长值、状态一起解析，"-" 或缺失的项记为未知
+bool parseEntry(const QString &line, const QDate &day, DrinkEntry *entry);
+int readEntries(const QDate &day,
+                const std::function<void(const DrinkEntry &)> &onEntry,
+                const QString &dir = "logs");
+
+} // namespace DayLog
+
+#endif // DAY_LOG_HPP
@@ -0,0 +1,48 @@
+#include "drink_ingest.hpp"
+#include "drink_record_store.hpp"
+#include "logging.hpp"
+#include "plant_system.hpp"
+#include "trace.hpp"
+
+DrinkIngest::DrinkIngest(PlantSystem *plant)
+    : QObject(plant), m_plant(plant), m_scheduled(false), m_submitted(0),
+      m_applied(0) {}
+
+bool DrinkIngest::submit(int ml, Source source) {
+  if (ml <= 0 || ml > DrinkRecordStore::kMaxAmount) {
+    qCWarning(lcPlant) << "忽略超出范围的饮水量:" << ml << "来源:" << source;
+    return false;
+  }
+  Submission item = {ml, source};
+  m_queue.push(item);
+  m_submitted.fetch_add(1, std::memory_order_relaxed);
+  schedule();
+  return true;
+}
+
+quint64 DrinkIngest::submitted() const {
+  return m_submitted.load(std::memory_order_relaxed);
+}
+
+quint64 DrinkIngest::applied() const {
+  return m_applied.load(std::memory_order_relaxed);
+}
+
+void DrinkIngest::schedule() {
+  // 一批积压只投递一次，生产者之间不会互相放大事件队列
+  if (!m_scheduled.exchange(true))
+    QMetaObject::invokeMethod(this, "drain", Qt::QueuedConnection);
+}
+
+void DrinkIngest::drain() {
+  OASIS_TRACE_SCOPE("DrinkIngest::drain");
+  Submission item;
+  while (m_queue.pop(&item)) {
+    m_plant->recordDrink(item.ml);
+    m_applied.fetch_add(1, std::memory_order_relaxed);
+  }
+  // 先清除标记再检查：与之并发的 submit 要么被这里看到，要么自己重新投递
+  m_scheduled.store(false);
+  if (!m_queue.isEmpty())
+    schedule();
+}
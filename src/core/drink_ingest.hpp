@@ -0,0 +1,46 @@
+#ifndef DRINK_INGEST_HPP
+#define DRINK_INGEST_HPP
+
+#include "mpsc_queue.hpp"
+#include <QObject>
+#include <atomic>
+
+class PlantSystem;
+
+// 多来源饮水的汇入点。弹窗、托盘以及之后的 IPC、命令行跟随等来源在
+// 任意线程调用 submit()，记录经无锁队列交给 PlantSystem 所在的状态线程
+// 依次处理；处理结果通过 PlantSystem::snapshot() 读取。
+class DrinkIngest : public QObject {
+  Q_OBJECT
+public:
+  enum Source { Popup, Tray, Ipc, Cli };
+
+  // 作为 plant 的子对象创建，随它一起移入状态线程
+  explicit DrinkIngest(PlantSystem *plant);
+
+  // 线程安全且不阻塞；返回 true 后这条记录一定会被处理。
+  // 饮水量不在 (0, DrinkRecordStore::kMaxAmount] 内时丢弃并返回 false
+  bool submit(int ml, Source source);
+
+  quint64 submitted() const;
+  quint64 applied() const;
+
+private slots:
+  void drain(); // 在状态线程中执行
+
+private:
+  struct Submission {
+    int ml;
+    Source source;
+  };
+
+  void schedule();
+
+  PlantSystem *m_plant;
+  MpscQueue<Submission> m_queue;
+  std::atomic<bool> m_scheduled; // 已投递且尚未处理完的 drain
+  std::atomic<quint64> m_submitted;
+  std::atomic<quint64> m_applied;
+};
+
+#endif // DRINK_INGEST_HPP
@@ -0,0 +1,48 @@
+#include "drink_record_store.hpp"
+#include <algorithm>
+
+const int DrinkRecordStore::kMaxAmount;
+
+void DrinkRecordStore::append(qint64 epochSecs, int ml) {
+  m_epochs.append(epochSecs);
+  m_amounts.append(static_cast<quint16>(clampAmount(ml)));
+}
+
+void DrinkRecordStore::reserve(int count) {
+  m_epochs.reserve(count);
+  m_amounts.reserve(count);
+}
+
+void DrinkRecordStore::clear() {
+  m_epochs.clear();
+  m_amounts.clear();
+}
+
+qint64 DrinkRecordStore::totalAmount() const {
+  const quint16 *amounts = m_amounts.constData();
+  const int n = m_amounts.size();
+  qint64 total = 0;
+  for (int i = 0; i < n; ++i)
+    total += amounts[i];
+  return total;
+}
+
+qint64 DrinkRecordStore::totalAmount(qint64 fromEpoch, qint64 toEpoch) const {
+  const quint16 *amounts = m_amounts.constData();
+  const int end = lowerBound(toEpoch);
+  qint64 total = 0;
+  for (int i = lowerBound(fromEpoch); i < end; ++i)
+    total += amounts[i];
+  return total;
+}
+
+int DrinkRecordStore::lowerBound(qint64 epochSecs) const {
+  return static_cast<int>(
+      std::lower_bound(m_epochs.constBegin(), m_epochs.constEnd(), epochSecs) -
+      m_epochs.constBegin());
+}
+
+qint64 DrinkRecordStore::memoryUsage() const {
+  return static_cast<qint64>(m_epochs.capacity()) * sizeof(qint64) +
+         static_cast<qint64>(m_amounts.capacity()) * sizeof(quint16);
+}
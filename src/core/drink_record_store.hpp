@@ -0,0 +1,71 @@
+#ifndef DRINK_RECORD_STORE_HPP
+#define DRINK_RECORD_STORE_HPP
+
+#include <QDateTime>
+#include <QVector>
+
+class DrinkRecordStore;
+
+// 单条记录的轻量视图，只有在界面层需要时才转换为 QDateTime
+class DrinkRecordView {
+public:
+  DrinkRecordView(const DrinkRecordStore *store, int index)
+      : m_store(store), m_index(index) {}
+
+  qint64 epoch() const;
+  int amount() const;
+  QDateTime timestamp() const;
+
+private:
+  const DrinkRecordStore *m_store;
+  int m_index;
+};
+
+// 列式存储的饮水记录：Unix 秒 (int64) 与饮水量 (uint16) 各占一段连续数组，
+// 每条记录 10 字节，按时间追加，扫描对缓存友好。
+class DrinkRecordStore {
+public:
+  static const int kMaxAmount = 65535; // uint16 能表示的最大饮水量
+
+  // 饮水量截到 [0, kMaxAmount]，当日总量与记录都按截断后的值累计
+  static int clampAmount(int ml) { return qBound(0, ml, kMaxAmount); }
+
+  void append(qint64 epochSecs, int ml);
+  void reserve(int count);
+  void clear();
+
+  int size() const { return m_epochs.size(); }
+  bool isEmpty() const { return m_epochs.isEmpty(); }
+
+  qint64 epochAt(int i) const { return m_epochs[i]; }
+  int amountAt(int i) const { return m_amounts[i]; }
+  DrinkRecordView at(int i) const { return DrinkRecordView(this, i); }
+
+  const qint64 *epochs() const { return m_epochs.constData(); }
+  const quint16 *amounts() const { return m_amounts.constData(); }
+
+  qint64 totalAmount() const;
+  // [fromEpoch, toEpoch) 区间内的总量，要求记录按时间有序
+  qint64 totalAmount(qint64 fromEpoch, qint64 toEpoch) const;
+  int lowerBound(qint64 epochSecs) const;
+
+  qint64 memoryUsage() const; // 已分配的字节数
+
+private:
+  QVector<qint64> m_epochs;
+  QVector<quint16> m_amounts;
+};
+
+inline qint64 DrinkRecordView::epoch() const {
+  return m_store->epochAt(m_index);
+}
+
+inline int DrinkRecordView::amount() const {
+  return m_store->amountAt(m_index);
+}
+
+inline QDateTime DrinkRecordView::timestamp() const {
+  return QDateTime::fromSecsSinceEpoch(epoch());
+}
+
+#endif // DRINK_RECORD_STORE_HPP
@@ -0,0 +1,180 @@
+#include "history_backfill.hpp"
+#include "clock.hpp"
+#include "history_index.hpp"
+#include "history_store.hpp"
+#include "logging.hpp"
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+// 分片太小调度开销占比高，太大则尾部负载不均
+const int kDaysPerShard = 16;
+
+struct ShardScanner {
+  typedef BackfillPartial result_type;
+
+  ShardScanner(const QString &dir, const QString &backend)
+      : dir(dir), backend(backend) {}
+  BackfillPartial operator()(const QVector<QDate> &days) const {
+    QScopedPointer<HistoryStore> store(HistoryStore::open(backend, dir));
+    return HistoryBackfill::scanDays(*store, days);
+  }
+
+  QString dir;
+  QString backend;
+};
+
+// 读取 from 及之后各天的全部记录
+DrinkRecordStore readSince(const QString &backend, const QString &dir,
+                           const QDate &from) {
+  DrinkRecordStore records;
+  QScopedPointer<HistoryStore> store(HistoryStore::open(backend, dir));
+  for (const QDate &day : store->availableDays()) {
+    if (day < from)
+      continue;
+    store->readDay(day, [&records, &day](const QTime &time, int ml) {
+      records.append(QDateTime(day, time).toSecsSinceEpoch(), ml);
+    });
+  }
+  return records;
+}
+
+void mergePartial(BackfillPartial &result, const BackfillPartial &partial) {
+  result.days += partial.days;
+  result.hourBins += partial.hourBins;
+  result.records += partial.records;
+}
+
+} // namespace
+
+HistoryBackfill::HistoryBackfill(HistoryIndex *index, const QString &dir,
+                                 const QString &backend, QObject *parent)
+    : QObject(parent), m_index(index), m_writer(nullptr), m_dir(dir),
+      m_backend(backend) {
+  connect(&m_watcher, &QFutureWatcher<BackfillPartial>::progressValueChanged,
+          this, [this](int value) {
+            emit progress(value, m_watcher.progressMaximum());
+          });
+  connect(&m_watcher, &QFutureWatcher<BackfillPartial>::finished, this,
+          &HistoryBackfill::onFinished);
+}
+
+HistoryBackfill::~HistoryBackfill() {
+  m_watcher.cancel();
+  m_watcher.waitForFinished();
+}
+
+void HistoryBackfill::setWriter(QObject *writer) { m_writer = writer; }
+
+BackfillPartial HistoryBackfill::scanDays(const HistoryStore &store,
+                                          const QVector<QDate> &days) {
+  BackfillPartial partial;
+  qint32 bins[24];
+  for (const QDate &day : days) {
+    std::fill(bins, bins + 24, 0);
+    int count = store.readDay(
+        day, [&bins](const QTime &time, int ml) { bins[time.hour()] += ml; });
+    if (count == 0)
+      continue;
+    partial.days.append(day);
+    for (int h = 0; h < 24; ++h)
+      partial.hourBins.append(bins[h]);
+    partial.records += count;
+  }
+  return partial;
+}
+
+void HistoryBackfill::start() {
+  if (isRunning())
+    return;
+
+  // 回填结束前落盘的索引 (例如期间记了一杯水) 都标记为未完成
+  m_index->setComplete(false);
+
+  m_startDay = Clock::instance()->today();
+  QList<QVector<QDate>> shards;
+  QVector<QDate> shard;
+  QScopedPointer<HistoryStore> store(HistoryStore::open(m_backend, m_dir));
+  for (const QDate &day : store->availableDays()) {
+    if (day >= m_startDay)
+      continue;
+    shard.append(day);
+    if (shard.size() == kDaysPerShard) {
+      shards.append(shard);
+      shard.clear();
+    }
+  }
+  if (!shard.isEmpty())
+    shards.append(shard);
+
+  qCDebug(lcHistory) << "开始并行回填历史:" << shards.size() << "个分片，线程数"
+                     << QThreadPool::globalInstance()->maxThreadCount();
+  m_watcher.setFuture(QtConcurrent::mappedReduced(
+      shards, ShardScanner(m_dir, m_backend), mergePartial,
+      QtConcurrent::UnorderedReduce));
+}
+
+void HistoryBackfill::cancel() { m_watcher.cancel(); }
+
+bool HistoryBackfill::isRunning() const { return m_watcher.isRunning(); }
+
+void HistoryBackfill::onFinished() {
+  if (m_watcher.isCanceled()) {
+    qCDebug(lcHistory) << "历史回填已取消";
+    emit finished(false, 0);
+    return;
+  }
+
+  // 分片只含开始那天之前的日子；回填跨过零点时，开始那天到今天都在这里读取
+  const BackfillPartial result = m_watcher.result();
+  const QDate startDay = m_startDay;
+  if (!m_writer) {
+    finish(result, readSince(m_backend, m_dir, startDay));
+    return;
+  }
+  // main 在释放本对象前先停止状态线程并送达其投回的调用，this 不会悬空
+  const QString backend = m_backend;
+  const QString dir = m_dir;
+  QMetaObject::invokeMethod(
+      m_writer,
+      [this, result, backend, dir, startDay]() {
+        const DrinkRecordStore recent = readSince(backend, dir, startDay);
+        QMetaObject::invokeMethod(
+            this, [this, result, recent]() { finish(result, recent); },
+            Qt::QueuedConnection);
+      },
+      Qt::QueuedConnection);
+}
+
+void HistoryBackfill::finish(const BackfillPartial &result,
+                             const DrinkRecordStore &recent) {
+  QElapsedTimer timer;
+  timer.start();
+
+  // 各分片以任意顺序归约，按日期排序后依次追加，避免索引反复前移
+  QVector<int> order(result.days.size());
+  for (int i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [&result](int a, int b) {
+    return result.days[a] < result.days[b];
+  });
+
+  // 回填期间 recordDrink 记下的饮水都已包含在 recent 中，先清空再重建
+  m_index->clear();
+  for (int i : order)
+    m_index->addDay(result.days[i], result.hourBins.constData() + i * 24);
+  for (int i = 0; i < recent.size(); ++i)
+    m_index->add(QDateTime::fromSecsSinceEpoch(recent.epochAt(i)),
+                 recent.amountAt(i));
+  const qint64 records = result.records + recent.size();
+
+  m_index->setComplete(true);
+  m_index->save();
+  qCDebug(lcHistory) << "历史回填完成:" << result.days.size() << "天,"
+                     << records << "条记录，合并耗时" << timer.elapsed()
+                     << "ms";
+  emit finished(true, records);
+}
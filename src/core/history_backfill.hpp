@@ -0,0 +1,65 @@
+#ifndef HISTORY_BACKFILL_HPP
+#define HISTORY_BACKFILL_HPP
+
+#include "drink_record_store.hpp"
+#include <QDate>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QVector>
+
+class HistoryIndex;
+class HistoryStore;
+
+// 一批日期的部分汇总：每个工作线程独立构建，最后再合并
+struct BackfillPartial {
+  BackfillPartial() : records(0) {}
+
+  QVector<QDate> days;
+  QVector<qint32> hourBins; // days.size() * 24
+  qint64 records;
+};
+
+// 首次启用历史视图/汇总/分析时，把历史存储中今天以前的记录回填到
+// HistoryIndex。日期按批分片到线程池，用 QtConcurrent::mappedReduced
+// 在各线程里解析并构建部分汇总，GUI 线程只在结束时合并一次；
+// 开始回填那天及之后的记录仍可能被写入，合并前在写入方的线程里再读取
+// 一次 (见 setWriter)。每个分片在自己的线程里打开只读的存储实例。
+class HistoryBackfill : public QObject {
+  Q_OBJECT
+public:
+  explicit HistoryBackfill(HistoryIndex *index, const QString &dir = "logs",
+                           const QString &backend = "text",
+                           QObject *parent = nullptr);
+  ~HistoryBackfill();
+
+  // 历史存储的写入方 (PlantSystem)。它写入后才发出 drinkRecorded，
+  // 在它的线程里读取近几天的记录，读取前写入的饮水一定已送达索引、
+  // 之后写入的一定排在合并之后，合并时既不重复也不遗漏
+  void setWriter(QObject *writer);
+
+  void start();
+  void cancel();
+  bool isRunning() const;
+
+  static BackfillPartial scanDays(const HistoryStore &store,
+                                  const QVector<QDate> &days);
+
+signals:
+  void progress(int done, int total); // 已完成的分片数
+  void finished(bool ok, qint64 records);
+
+private slots:
+  void onFinished();
+
+private:
+  void finish(const BackfillPartial &result, const DrinkRecordStore &recent);
+
+  HistoryIndex *m_index;
+  QObject *m_writer;
+  QDate m_startDay; // 分片只含此前的日子
+  QString m_dir;
+  QString m_backend;
+  QFutureWatcher<BackfillPartial> m_watcher;
+};
+
+#endif // HISTORY_BACKFILL_HPP
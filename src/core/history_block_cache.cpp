@@ -0,0 +1,160 @@
+#include "history_block_cache.hpp"
+#include "history_store.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+namespace {
+const int kDefaultBudgetKb = 512;
+// 块本身及缓存节点的固定开销
+const int kBlockOverheadBytes = 96;
+
+qint64 dayStartEpoch(const QDate &day) {
+  return QDateTime(day, QTime(0, 0)).toSecsSinceEpoch();
+}
+
+// 在工作线程中执行：每次加载各自打开只读实例，与导出、回填一致
+HistoryBlockCache::BlockPtr loadBlock(const QString &backend,
+                                      const QString &dir,
+                                      const QDate &weekStart) {
+  OASIS_TRACE_SCOPE("HistoryBlockCache::loadBlock");
+  QSharedPointer<HistoryBlock> block(new HistoryBlock);
+  block->weekStart = weekStart;
+  QScopedPointer<HistoryStore> store(HistoryStore::open(backend, dir));
+  if (store && store->isOpen()) {
+    DrinkRecordStore &records = block->records;
+    store->readRange(
+        dayStartEpoch(weekStart),
+        dayStartEpoch(weekStart.addDays(HistoryBlockCache::kBlockDays)),
+        [&records](qint64 epoch, int ml) { records.append(epoch, ml); });
+  } else {
+    qCWarning(lcHistory) << "History block load failed: cannot open"
+                         << backend << "store in" << dir;
+  }
+  return block;
+}
+
+int blockCost(const HistoryBlock &block) {
+  return int(block.records.memoryUsage()) + kBlockOverheadBytes;
+}
+} // namespace
+
+void HistoryBlock::dayRange(const QDate &day, int *from, int *to) const {
+  *from = records.lowerBound(dayStartEpoch(day));
+  *to = records.lowerBound(dayStartEpoch(day.addDays(1)));
+}
+
+HistoryBlockCache::HistoryBlockCache(const QString &backend,
+                                     const QString &dir, QObject *parent)
+    : QObject(parent), m_backend(backend), m_dir(dir),
+      m_pool(new QThreadPool(this)), m_blocks(kDefaultBudgetKb * 1024),
+      m_hits(0), m_misses(0) {
+  // 顺序加载即可，避免多个实例同时争用同一份存储
+  m_pool->setMaxThreadCount(1);
+}
+
+HistoryBlockCache::~HistoryBlockCache() {
+  m_pool->clear();
+  m_pool->waitForDone();
+}
+
+void HistoryBlockCache::setBudget(int kb) {
+  m_blocks.setMaxCost(qMax(1, kb) * 1024); // 超出部分立即按 LRU 淘汰
+}
+
+int HistoryBlockCache::budget() const { return m_blocks.maxCost() / 1024; }
+
+int HistoryBlockCache::usage() const { return m_blocks.totalCost() / 1024; }
+
+QDate HistoryBlockCache::weekStartOf(const QDate &day) {
+  return day.addDays(1 - day.dayOfWeek());
+}
+
+HistoryBlockCache::BlockPtr HistoryBlockCache::cached(const QDate &day) {
+  const qint64 key = weekStartOf(day).toJulianDay();
+  if (BlockPtr *found = m_blocks.object(key))
+    return *found;
+  if (m_oversized && m_oversized->weekStart.toJulianDay() == key)
+    return m_oversized;
+  return BlockPtr();
+}
+
+HistoryBlockCache::BlockPtr HistoryBlockCache::block(const QDate &day) {
+  if (BlockPtr found = cached(day)) {
+    ++m_hits;
+    Metrics::registry().historyCacheHits.inc();
+    return found;
+  }
+  const qint64 key = weekStartOf(day).toJulianDay();
+  // 加载已在途时不重复计数
+  if (!m_pending.contains(key)) {
+    ++m_misses;
+    Metrics::registry().historyCacheMisses.inc();
+    request(key);
+  }
+  return BlockPtr();
+}
+
+void HistoryBlockCache::prefetch(const QDate &day) {
+  if (day.isValid())
+    request(weekStartOf(day).toJulianDay());
+}
+
+void HistoryBlockCache::prefetchRange(const QDate &first, const QDate &last) {
+  if (!first.isValid() || !last.isValid())
+    return;
+  for (QDate day = weekStartOf(first); day <= last;
+       day = day.addDays(kBlockDays))
+    prefetch(day);
+}
+
+void HistoryBlockCache::invalidate(const QDate &day) {
+  const qint64 key = weekStartOf(day).toJulianDay();
+  m_blocks.remove(key);
+  if (m_oversized && m_oversized->weekStart.toJulianDay() == key)
+    m_oversized.clear();
+  if (m_pending.contains(key))
+    m_stale.insert(key); // 在途结果可能缺少新记录，只重读这一周
+}
+
+void HistoryBlockCache::clear() {
+  m_blocks.clear();
+  m_oversized.clear();
+  m_stale = m_pending;
+}
+
+void HistoryBlockCache::request(qint64 key) {
+  if (m_pending.contains(key) || m_blocks.contains(key) ||
+      (m_oversized && m_oversized->weekStart.toJulianDay() == key))
+    return;
+  m_pending.insert(key);
+
+  QFutureWatcher<BlockPtr> *watcher = new QFutureWatcher<BlockPtr>(this);
+  connect(watcher, &QFutureWatcher<BlockPtr>::finished, this,
+          [this, watcher, key]() {
+            onLoaded(key, watcher->result());
+            watcher->deleteLater();
+          });
+  watcher->setFuture(QtConcurrent::run(m_pool, loadBlock, m_backend, m_dir,
+                                       QDate::fromJulianDay(key)));
+}
+
+void HistoryBlockCache::onLoaded(qint64 key, const BlockPtr &block) {
+  m_pending.remove(key);
+  if (m_stale.remove(key)) {
+    request(key); // 加载期间数据已变化，重新读取
+    return;
+  }
+  if (!m_blocks.insert(key, new BlockPtr(block), blockCost(*block))) {
+    // 不缓存也要交给界面，否则对应的行一直显示「加载中」
+    qCWarning(lcHistory) << "History block of" << block->weekStart
+                         << "exceeds the cache budget of" << budget() << "KB";
+    m_oversized = block;
+  }
+  emit blockReady(block->weekStart);
+}
@@ -0,0 +1,76 @@
+#ifndef HISTORY_BLOCK_CACHE_HPP
+#define HISTORY_BLOCK_CACHE_HPP
+
+#include "drink_record_store.hpp"
+#include <QCache>
+#include <QDate>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+
+class QThreadPool;
+
+// 一周 (周一开始) 的原始饮水记录，加载完成后不再修改
+struct HistoryBlock {
+  QDate weekStart;
+  DrinkRecordStore records;
+
+  // day 当天的记录在 records 中的下标区间 [*from, *to)
+  void dayRange(const QDate &day, int *from, int *to) const;
+};
+
+// 按周分块的饮水明细缓存。块在后台线程中按需从 HistoryStore 读取，
+// 按 LRU 在内存预算内淘汰；列表或图表滚动时预取相邻的块。
+// 命中/未命中次数同时计入 Metrics。
+class HistoryBlockCache : public QObject {
+  Q_OBJECT
+public:
+  typedef QSharedPointer<const HistoryBlock> BlockPtr;
+  static const int kBlockDays = 7;
+
+  explicit HistoryBlockCache(const QString &backend,
+                             const QString &dir = "logs",
+                             QObject *parent = nullptr);
+  ~HistoryBlockCache();
+
+  void setBudget(int kb);
+  int budget() const; // KB
+  int usage() const;  // KB
+
+  // 已缓存时返回并刷新 LRU 次序；否则发起异步加载并返回空，
+  // 加载完成后发出 blockReady
+  BlockPtr block(const QDate &day);
+  // 只查已缓存的块并刷新 LRU 次序，不加载也不计入命中统计，
+  // 供重绘等频繁调用的场合使用
+  BlockPtr cached(const QDate &day);
+  // 只发起加载，不计入命中统计
+  void prefetch(const QDate &day);
+  void prefetchRange(const QDate &first, const QDate &last);
+
+  void invalidate(const QDate &day); // 丢弃包含 day 的块
+  void clear();
+
+  quint64 hits() const { return m_hits; }
+  quint64 misses() const { return m_misses; }
+
+  static QDate weekStartOf(const QDate &day);
+
+signals:
+  void blockReady(const QDate &weekStart);
+
+private:
+  void request(qint64 key);
+  void onLoaded(qint64 key, const BlockPtr &block);
+
+  QString m_backend;
+  QString m_dir;
+  QThreadPool *m_pool;
+  QCache<qint64, BlockPtr> m_blocks; // 键为周一的儒略日，开销以字节计
+  BlockPtr m_oversized; // 超出预算放不进缓存的块，只保留最近一个
+  QSet<qint64> m_pending;
+  QSet<qint64> m_stale; // 加载期间被作废的周，结果到达后重新读取
+  quint64 m_hits;
+  quint64 m_misses;
+};
+
+#endif // HISTORY_BLOCK_CACHE_HPP
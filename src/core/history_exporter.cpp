@@ -0,0 +1,92 @@
+#include "history_exporter.hpp"
+#include "history_store.hpp"
+#include <QDateTime>
+#include <QSaveFile>
+#include <QScopedPointer>
+
+HistoryExporter::HistoryExporter(const QString &logDir,
+                                 const QString &backend, QObject *parent)
+    : QObject(parent), m_dir(logDir), m_backend(backend), m_cancelled(0) {
+  qRegisterMetaType<HistoryExporter::Format>("HistoryExporter::Format");
+}
+
+HistoryExporter::Format HistoryExporter::formatForPath(const QString &path) {
+  return (path.endsWith(".jsonl", Qt::CaseInsensitive) ||
+          path.endsWith(".json", Qt::CaseInsensitive))
+             ? JsonLines
+             : Csv;
+}
+
+void HistoryExporter::cancel() { m_cancelled.storeRelease(1); }
+
+void HistoryExporter::resetCancel() { m_cancelled.storeRelease(0); }
+
+void HistoryExporter::run(const QDate &from, const QDate &to,
+                          const QString &outPath,
+                          HistoryExporter::Format format) {
+  // 写入临时文件，成功后才替换目标，取消或失败不会留下半个文件
+  QSaveFile out(outPath);
+  if (!out.open(QIODevice::WriteOnly)) {
+    emit finished(false, 0, out.errorString());
+    return;
+  }
+
+  // 在当前 (工作) 线程打开独立的只读实例
+  QScopedPointer<HistoryStore> store(HistoryStore::open(m_backend, m_dir));
+  QList<QDate> days;
+  for (const QDate &day : store->availableDays()) {
+    if ((!from.isValid() || day >= from) && (!to.isValid() || day <= to))
+      days << day;
+  }
+
+  QByteArray buffer;
+  buffer.reserve(kBufferSize);
+  bool writeOk = true;
+  auto flush = [&]() {
+    if (!buffer.isEmpty() && out.write(buffer) != buffer.size())
+      writeOk = false;
+    buffer.clear(); // clear() 会保留已预留的容量
+  };
+
+  if (format == Csv)
+    buffer.append("date,time,epoch,amount_ml\n");
+
+  qint64 records = 0;
+  for (int i = 0; i < days.size() && writeOk; ++i) {
+    if (m_cancelled.loadAcquire()) {
+      out.cancelWriting();
+      emit finished(false, records, tr("导出已取消"));
+      return;
+    }
+
+    const QDate day = days[i];
+    const QByteArray dateStr = day.toString("yyyy-MM-dd").toLatin1();
+    store->readDay(
+        day, [&](const QTime &time, int ml) {
+          QByteArray timeStr = time.toString("hh:mm:ss").toLatin1();
+          qint64 epoch = QDateTime(day, time).toSecsSinceEpoch();
+          if (format == Csv) {
+            buffer.append(dateStr).append(',').append(timeStr).append(',');
+            buffer.append(QByteArray::number(epoch)).append(',');
+            buffer.append(QByteArray::number(ml)).append('\n');
+          } else {
+            buffer.append("{\"timestamp\":\"").append(dateStr).append('T');
+            buffer.append(timeStr).append("\",\"epoch\":");
+            buffer.append(QByteArray::number(epoch));
+            buffer.append(",\"amount_ml\":").append(QByteArray::number(ml));
+            buffer.append("}\n");
+          }
+          ++records;
+          if (buffer.size() >= kBufferSize - 256)
+            flush();
+        });
+    emit progress(i + 1, days.size());
+  }
+  flush();
+
+  if (!writeOk || !out.commit()) {
+    emit finished(false, records, out.errorString());
+    return;
+  }
+  emit finished(true, records, QString());
+}
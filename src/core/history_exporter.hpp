@@ -0,0 +1,44 @@
+#ifndef HISTORY_EXPORTER_HPP
+#define HISTORY_EXPORTER_HPP
+
+#include <QAtomicInt>
+#include <QDate>
+#include <QObject>
+
+// 把任意日期区间的饮水记录以流的方式导出为 CSV 或 JSON Lines。
+// 记录从历史存储 (见 HistoryStore) 逐条读出，经固定大小的缓冲区写入目标文件，
+// 内存占用与历史长度无关。可 moveToThread 后在工作线程中运行。
+class HistoryExporter : public QObject {
+  Q_OBJECT
+public:
+  enum Format { Csv, JsonLines };
+  static const int kBufferSize = 64 * 1024;
+
+  explicit HistoryExporter(const QString &logDir = "logs",
+                           const QString &backend = "text",
+                           QObject *parent = nullptr);
+
+  static Format formatForPath(const QString &path); // .jsonl/.json -> JSON Lines
+
+  void cancel(); // 线程安全，可在任意线程调用
+  // 清除上一次的取消标记；须在把 run 排入队列之前调用，
+  // 这样排队期间的 cancel() 不会被 run 开头覆盖
+  void resetCancel();
+
+public slots:
+  void run(const QDate &from, const QDate &to, const QString &outPath,
+           HistoryExporter::Format format);
+
+signals:
+  void progress(int doneDays, int totalDays);
+  void finished(bool ok, qint64 records, const QString &error);
+
+private:
+  QString m_dir;
+  QString m_backend;
+  QAtomicInt m_cancelled;
+};
+
+Q_DECLARE_METATYPE(HistoryExporter::Format)
+
+#endif // HISTORY_EXPORTER_HPP
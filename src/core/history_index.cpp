@@ -0,0 +1,238 @@
+#include "history_index.hpp"
+#include "logging.hpp"
+#include <QDataStream>
+#include <QDir>
+#include <QSaveFile>
+
+namespace {
+const quint32 kIndexMagic = 0x4F484958; // "OHIX"
+const quint16 kIndexVersion = 3; // 2: 回填完成标记；3: 增量日志编号
+const quint32 kJournalMagic = 0x4F484A4C; // "OHJL"
+// 增量日志超过这么多条 (约几个月的饮水) 时整体重写快照
+const int kJournalCompactEntries = 1024;
+
+QDate weekStartOf(const QDate &day) { return day.addDays(1 - day.dayOfWeek()); }
+int monthNumber(const QDate &day) { return day.year() * 12 + day.month() - 1; }
+} // namespace
+
+HistoryIndex::HistoryIndex(const QString &dir, QObject *parent)
+    : QObject(parent), m_dir(dir), m_complete(true), m_journalId(0),
+      m_journalEntries(0) {}
+
+bool HistoryIndex::load() {
+  QFile file(m_dir + "/history.idx");
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_12);
+  quint32 magic = 0;
+  quint16 version = 0;
+  in >> magic >> version;
+  if (magic != kIndexMagic || version != kIndexVersion)
+    return false;
+
+  quint8 complete = 0;
+  quint32 journalId = 0;
+  QDate firstDay;
+  QVector<qint32> dayTotals;
+  QVector<qint32> hourBins;
+  in >> complete >> journalId >> firstDay >> dayTotals >> hourBins;
+  if (in.status() != QDataStream::Ok ||
+      hourBins.size() != dayTotals.size() * 24)
+    return false;
+  if (!complete) {
+    qCDebug(lcHistory) << "历史索引的回填未完成，需要重新回填";
+    return false;
+  }
+
+  // 周/月汇总由每日总量推出，不单独存盘
+  clear();
+  for (int i = 0; i < dayTotals.size(); ++i) {
+    if (dayTotals[i] != 0)
+      addDay(firstDay.addDays(i), hourBins.constData() + i * 24);
+  }
+  m_journalId = journalId;
+
+  // 重放快照之后的增量记录。编号不符说明重写快照后来不及删除旧日志，
+  // 其中的记录已在快照里；末尾写了一半的记录直接丢弃
+  int replayed = 0;
+  QFile journal(m_dir + "/history.idx.journal");
+  if (journal.open(QIODevice::ReadOnly)) {
+    QDataStream log(&journal);
+    log.setVersion(QDataStream::Qt_5_12);
+    quint32 logMagic = 0;
+    quint32 logId = 0;
+    log >> logMagic >> logId;
+    if (logMagic == kJournalMagic && logId == journalId) {
+      qint64 secs = 0;
+      qint32 ml = 0;
+      for (;;) {
+        log >> secs >> ml;
+        if (log.status() != QDataStream::Ok)
+          break;
+        add(QDateTime::fromSecsSinceEpoch(secs), ml);
+        ++replayed;
+      }
+    }
+  }
+  // 并入新快照，之后的追加从一个干净的日志开始
+  if (replayed > 0)
+    save();
+  return true;
+}
+
+bool HistoryIndex::save() {
+  QDir().mkpath(m_dir);
+  QSaveFile file(m_dir + "/history.idx");
+  if (!file.open(QIODevice::WriteOnly)) {
+    qCWarning(lcHistory) << "无法写入历史索引:" << file.fileName();
+    return false;
+  }
+
+  // 新快照配新编号：提交后旧日志即使没删掉，加载时也会被忽略
+  const quint32 journalId = m_journalId + 1;
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_12);
+  out << kIndexMagic << kIndexVersion << quint8(m_complete ? 1 : 0)
+      << journalId << m_firstDay << m_dayTotals << m_hourBins;
+  if (!file.commit())
+    return false;
+
+  m_journalId = journalId;
+  m_journalEntries = 0;
+  m_journal.close();
+  QFile::remove(m_dir + "/history.idx.journal");
+  return true;
+}
+
+bool HistoryIndex::appendJournal(const QDateTime &when, int ml) {
+  QDataStream out(&m_journal);
+  out.setVersion(QDataStream::Qt_5_12);
+  if (!m_journal.isOpen()) {
+    QDir().mkpath(m_dir);
+    m_journal.setFileName(m_dir + "/history.idx.journal");
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      qCWarning(lcHistory) << "无法写入历史索引日志:" << m_journal.fileName();
+      return false;
+    }
+    out << kJournalMagic << m_journalId;
+  }
+  out << qint64(when.toSecsSinceEpoch()) << qint32(ml);
+  ++m_journalEntries;
+  return m_journal.flush();
+}
+
+void HistoryIndex::clear() {
+  m_firstDay = QDate();
+  m_dayTotals.clear();
+  m_hourBins.clear();
+  m_weekTotals.clear();
+  m_monthTotals.clear();
+}
+
+bool HistoryIndex::isEmpty() const { return m_dayTotals.isEmpty(); }
+
+void HistoryIndex::setComplete(bool complete) { m_complete = complete; }
+
+bool HistoryIndex::isComplete() const { return m_complete; }
+
+int HistoryIndex::ensureDay(const QDate &day) {
+  if (m_dayTotals.isEmpty()) {
+    m_firstDay = day;
+  } else if (day < m_firstDay) {
+    // 补录更早的历史：整体前移，只在回填时发生
+    int dayShift = day.daysTo(m_firstDay);
+    int weekShift = weekStartOf(day).daysTo(firstWeekStart()) / 7;
+    int monthShift = monthNumber(m_firstDay) - monthNumber(day);
+    m_dayTotals.insert(0, dayShift, 0);
+    m_hourBins.insert(0, dayShift * 24, 0);
+    m_weekTotals.insert(0, weekShift, 0);
+    m_monthTotals.insert(0, monthShift, 0);
+    m_firstDay = day;
+  }
+
+  int index = m_firstDay.daysTo(day);
+  if (index >= m_dayTotals.size()) {
+    m_dayTotals.resize(index + 1);
+    m_hourBins.resize((index + 1) * 24);
+  }
+  int week = weekIndex(day);
+  if (week >= m_weekTotals.size())
+    m_weekTotals.resize(week + 1);
+  int month = monthIndex(day);
+  if (month >= m_monthTotals.size())
+    m_monthTotals.resize(month + 1);
+  return index;
+}
+
+void HistoryIndex::add(const QDateTime &when, int ml) {
+  QDate day = when.date();
+  int index = ensureDay(day);
+  m_dayTotals[index] += ml;
+  m_hourBins[index * 24 + when.time().hour()] += ml;
+  m_weekTotals[weekIndex(day)] += ml;
+  m_monthTotals[monthIndex(day)] += ml;
+}
+
+void HistoryIndex::addDay(const QDate &day, const qint32 *hourBins) {
+  int index = ensureDay(day);
+  qint32 *bins = m_hourBins.data() + index * 24;
+  qint64 total = 0;
+  for (int h = 0; h < 24; ++h) {
+    bins[h] += hourBins[h];
+    total += hourBins[h];
+  }
+  m_dayTotals[index] += static_cast<qint32>(total);
+  m_weekTotals[weekIndex(day)] += total;
+  m_monthTotals[monthIndex(day)] += total;
+}
+
+void HistoryIndex::recordDrink(const QDateTime &when, int ml) {
+  add(when, ml);
+  // 平时只追加 12 字节；日志写失败或过长时才整体重写快照
+  if (!appendJournal(when, ml) || m_journalEntries >= kJournalCompactEntries)
+    save();
+  emit updated(when.date());
+}
+
+QDate HistoryIndex::firstDay() const { return m_firstDay; }
+
+QDate HistoryIndex::lastDay() const {
+  return m_dayTotals.isEmpty() ? QDate()
+                               : m_firstDay.addDays(m_dayTotals.size() - 1);
+}
+
+int HistoryIndex::dayCount() const { return m_dayTotals.size(); }
+
+int HistoryIndex::dayIndex(const QDate &day) const {
+  if (m_dayTotals.isEmpty() || !day.isValid())
+    return -1;
+  qint64 index = m_firstDay.daysTo(day);
+  return (index >= 0 && index < m_dayTotals.size()) ? static_cast<int>(index)
+                                                    : -1;
+}
+
+const qint32 *HistoryIndex::dayTotals() const {
+  return m_dayTotals.constData();
+}
+
+const qint32 *HistoryIndex::hourBins() const { return m_hourBins.constData(); }
+
+QDate HistoryIndex::firstWeekStart() const { return weekStartOf(m_firstDay); }
+
+const QVector<qint64> &HistoryIndex::weekTotals() const {
+  return m_weekTotals;
+}
+
+const QVector<qint64> &HistoryIndex::monthTotals() const {
+  return m_monthTotals;
+}
+
+int HistoryIndex::weekIndex(const QDate &day) const {
+  return static_cast<int>(firstWeekStart().daysTo(weekStartOf(day)) / 7);
+}
+
+int HistoryIndex::monthIndex(const QDate &day) const {
+  return monthNumber(day) - monthNumber(m_firstDay);
+}
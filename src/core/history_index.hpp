@@ -0,0 +1,70 @@
+#ifndef HISTORY_INDEX_HPP
+#define HISTORY_INDEX_HPP
+
+#include <QDate>
+#include <QFile>
+#include <QObject>
+#include <QVector>
+
+// 预聚合的历史汇总索引：每日 24 个小时桶 + 每日/每周/每月总量。
+// 全部存放在连续数组里，随每次饮水增量更新。快照存于 logs/history.idx，
+// 之后的每杯水只追加到 logs/history.idx.journal，累积够多再整体重写快照。
+class HistoryIndex : public QObject {
+  Q_OBJECT
+public:
+  explicit HistoryIndex(const QString &dir = "logs", QObject *parent = nullptr);
+
+  // 文件缺失、损坏或回填未完成时返回 false，调用方应重新回填
+  bool load();
+  bool save(); // 重写快照并清空增量日志
+  void clear();
+  bool isEmpty() const;
+
+  // 回填期间标记为未完成：此时落盘的索引只含部分历史，下次启动不会被采用
+  void setComplete(bool complete);
+  bool isComplete() const;
+
+  // 批量加入记录 (不落盘)，用于从按日日志回填
+  void add(const QDateTime &when, int ml);
+  // 加入某日已汇总好的 24 个小时桶
+  void addDay(const QDate &day, const qint32 *hourBins);
+
+  QDate firstDay() const;
+  QDate lastDay() const;
+  int dayCount() const;
+  int dayIndex(const QDate &day) const; // 超出范围返回 -1
+
+  // 连续数组视图：dayTotals[dayCount]、hourBins[dayCount * 24]
+  const qint32 *dayTotals() const;
+  const qint32 *hourBins() const;
+
+  // 周从周一开始；索引 0 为 firstDay 所在的周/月
+  QDate firstWeekStart() const;
+  const QVector<qint64> &weekTotals() const;
+  const QVector<qint64> &monthTotals() const;
+  int weekIndex(const QDate &day) const;
+  int monthIndex(const QDate &day) const;
+
+public slots:
+  void recordDrink(const QDateTime &when, int ml); // 增量更新并追加到日志
+
+signals:
+  void updated(const QDate &day); // recordDrink 改动了这一天
+
+private:
+  int ensureDay(const QDate &day);
+  bool appendJournal(const QDateTime &when, int ml);
+
+  QString m_dir;
+  bool m_complete;
+  quint32 m_journalId;  // 快照与增量日志的配对编号
+  int m_journalEntries; // 快照之后追加的记录数
+  QFile m_journal;
+  QDate m_firstDay;
+  QVector<qint32> m_dayTotals;
+  QVector<qint32> m_hourBins;
+  QVector<qint64> m_weekTotals;
+  QVector<qint64> m_monthTotals;
+};
+
+#endif // HISTORY_INDEX_HPP
@@ -0,0 +1,175 @@
+#include "history_query.hpp"
+#include "history_index.hpp"
+
+namespace {
+QDate weekStartOf(const QDate &day) { return day.addDays(1 - day.dayOfWeek()); }
+QDate monthStartOf(const QDate &day) {
+  return QDate(day.year(), day.month(), 1);
+}
+
+// 把日期区间映射到索引的下标区间 [lo, hi]，没有交集返回 false
+bool clampToIndex(const HistoryIndex *index, const QDate &from,
+                  const QDate &to, int *lo, int *hi) {
+  if (!index || index->isEmpty() || !from.isValid() || !to.isValid() ||
+      from > to)
+    return false;
+  qint64 first = index->firstDay().daysTo(from);
+  qint64 last = index->firstDay().daysTo(to);
+  *lo = static_cast<int>(qMax<qint64>(0, first));
+  *hi = static_cast<int>(qMin<qint64>(index->dayCount() - 1, last));
+  return *lo <= *hi;
+}
+} // namespace
+
+HistoryQuery::HistoryQuery(const HistoryIndex *index)
+    : m_index(index), m_groupBy(ByDay) {
+  if (m_index && !m_index->isEmpty()) {
+    m_from = m_index->firstDay();
+    m_to = m_index->lastDay();
+  }
+}
+
+HistoryQuery &HistoryQuery::range(const QDate &from, const QDate &to) {
+  m_from = from;
+  m_to = to;
+  return *this;
+}
+
+HistoryQuery &HistoryQuery::groupBy(GroupBy groupBy) {
+  m_groupBy = groupBy;
+  return *this;
+}
+
+QVector<qint64> HistoryQuery::totals() const {
+  switch (m_groupBy) {
+  case ByHour:
+    return byHour();
+  case ByWeekday:
+    return byWeekday();
+  case ByDay:
+    return byDay();
+  case ByWeek:
+    return byWeek();
+  case ByMonth:
+    return byMonth();
+  }
+  return QVector<qint64>();
+}
+
+qint64 HistoryQuery::sum() const { return sumDays(m_from, m_to); }
+
+QDate HistoryQuery::bucketStart(int i) const {
+  switch (m_groupBy) {
+  case ByDay:
+    return m_from.addDays(i);
+  case ByWeek:
+    return weekStartOf(m_from).addDays(7 * i);
+  case ByMonth:
+    return monthStartOf(m_from).addMonths(i);
+  default:
+    return QDate();
+  }
+}
+
+qint64 HistoryQuery::sumDays(const QDate &from, const QDate &to) const {
+  int lo = 0, hi = -1;
+  if (!clampToIndex(m_index, from, to, &lo, &hi))
+    return 0;
+  const qint32 *days = m_index->dayTotals();
+  qint64 total = 0;
+  for (int i = lo; i <= hi; ++i)
+    total += days[i];
+  return total;
+}
+
+QVector<qint64> HistoryQuery::byHour() const {
+  QVector<qint64> result(24, 0);
+  int lo = 0, hi = -1;
+  if (!clampToIndex(m_index, m_from, m_to, &lo, &hi))
+    return result;
+
+  qint64 *acc = result.data();
+  const qint32 *bins = m_index->hourBins() + lo * 24;
+  for (int d = lo; d <= hi; ++d, bins += 24) {
+    for (int h = 0; h < 24; ++h)
+      acc[h] += bins[h];
+  }
+  return result;
+}
+
+QVector<qint64> HistoryQuery::byWeekday() const {
+  QVector<qint64> result(7, 0);
+  int lo = 0, hi = -1;
+  if (!clampToIndex(m_index, m_from, m_to, &lo, &hi))
+    return result;
+
+  qint64 *acc = result.data();
+  const qint32 *days = m_index->dayTotals();
+  int d = lo;
+  int weekday = m_index->firstDay().addDays(lo).dayOfWeek() - 1; // 0 = 周一
+  // 先补齐到周一，再按整周累加，避免在内层循环里取模
+  for (; d <= hi && weekday != 0; ++d, weekday = (weekday + 1) % 7)
+    acc[weekday] += days[d];
+  for (; d + 6 <= hi; d += 7) {
+    for (int k = 0; k < 7; ++k)
+      acc[k] += days[d + k];
+  }
+  for (int k = 0; d <= hi; ++d, ++k)
+    acc[k] += days[d];
+  return result;
+}
+
+QVector<qint64> HistoryQuery::byDay() const {
+  if (!m_from.isValid() || !m_to.isValid() || m_from > m_to)
+    return QVector<qint64>();
+
+  QVector<qint64> result(static_cast<int>(m_from.daysTo(m_to)) + 1, 0);
+  int lo = 0, hi = -1;
+  if (!clampToIndex(m_index, m_from, m_to, &lo, &hi))
+    return result;
+
+  qint64 *out = result.data() + m_from.daysTo(m_index->firstDay().addDays(lo));
+  const qint32 *days = m_index->dayTotals();
+  for (int i = lo; i <= hi; ++i)
+    *out++ = days[i];
+  return result;
+}
+
+QVector<qint64> HistoryQuery::byWeek() const {
+  QVector<qint64> result;
+  if (!m_from.isValid() || !m_to.isValid() || m_from > m_to)
+    return result;
+
+  const QVector<qint64> &weeks = m_index->weekTotals();
+  for (QDate start = weekStartOf(m_from); start <= m_to;
+       start = start.addDays(7)) {
+    QDate end = start.addDays(6);
+    int week = m_index->isEmpty() ? -1 : m_index->weekIndex(start);
+    if (start >= m_from && end <= m_to && week >= 0 && week < weeks.size()) {
+      result.append(weeks[week]); // 整周落在区间内，直接取预聚合值
+    } else {
+      result.append(sumDays(qMax(start, m_from), qMin(end, m_to)));
+    }
+  }
+  return result;
+}
+
+QVector<qint64> HistoryQuery::byMonth() const {
+  QVector<qint64> result;
+  if (!m_from.isValid() || !m_to.isValid() || m_from > m_to)
+    return result;
+
+  const QVector<qint64> &months = m_index->monthTotals();
+  for (QDate start = monthStartOf(m_from); start <= m_to;
+       start = start.addMonths(1)) {
+    QDate end = start.addMonths(1).addDays(-1);
+    int month = m_index->isEmpty() ? -1 : m_index->monthIndex(start);
+    if (start >= m_from && end <= m_to && month >= 0 &&
+        month < months.size()) {
+      result.append(months[month]); // 整月落在区间内，直接取预聚合值
+    } else {
+      result.append(sumDays(qMax(start, m_from), qMin(end, m_to)));
+    }
+  }
+  return result;
+}
@@ -0,0 +1,42 @@
+#ifndef HISTORY_QUERY_HPP
+#define HISTORY_QUERY_HPP
+
+#include <QDate>
+#include <QVector>
+
+class HistoryIndex;
+
+// 基于 HistoryIndex 的区间 + 分组查询，只在连续数组上做归约。
+//   HistoryQuery(index).range(from, to).groupBy(HistoryQuery::ByWeek).totals()
+class HistoryQuery {
+public:
+  enum GroupBy { ByHour, ByWeekday, ByDay, ByWeek, ByMonth };
+
+  explicit HistoryQuery(const HistoryIndex *index);
+
+  HistoryQuery &range(const QDate &from, const QDate &to); // 闭区间
+  HistoryQuery &groupBy(GroupBy groupBy);
+
+  // ByHour: 24 个值 (0-23 时)；ByWeekday: 7 个值 (周一..周日)；
+  // ByDay/ByWeek/ByMonth: 从 from 所在的日/周/月开始依次排列
+  QVector<qint64> totals() const;
+  qint64 sum() const;
+
+  // ByDay/ByWeek/ByMonth 第 i 个桶的起始日期
+  QDate bucketStart(int i) const;
+
+private:
+  qint64 sumDays(const QDate &from, const QDate &to) const;
+  QVector<qint64> byHour() const;
+  QVector<qint64> byWeekday() const;
+  QVector<qint64> byDay() const;
+  QVector<qint64> byWeek() const;
+  QVector<qint64> byMonth() const;
+
+  const HistoryIndex *m_index;
+  QDate m_from;
+  QDate m_to;
+  GroupBy m_groupBy;
+};
+
+#endif // HISTORY_QUERY_HPP
@@ -0,0 +1,16 @@
+#include "history_store.hpp"
+#include "sqlite_history_store.hpp"
+#include "text_log_store.hpp"
+#include <QFile>
+
+HistoryStore *HistoryStore::open(const QString &backend, const QString &dir,
+                                 OpenMode mode) {
+  if (backend == "sqlite") {
+    // 数据库尚未由写入方创建时，历史仍在文本日志里
+    if (mode == ReadOnly &&
+        !QFile::exists(SqliteHistoryStore::databasePath(dir)))
+      return new TextLogStore(dir);
+    return new SqliteHistoryStore(dir, mode);
+  }
+  return new TextLogStore(dir);
+}
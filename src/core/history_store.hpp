@@ -0,0 +1,52 @@
+#ifndef HISTORY_STORE_HPP
+#define HISTORY_STORE_HPP
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// 一条饮水记录及记录时刻的养成状态 (后三项只用于人类可读的日志)。
+// 合并自其他设备的记录不知道当时的状态：dayTotal/growth 为 -1、status 为空
+struct DrinkEntry {
+  QDateTime timestamp;
+  int ml;
+  int dayTotal;
+  int growth;
+  QString status;
+};
+
+// 饮水历史的持久化后端。写入方只有 PlantSystem；导出、回填、命令行等
+// 读取方各自在所在线程 open 一个实例，互不阻塞。
+// 实例只能在创建它的线程中使用。
+class HistoryStore {
+public:
+  enum OpenMode { ReadOnly, ReadWrite };
+
+  virtual ~HistoryStore() {}
+
+  virtual bool isOpen() const = 0;
+  virtual QString backendName() const = 0;
+
+  virtual bool append(const DrinkEntry &entry) = 0;
+  virtual bool appendBatch(const QVector<DrinkEntry> &entries) = 0;
+
+  // 存在记录的日期，升序
+  virtual QList<QDate> availableDays() const = 0;
+  // 逐条读取某日记录，返回记录数
+  virtual int readDay(
+      const QDate &day,
+      const std::function<void(const QTime &, int)> &onRecord) const = 0;
+  // [fromEpoch, toEpoch) 区间内按时间顺序读取，返回记录数
+  virtual int readRange(
+      qint64 fromEpoch, qint64 toEpoch,
+      const std::function<void(qint64, int)> &onRecord) const = 0;
+
+  // backend 为 "text" (按日文本日志) 或 "sqlite"；调用方持有返回的实例
+  static HistoryStore *open(const QString &backend,
+                            const QString &dir = "logs",
+                            OpenMode mode = ReadOnly);
+};
+
+#endif // HISTORY_STORE_HPP
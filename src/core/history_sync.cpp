@@ -0,0 +1,242 @@
+#include "history_sync.hpp"
+#include "logging.hpp"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSaveFile>
+#include <QTimer>
+#include <algorithm>
+#include <queue>
+
+namespace {
+const char *const kJournalPrefix = "oasis-";
+const char *const kJournalSuffix = ".journal";
+const int kPollIntervalMs = 60 * 1000; // 网络盘不一定有文件变化通知
+const qint64 kTailBytes = 4096;
+
+QVector<PlantEvent> parseLines(const QByteArray &data) {
+  QVector<PlantEvent> events;
+  int start = 0;
+  int end;
+  while ((end = data.indexOf('\n', start)) >= 0) {
+    PlantEvent event;
+    if (PlantEvent::fromLine(data.mid(start, end - start), &event))
+      events.append(event);
+    start = end + 1;
+  }
+  return events;
+}
+
+// k 路归并的游标，优先队列按全序取最早的一条
+struct Cursor {
+  const QVector<PlantEvent> *batch;
+  int pos;
+  bool operator<(const Cursor &other) const {
+    return PlantEvent::before(other.batch->at(other.pos), batch->at(pos));
+  }
+};
+} // namespace
+
+HistorySync::HistorySync(const QString &syncDir, const QByteArray &deviceId,
+                         const QString &stateDir, QObject *parent)
+    : QObject(parent), m_syncDir(syncDir), m_deviceId(deviceId),
+      m_checkpointPath(stateDir + "/sync.checkpoint"), m_nextSeq(1),
+      m_watcher(new QFileSystemWatcher(this)), m_pollTimer(new QTimer(this)) {
+  QDir().mkpath(m_syncDir);
+  QDir().mkpath(stateDir);
+
+  // 本机日志的最后一行给出已用过的最大序号
+  QFile own(journalPath(m_deviceId));
+  if (own.open(QIODevice::ReadOnly)) {
+    own.seek(qMax<qint64>(0, own.size() - kTailBytes));
+    QVector<PlantEvent> tail = parseLines(own.readAll());
+    if (!tail.isEmpty())
+      m_nextSeq = tail.last().seq + 1;
+  }
+  loadCheckpoint();
+
+  m_watcher->addPath(m_syncDir);
+  connect(m_watcher, &QFileSystemWatcher::directoryChanged, this,
+          &HistorySync::poll);
+  connect(m_watcher, &QFileSystemWatcher::fileChanged, this,
+          &HistorySync::poll);
+  m_pollTimer->setInterval(kPollIntervalMs);
+  connect(m_pollTimer, &QTimer::timeout, this, &HistorySync::poll);
+  m_pollTimer->start();
+}
+
+QString HistorySync::journalPath(const QByteArray &device) const {
+  return QDir(m_syncDir).filePath(QString(kJournalPrefix) +
+                                  QString::fromLatin1(device) +
+                                  kJournalSuffix);
+}
+
+bool HistorySync::hasJournal() const {
+  return QFile::exists(journalPath(m_deviceId));
+}
+
+QList<QByteArray> HistorySync::peerDevices() const {
+  QList<QByteArray> devices;
+  const int prefix = qstrlen(kJournalPrefix);
+  const int suffix = qstrlen(kJournalSuffix);
+  QStringList names = QDir(m_syncDir).entryList(
+      QStringList() << QString(kJournalPrefix) + "*" + kJournalSuffix,
+      QDir::Files);
+  for (const QString &name : names) {
+    QByteArray device =
+        name.mid(prefix, name.size() - prefix - suffix).toLatin1();
+    // 带点的是同步工具留下的冲突副本，内容以原文件为准
+    if (device.isEmpty() || device.contains('.') || device == m_deviceId)
+      continue;
+    devices.append(device);
+  }
+  return devices;
+}
+
+void HistorySync::publish(PlantEvent *event) {
+  event->origin = m_deviceId;
+  event->seq = m_nextSeq++;
+  m_unpublished.append(*event);
+  flushUnpublished();
+}
+
+void HistorySync::publishExisting(const QVector<PlantEvent> &events) {
+  // 共享目录中的本机日志可能落后于本地事件流 (例如写入时共享盘未挂载)
+  const quint64 published = m_nextSeq - 1;
+  for (const PlantEvent &event : events) {
+    if (event.origin != m_deviceId)
+      continue;
+    if (event.seq > published)
+      m_unpublished.append(event);
+    m_nextSeq = qMax(m_nextSeq, event.seq + 1);
+  }
+  flushUnpublished();
+}
+
+void HistorySync::flushUnpublished() {
+  if (m_unpublished.isEmpty())
+    return;
+  QFile file(journalPath(m_deviceId));
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    qCWarning(lcSync) << "无法写入同步日志，稍后重试:" << file.fileName();
+    return;
+  }
+  QByteArray data;
+  for (const PlantEvent &event : m_unpublished)
+    data.append(event.toLine());
+  if (file.write(data) == data.size() && file.flush())
+    m_unpublished.clear();
+}
+
+QVector<PlantEvent> HistorySync::collect() {
+  QList<QVector<PlantEvent> > batches;
+  for (const QByteArray &device : peerDevices()) {
+    Peer &peer = m_peers[device];
+    QFile file(journalPath(device));
+    if (!file.open(QIODevice::ReadOnly))
+      continue;
+    qint64 offset = peer.offset;
+    if (file.size() < offset)
+      offset = 0; // 日志被替换过，已合并的部分靠序号去重
+
+    file.seek(offset);
+    QByteArray data = file.readAll();
+    // 同步工具可能只传了一半，只处理完整的行
+    data.truncate(data.lastIndexOf('\n') + 1);
+
+    QVector<PlantEvent> batch;
+    quint64 maxSeq = peer.lastSeq;
+    for (const PlantEvent &event : parseLines(data)) {
+      if (event.origin != device || event.seq <= peer.lastSeq)
+        continue;
+      batch.append(event);
+      maxSeq = qMax(maxSeq, event.seq);
+    }
+    peer.pendingOffset = offset + data.size();
+    peer.pendingSeq = maxSeq;
+
+    // 设备时钟回拨时日志可能局部乱序
+    if (!std::is_sorted(batch.constBegin(), batch.constEnd(),
+                        PlantEvent::before))
+      std::sort(batch.begin(), batch.end(), PlantEvent::before);
+    if (!batch.isEmpty())
+      batches.append(batch);
+  }
+
+  std::priority_queue<Cursor> heap;
+  int total = 0;
+  for (const QVector<PlantEvent> &batch : batches) {
+    Cursor cursor = {&batch, 0};
+    heap.push(cursor);
+    total += batch.size();
+  }
+  QVector<PlantEvent> merged;
+  merged.reserve(total);
+  while (!heap.empty()) {
+    Cursor cursor = heap.top();
+    heap.pop();
+    const PlantEvent &event = cursor.batch->at(cursor.pos);
+    if (merged.isEmpty() || !merged.last().sameId(event))
+      merged.append(event);
+    if (++cursor.pos < cursor.batch->size())
+      heap.push(cursor);
+  }
+  return merged;
+}
+
+void HistorySync::commit() {
+  bool changed = false;
+  for (Peer &peer : m_peers) {
+    if (peer.pendingOffset < 0)
+      continue;
+    peer.offset = peer.pendingOffset;
+    peer.lastSeq = peer.pendingSeq;
+    peer.pendingOffset = -1;
+    changed = true;
+  }
+  if (!changed)
+    return;
+
+  QSaveFile file(m_checkpointPath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qCWarning(lcSync) << "无法保存同步检查点:" << file.fileName();
+    return;
+  }
+  for (QMap<QByteArray, Peer>::const_iterator it = m_peers.constBegin();
+       it != m_peers.constEnd(); ++it)
+    file.write(it.key() + ' ' + QByteArray::number(it->offset) + ' ' +
+               QByteArray::number(it->lastSeq) + '\n');
+  file.commit();
+}
+
+void HistorySync::loadCheckpoint() {
+  // 每行: "<设备ID> <已合并偏移> <已合并最大序号>"
+  QFile file(m_checkpointPath);
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+  while (!file.atEnd()) {
+    QList<QByteArray> parts = file.readLine().trimmed().split(' ');
+    if (parts.size() != 3)
+      continue;
+    Peer peer;
+    peer.offset = parts[1].toLongLong();
+    peer.lastSeq = parts[2].toULongLong();
+    m_peers.insert(parts[0], peer);
+  }
+}
+
+void HistorySync::poll() {
+  flushUnpublished();
+
+  bool grown = false;
+  for (const QByteArray &device : peerDevices()) {
+    QString path = journalPath(device);
+    if (!m_watcher->files().contains(path))
+      m_watcher->addPath(path);
+    if (QFileInfo(path).size() != m_peers.value(device).offset)
+      grown = true;
+  }
+  if (grown)
+    emit changed();
+}
@@ -0,0 +1,63 @@
+#ifndef HISTORY_SYNC_HPP
+#define HISTORY_SYNC_HPP
+
+#include "plant_event_log.hpp"
+#include <QMap>
+#include <QObject>
+
+class QFileSystemWatcher;
+class QTimer;
+
+// 通过共享目录 (网络盘、Syncthing 等) 在多台设备间同步事件流，无需服务器。
+// 每台设备只追加写自己的 oasis-<设备ID>.journal，文件从不被两方同时修改；
+// 合并时只读取各设备日志在检查点之后新增的部分，按 PlantEvent::before
+// 做 k 路归并，并按 (设备, 序号) 去重。
+class HistorySync : public QObject {
+  Q_OBJECT
+public:
+  HistorySync(const QString &syncDir, const QByteArray &deviceId,
+              const QString &stateDir = "logs", QObject *parent = nullptr);
+
+  QByteArray deviceId() const { return m_deviceId; }
+  bool hasJournal() const; // 共享目录中是否已有本机日志
+
+  // 分配下一条本机事件的序号，并把事件写入本机日志
+  void publish(PlantEvent *event);
+  // 首次加入同步时发布本机已有的事件 (已带来源与序号)
+  void publishExisting(const QVector<PlantEvent> &events);
+
+  // 读取其他设备检查点之后的新事件，已排好全序；合并成功后调用 commit
+  QVector<PlantEvent> collect();
+  void commit();
+
+public slots:
+  void poll(); // 任一设备日志有增长时发出 changed
+
+signals:
+  void changed();
+
+private:
+  struct Peer {
+    Peer() : offset(0), lastSeq(0), pendingOffset(-1), pendingSeq(0) {}
+    qint64 offset;        // 已合并到的文件偏移
+    quint64 lastSeq;      // 已合并的最大序号
+    qint64 pendingOffset; // collect 读到但尚未提交的位置，-1 表示没有
+    quint64 pendingSeq;
+  };
+
+  QString journalPath(const QByteArray &device) const;
+  QList<QByteArray> peerDevices() const;
+  void loadCheckpoint();
+  void flushUnpublished(); // 共享盘暂时不可写时留到下次轮询
+
+  QString m_syncDir;
+  QByteArray m_deviceId;
+  QString m_checkpointPath;
+  quint64 m_nextSeq;
+  QMap<QByteArray, Peer> m_peers;
+  QVector<PlantEvent> m_unpublished;
+  QFileSystemWatcher *m_watcher;
+  QTimer *m_pollTimer;
+};
+
+#endif // HISTORY_SYNC_HPP
@@ -0,0 +1,273 @@
+#include "hydration_analytics.hpp"
+#include "history_index.hpp"
+#include <QDateTime>
+#include <algorithm>
+
+HydrationAnalytics::HydrationAnalytics(QObject *parent)
+    : QObject(parent), m_currentGoal(0), m_hitDays(0), m_sum7(0),
+      m_sum30(0) {
+  std::fill(m_hourTotals, m_hourTotals + 24, 0);
+}
+
+void HydrationAnalytics::rebuild(
+    const HistoryIndex *index, const QDate &today,
+    const std::function<int(const QDate &)> &goalForDay) {
+  m_totals.clear();
+  m_goals.clear();
+  m_runs.clear();
+  m_runLengths.clear();
+  m_hitDays = 0;
+  std::fill(m_hourTotals, m_hourTotals + 24, 0);
+
+  m_today = today;
+  m_currentGoal = goalForDay(today);
+  bool hasHistory = index && !index->isEmpty() && index->firstDay() <= today;
+  m_firstDay = hasHistory ? index->firstDay() : today;
+
+  // 唯一一次全量扫描，之后全部增量维护
+  int days = static_cast<int>(m_firstDay.daysTo(today)) + 1;
+  m_totals.resize(days);
+  m_goals.resize(days);
+  int runStart = -1;
+  for (int i = 0; i < days; ++i) {
+    QDate day = m_firstDay.addDays(i);
+    int src = hasHistory ? index->dayIndex(day) : -1;
+    if (src >= 0) {
+      m_totals[i] = index->dayTotals()[src];
+      const qint32 *bins = index->hourBins() + src * 24;
+      for (int h = 0; h < 24; ++h)
+        m_hourTotals[h] += bins[h];
+    }
+    m_goals[i] = goalForDay(day);
+
+    if (isHit(i)) {
+      ++m_hitDays;
+      if (runStart < 0)
+        runStart = i;
+    } else if (runStart >= 0) {
+      insertRun(runStart, i - runStart);
+      runStart = -1;
+    }
+  }
+  if (runStart >= 0)
+    insertRun(runStart, days - runStart);
+
+  m_sum7 = windowSum(7);
+  m_sum30 = windowSum(30);
+  emit updated();
+}
+
+int HydrationAnalytics::currentStreak() const {
+  int today = todayIndex();
+  return isHit(today) ? runEndingAt(today) : runEndingAt(today - 1);
+}
+
+int HydrationAnalytics::streakOn(const QDate &day) const {
+  if (day >= m_today)
+    return currentStreak();
+  return runEndingAt(static_cast<int>(m_firstDay.daysTo(day)));
+}
+
+int HydrationAnalytics::longestStreak() const {
+  return m_runLengths.isEmpty() ? 0 : m_runLengths.lastKey();
+}
+
+double HydrationAnalytics::movingAverage7() const {
+  int n = qMin(7, m_totals.size());
+  return n > 0 ? static_cast<double>(m_sum7) / n : 0.0;
+}
+
+double HydrationAnalytics::movingAverage30() const {
+  int n = qMin(30, m_totals.size());
+  return n > 0 ? static_cast<double>(m_sum30) / n : 0.0;
+}
+
+double HydrationAnalytics::goalHitRate() const {
+  // 今天还没结束，只有已经达标时才计入分母
+  int days = m_totals.size() - 1 + (isHit(todayIndex()) ? 1 : 0);
+  return days > 0 ? static_cast<double>(m_hitDays) / days : 0.0;
+}
+
+QList<int> HydrationAnalytics::typicalHours(int count) const {
+  int hours[24];
+  for (int h = 0; h < 24; ++h)
+    hours[h] = h;
+  count = qBound(0, count, 24);
+  std::partial_sort(hours, hours + count, hours + 24, [this](int a, int b) {
+    return m_hourTotals[a] > m_hourTotals[b];
+  });
+
+  QList<int> result;
+  for (int i = 0; i < count && m_hourTotals[hours[i]] > 0; ++i)
+    result << hours[i];
+  return result;
+}
+
+void HydrationAnalytics::recordDrink(const QDateTime &when, int ml) {
+  addAmount(when, ml);
+  emit updated();
+}
+
+void HydrationAnalytics::applyCorrection(const QDateTime &when, int deltaMl) {
+  addAmount(when, deltaMl);
+  emit updated();
+}
+
+void HydrationAnalytics::rollOver(const QDate &newDay) {
+  while (m_today.isValid() && m_today < newDay) {
+    m_today = m_today.addDays(1);
+    m_totals.append(0);
+    m_goals.append(m_currentGoal);
+    // 窗口右移一天：新的一天为 0，只需减去滑出窗口的那天
+    int today = todayIndex();
+    if (today >= 7)
+      m_sum7 -= m_totals[today - 7];
+    if (today >= 30)
+      m_sum30 -= m_totals[today - 30];
+  }
+  emit updated();
+}
+
+void HydrationAnalytics::setDailyGoal(int ml) {
+  m_currentGoal = ml;
+  int today = todayIndex();
+  if (today < 0 || today >= m_goals.size())
+    return;
+  bool wasHit = isHit(today);
+  m_goals[today] = ml;
+  refreshHit(today, wasHit);
+  emit updated();
+}
+
+int HydrationAnalytics::todayIndex() const {
+  return static_cast<int>(m_firstDay.daysTo(m_today));
+}
+
+int HydrationAnalytics::ensureDay(const QDate &day) {
+  if (day < m_firstDay) {
+    // 补录早于现有历史的数据：整体前移，区段下标随之平移 (罕见路径)
+    int shift = static_cast<int>(day.daysTo(m_firstDay));
+    int goal = m_goals.isEmpty() ? m_currentGoal : m_goals.first();
+    m_totals.insert(0, shift, 0);
+    m_goals.insert(0, shift, goal);
+    QMap<int, int> shifted;
+    for (QMap<int, int>::const_iterator it = m_runs.constBegin();
+         it != m_runs.constEnd(); ++it)
+      shifted.insert(it.key() + shift, it.value());
+    m_runs.swap(shifted);
+    m_firstDay = day;
+  }
+  return static_cast<int>(m_firstDay.daysTo(day));
+}
+
+void HydrationAnalytics::addAmount(const QDateTime &when, int deltaMl) {
+  QDate day = when.date();
+  if (!m_today.isValid() || !day.isValid())
+    return;
+  if (day > m_today)
+    rollOver(day);
+
+  int index = ensureDay(day);
+  setDayTotal(index, m_totals[index] + deltaMl);
+  m_hourTotals[when.time().hour()] += deltaMl;
+}
+
+void HydrationAnalytics::setDayTotal(int index, qint32 total) {
+  bool wasHit = isHit(index);
+  qint64 delta = total - m_totals[index];
+  m_totals[index] = total;
+
+  int today = todayIndex();
+  if (index > today - 7)
+    m_sum7 += delta;
+  if (index > today - 30)
+    m_sum30 += delta;
+  refreshHit(index, wasHit);
+}
+
+void HydrationAnalytics::refreshHit(int index, bool wasHit) {
+  bool hit = isHit(index);
+  if (hit == wasHit)
+    return;
+  if (hit) {
+    ++m_hitDays;
+    markHit(index);
+  } else {
+    --m_hitDays;
+    unmarkHit(index);
+  }
+}
+
+bool HydrationAnalytics::isHit(int index) const {
+  if (index < 0 || index >= m_totals.size())
+    return false;
+  return m_goals[index] > 0 && m_totals[index] >= m_goals[index];
+}
+
+qint64 HydrationAnalytics::windowSum(int days) const {
+  qint64 sum = 0;
+  for (int i = qMax(0, m_totals.size() - days); i < m_totals.size(); ++i)
+    sum += m_totals[i];
+  return sum;
+}
+
+int HydrationAnalytics::runEndingAt(int index) const {
+  if (index < 0)
+    return 0;
+  QMap<int, int>::const_iterator it = m_runs.upperBound(index);
+  if (it == m_runs.constBegin())
+    return 0;
+  --it;
+  return it.key() + it.value() - 1 == index ? it.value() : 0;
+}
+
+void HydrationAnalytics::insertRun(int start, int length) {
+  m_runs.insert(start, length);
+  m_runLengths[length]++;
+}
+
+void HydrationAnalytics::removeRun(int start) {
+  int length = m_runs.take(start);
+  QMap<int, int>::iterator it = m_runLengths.find(length);
+  if (it != m_runLengths.end() && --it.value() == 0)
+    m_runLengths.erase(it);
+}
+
+void HydrationAnalytics::markHit(int index) {
+  // 与右侧、左侧相邻的区段合并
+  int start = index;
+  int length = 1;
+  QMap<int, int>::const_iterator right = m_runs.constFind(index + 1);
+  if (right != m_runs.constEnd()) {
+    length += right.value();
+    removeRun(index + 1);
+  }
+  QMap<int, int>::const_iterator left = m_runs.lowerBound(index);
+  if (left != m_runs.constBegin()) {
+    --left;
+    if (left.key() + left.value() == index) {
+      start = left.key();
+      length += left.value();
+      removeRun(start);
+    }
+  }
+  insertRun(start, length);
+}
+
+void HydrationAnalytics::unmarkHit(int index) {
+  // 把包含 index 的区段一分为二
+  QMap<int, int>::const_iterator it = m_runs.upperBound(index);
+  if (it == m_runs.constBegin())
+    return;
+  --it;
+  int start = it.key();
+  int length = it.value();
+  if (index >= start + length)
+    return;
+
+  removeRun(start);
+  if (index > start)
+    insertRun(start, index - start);
+  if (index < start + length - 1)
+    insertRun(index + 1, start + length - 1 - index);
+}
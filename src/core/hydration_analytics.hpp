@@ -0,0 +1,69 @@
+#ifndef HYDRATION_ANALYTICS_HPP
+#define HYDRATION_ANALYTICS_HPP
+
+#include <QDate>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QVector>
+#include <functional>
+
+class HistoryIndex;
+
+// 饮水习惯分析：连续达标天数、7/30 日移动平均、达标率、常喝时段。
+// 启动时从 HistoryIndex 初始化一次，之后每条饮水记录、跨天、目标变化
+// 和补录修正都只做 O(1) (修正为 O(log n)) 的增量更新。
+class HydrationAnalytics : public QObject {
+  Q_OBJECT
+public:
+  explicit HydrationAnalytics(QObject *parent = nullptr);
+
+  // goalForDay 给出某日生效的每日目标 (历史天按当时的目标判定是否达标)
+  void rebuild(const HistoryIndex *index, const QDate &today,
+               const std::function<int(const QDate &)> &goalForDay);
+
+  int currentStreak() const; // 今天尚未达标时不算断签
+  int streakOn(const QDate &day) const; // 截至该日结束，今天同 currentStreak
+  int longestStreak() const;
+  double movingAverage7() const;
+  double movingAverage30() const;
+  double goalHitRate() const; // 0.0 - 1.0
+  QList<int> typicalHours(int count = 3) const; // 饮水量最多的几个小时
+
+public slots:
+  void recordDrink(const QDateTime &when, int ml);
+  void applyCorrection(const QDateTime &when, int deltaMl); // 补录或修正历史
+  void rollOver(const QDate &newDay);
+  void setDailyGoal(int ml); // 只影响今天及以后
+
+signals:
+  void updated();
+
+private:
+  int todayIndex() const;
+  int ensureDay(const QDate &day);
+  void addAmount(const QDateTime &when, int deltaMl);
+  void setDayTotal(int index, qint32 total);
+  void refreshHit(int index, bool wasHit);
+  bool isHit(int index) const;
+  qint64 windowSum(int days) const;
+  int runEndingAt(int index) const;
+  void insertRun(int start, int length);
+  void removeRun(int start);
+  void markHit(int index);
+  void unmarkHit(int index);
+
+  QDate m_firstDay;
+  QDate m_today;
+  QVector<qint32> m_totals; // 每日总量
+  QVector<qint32> m_goals;  // 每日生效目标
+  int m_currentGoal;
+  int m_hitDays;
+  qint64 m_sum7;  // 截至今天的 7 日窗口和
+  qint64 m_sum30; // 截至今天的 30 日窗口和
+  qint64 m_hourTotals[24];
+  QMap<int, int> m_runs;       // 连续达标区段: 起始下标 -> 长度
+  QMap<int, int> m_runLengths; // 区段长度 -> 个数，最大 key 即最长连续
+};
+
+#endif // HYDRATION_ANALYTICS_HPP
@@ -0,0 +1,260 @@
+#include "logging.hpp"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+Q_LOGGING_CATEGORY(lcApp, "oasis.app")
+Q_LOGGING_CATEGORY(lcReminder, "oasis.reminder")
+Q_LOGGING_CATEGORY(lcPlant, "oasis.plant")
+Q_LOGGING_CATEGORY(lcSettings, "oasis.settings")
+Q_LOGGING_CATEGORY(lcHistory, "oasis.history")
+Q_LOGGING_CATEGORY(lcSync, "oasis.sync")
+Q_LOGGING_CATEGORY(lcNotify, "oasis.notify")
+Q_LOGGING_CATEGORY(lcMetrics, "oasis.metrics")
+Q_LOGGING_CATEGORY(lcStatus, "oasis.status")
+
+namespace Logging {
+
+namespace {
+
+const int kSlotCount = 512; // 2 的幂
+const int kLineCapacity = 496;
+const qint64 kMaxFileSize = 1024 * 1024;
+const int kKeptFiles = 3;
+const unsigned long kIdleWaitMs = 1000;
+
+struct Slot {
+  std::atomic<quint64> sequence;
+  int length;
+  char line[kLineCapacity];
+};
+
+// 有界多写者单读者队列：写者用 CAS 抢占位置，槽位序号表示可读/可写，
+// 只有写盘线程读取
+class Ring {
+public:
+  Ring() : m_head(0), m_tail(0) {
+    for (int i = 0; i < kSlotCount; ++i)
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  bool push(const QByteArray &line) {
+    quint64 pos = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &slot = m_slots[pos & (kSlotCount - 1)];
+      qint64 diff = static_cast<qint64>(
+          slot.sequence.load(std::memory_order_acquire) - pos);
+      if (diff == 0) {
+        if (m_head.compare_exchange_weak(pos, pos + 1,
+                                         std::memory_order_relaxed)) {
+          slot.length = qMin(line.size(), kLineCapacity);
+          std::memcpy(slot.line, line.constData(), slot.length);
+          if (line.size() > kLineCapacity)
+            slot.line[kLineCapacity - 1] = '\n'; // 截断的行仍以换行结尾
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // 已满
+      } else {
+        pos = m_head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool pop(QByteArray *out) {
+    Slot &slot = m_slots[m_tail & (kSlotCount - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1)
+      return false;
+    out->append(slot.line, slot.length);
+    slot.sequence.store(m_tail + kSlotCount, std::memory_order_release);
+    ++m_tail;
+    return true;
+  }
+
+private:
+  Slot m_slots[kSlotCount];
+  std::atomic<quint64> m_head;
+  quint64 m_tail; // 只由写盘线程访问
+};
+
+class Writer : public QThread {
+public:
+  explicit Writer(const QString &dir)
+      : m_dir(dir), m_file(QDir(dir).filePath("oasis.log")), m_stop(false),
+        m_waiting(false), m_dropped(0) {
+#ifdef QT_NO_DEBUG
+    m_echo = qEnvironmentVariableIsSet("OASIS_LOG_STDERR");
+#else
+    m_echo = true;
+#endif
+  }
+
+  void post(const QByteArray &line) {
+    if (!m_ring.push(line))
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+    // 与 run() 中的屏障配对：写盘线程要么看到新消息，要么已在等待
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiting.load(std::memory_order_relaxed))
+      wake();
+  }
+
+  void stop() {
+    m_stop.store(true);
+    wake();
+    wait();
+  }
+
+protected:
+  void run() override {
+    QDir().mkpath(m_dir);
+    QByteArray batch;
+    for (;;) {
+      batch.clear();
+      while (m_ring.pop(&batch)) {
+      }
+      quint64 dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+      if (dropped)
+        batch.append(QString("日志缓冲区已满，丢弃 %1 条消息\n")
+                         .arg(dropped)
+                         .toUtf8());
+      if (!batch.isEmpty()) {
+        write(batch);
+        continue;
+      }
+      if (m_stop.load())
+        break;
+
+      m_waiting.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      QMutexLocker locker(&m_mutex);
+      if (!m_ring.pop(&batch) && !m_stop.load())
+        m_wake.wait(&m_mutex, kIdleWaitMs);
+      m_waiting.store(false, std::memory_order_relaxed);
+      locker.unlock();
+      if (!batch.isEmpty())
+        write(batch);
+    }
+    m_file.close();
+  }
+
+private:
+  void wake() {
+    QMutexLocker locker(&m_mutex);
+    m_wake.wakeOne();
+  }
+
+  void write(const QByteArray &batch) {
+    if (m_echo) {
+      std::fwrite(batch.constData(), 1, batch.size(), stderr);
+      std::fflush(stderr);
+    }
+    if (!m_file.isOpen() &&
+        !m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+      return;
+    if (m_file.size() + batch.size() > kMaxFileSize && m_file.size() > 0)
+      rotate();
+    m_file.write(batch);
+    m_file.flush();
+  }
+
+  void rotate() {
+    m_file.close();
+    const QString base = m_file.fileName();
+    QFile::remove(base + QString(".%1").arg(kKeptFiles));
+    for (int i = kKeptFiles - 1; i >= 1; --i)
+      QFile::rename(base + QString(".%1").arg(i),
+                    base + QString(".%1").arg(i + 1));
+    QFile::rename(base, base + ".1");
+    m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+  }
+
+  QString m_dir;
+  QFile m_file;
+  bool m_echo;
+  Ring m_ring;
+  QMutex m_mutex; // 只用于空闲时的休眠/唤醒
+  QWaitCondition m_wake;
+  std::atomic<bool> m_stop;
+  std::atomic<bool> m_waiting;
+  std::atomic<quint64> m_dropped;
+};
+
+std::atomic<Writer *> s_writer(nullptr);
+std::atomic<int> s_inFlight(0); // 已取到写者、尚未投递完的调用数
+QtMessageHandler s_previous = nullptr;
+
+char levelTag(QtMsgType type) {
+  switch (type) {
+  case QtDebugMsg:
+    return 'D';
+  case QtInfoMsg:
+    return 'I';
+  case QtWarningMsg:
+    return 'W';
+  case QtCriticalMsg:
+    return 'C';
+  case QtFatalMsg:
+    return 'F';
+  }
+  return '?';
+}
+
+void handleMessage(QtMsgType type, const QMessageLogContext &context,
+                   const QString &message) {
+  // 先登记再取写者：shutdown 置空写者后要等计数归零才释放它
+  s_inFlight.fetch_add(1);
+  Writer *writer = s_writer.load();
+  if (writer && type != QtFatalMsg) {
+    QByteArray line = QDateTime::currentDateTime()
+                          .toString("yyyy-MM-dd hh:mm:ss.zzz")
+                          .toLatin1();
+    line.append(' ').append(levelTag(type)).append(' ');
+    line.append(context.category ? context.category : "default").append(": ");
+    line.append(message.toUtf8()).append('\n');
+    writer->post(line);
+    s_inFlight.fetch_sub(1);
+    return;
+  }
+  s_inFlight.fetch_sub(1);
+
+  // 致命错误之后进程立即终止，先写完缓冲区再交给默认处理器
+  if (writer)
+    shutdown();
+  if (s_previous)
+    s_previous(type, context, message);
+}
+
+} // namespace
+
+void install(const QString &dir) {
+  if (s_writer.load())
+    return;
+  Writer *writer = new Writer(dir);
+  writer->setObjectName("OasisLog");
+  writer->start(QThread::LowPriority);
+  s_writer.store(writer, std::memory_order_release);
+  s_previous = qInstallMessageHandler(handleMessage);
+  qAddPostRoutine(shutdown);
+}
+
+void shutdown() {
+  Writer *writer = s_writer.exchange(nullptr);
+  if (!writer)
+    return;
+  qInstallMessageHandler(s_previous);
+  // 其他线程可能已取到写者，等它们投递完再写盘、释放
+  while (s_inFlight.load() > 0)
+    QThread::yieldCurrentThread();
+  writer->stop();
+  delete writer;
+}
+
+} // namespace Logging
@@ -0,0 +1,32 @@
+#ifndef LOGGING_HPP
+#define LOGGING_HPP
+
+#include <QLoggingCategory>
+#include <QString>
+
+// 各子系统的日志分类，可用 QT_LOGGING_RULES 单独开关，例如
+//   QT_LOGGING_RULES="oasis.reminder.debug=true"
+// Release 构建定义了 QT_NO_DEBUG_OUTPUT，qCDebug 整句编译为空。
+Q_DECLARE_LOGGING_CATEGORY(lcApp)
+Q_DECLARE_LOGGING_CATEGORY(lcReminder)
+Q_DECLARE_LOGGING_CATEGORY(lcPlant)
+Q_DECLARE_LOGGING_CATEGORY(lcSettings)
+Q_DECLARE_LOGGING_CATEGORY(lcHistory)
+Q_DECLARE_LOGGING_CATEGORY(lcSync)
+Q_DECLARE_LOGGING_CATEGORY(lcNotify)
+Q_DECLARE_LOGGING_CATEGORY(lcMetrics)
+Q_DECLARE_LOGGING_CATEGORY(lcStatus)
+
+// 异步日志：消息处理器只把格式化后的一行放进无锁环形缓冲区，由后台线程
+// 批量写入 <dir>/oasis.log，超过上限后轮转为 oasis.log.1 .. .3。缓冲区满时
+// 丢弃新消息并计数，调用方从不阻塞在磁盘或终端上。
+// Debug 构建或设置了 OASIS_LOG_STDERR 时，后台线程同时转写到 stderr。
+namespace Logging {
+
+void install(const QString &dir = "logs");
+// 写完剩余消息并恢复默认处理器；install 会把它注册为退出例程
+void shutdown();
+
+} // namespace Logging
+
+#endif // LOGGING_HPP
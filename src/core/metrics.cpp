@@ -0,0 +1,145 @@
+#include "metrics.hpp"
+#include <QFile>
+#include <QList>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace Metrics {
+
+namespace {
+
+const double kDriftBounds[] = {0.001, 0.01, 0.1, 0.5, 1, 5, 30, 60, 300};
+const double kLatencyBounds[] = {0.001, 0.005, 0.01, 0.025, 0.05,
+                                 0.1,   0.25,  0.5,  1,     2.5};
+const double kPersistBounds[] = {0.0001, 0.0005, 0.001, 0.005,
+                                 0.01,   0.05,   0.1,   0.5};
+
+template <typename T, int N> int countOf(const T (&)[N]) { return N; }
+
+void renderCounter(QByteArray *out, const char *name, const char *help,
+                   const Counter &counter) {
+  out->append("# HELP ").append(name).append(' ').append(help).append('\n');
+  out->append("# TYPE ").append(name).append(" counter\n");
+  out->append(name).append(' ').append(QByteArray::number(counter.value()));
+  out->append('\n');
+}
+
+} // namespace
+
+Histogram::Histogram(const double *upperBounds, int count)
+    : m_bounds(upperBounds), m_count(qMin(count, kMaxBuckets)), m_sumMicros(0),
+      m_total(0) {
+  for (int i = 0; i <= kMaxBuckets; ++i)
+    m_buckets[i].store(0, std::memory_order_relaxed);
+}
+
+void Histogram::observe(double seconds) {
+  int bucket = 0;
+  while (bucket < m_count && seconds > m_bounds[bucket])
+    ++bucket;
+  m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  m_sumMicros.fetch_add(static_cast<qint64>(seconds * 1e6),
+                        std::memory_order_relaxed);
+  m_total.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Histogram::render(QByteArray *out, const char *name,
+                       const char *help) const {
+  out->append("# HELP ").append(name).append(' ').append(help).append('\n');
+  out->append("# TYPE ").append(name).append(" histogram\n");
+
+  quint64 cumulative = 0;
+  for (int i = 0; i <= m_count; ++i) {
+    cumulative += m_buckets[i].load(std::memory_order_relaxed);
+    out->append(name).append("_bucket{le=\"");
+    out->append(i < m_count ? QByteArray::number(m_bounds[i]) : "+Inf");
+    out->append("\"} ").append(QByteArray::number(cumulative)).append('\n');
+  }
+  out->append(name).append("_sum ");
+  out->append(QByteArray::number(
+      m_sumMicros.load(std::memory_order_relaxed) / 1e6, 'f', 6));
+  out->append('\n');
+  out->append(name).append("_count ");
+  out->append(QByteArray::number(m_total.load(std::memory_order_relaxed)));
+  out->append('\n');
+}
+
+Registry::Registry()
+    : schedulingDrift(kDriftBounds, countOf(kDriftBounds)),
+      popupLatency(kLatencyBounds, countOf(kLatencyBounds)),
+      drinkPersistLatency(kPersistBounds, countOf(kPersistBounds)) {}
+
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+qint64 residentMemoryBytes() {
+#ifdef Q_OS_LINUX
+  QFile statm("/proc/self/statm");
+  if (statm.open(QIODevice::ReadOnly)) {
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() > 1)
+      return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+  }
+#endif
+  return 0;
+}
+
+qint64 heapInUseBytes() {
+#if defined(__GLIBC__) &&                                                      \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 info = mallinfo2();
+  return qint64(info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+  // 旧版 mallinfo 的字段是 int，超过 2 GB 会回绕
+  struct mallinfo info = mallinfo();
+  return qint64(unsigned(info.uordblks)) + unsigned(info.hblkhd);
+#else
+  return 0;
+#endif
+}
+
+QByteArray renderPrometheus() {
+  const Registry &r = registry();
+  QByteArray out;
+  out.reserve(4096);
+  renderCounter(&out, "oasis_reminders_scheduled_total",
+                "Reminders armed by the reminder engine.",
+                r.remindersScheduled);
+  renderCounter(&out, "oasis_reminders_fired_total",
+                "Reminders delivered to the user.", r.remindersFired);
+  renderCounter(&out, "oasis_reminders_suppressed_dnd_total",
+                "Reminders skipped because do-not-disturb was active.",
+                r.remindersSuppressed);
+  renderCounter(&out, "oasis_history_cache_hits_total",
+                "History block lookups served from memory.",
+                r.historyCacheHits);
+  renderCounter(&out, "oasis_history_cache_misses_total",
+                "History block lookups that had to load from storage.",
+                r.historyCacheMisses);
+  r.schedulingDrift.render(
+      &out, "oasis_reminder_drift_seconds",
+      "Actual minus intended reminder fire time.");
+  r.popupLatency.render(&out, "oasis_popup_latency_seconds",
+                        "Reminder trigger to first popup frame.");
+  r.drinkPersistLatency.render(&out, "oasis_record_drink_persist_seconds",
+                               "Time spent persisting a drink record.");
+
+  out.append("# HELP process_resident_memory_bytes Resident memory size.\n");
+  out.append("# TYPE process_resident_memory_bytes gauge\n");
+  out.append("process_resident_memory_bytes ");
+  out.append(QByteArray::number(residentMemoryBytes())).append('\n');
+  out.append("# HELP process_heap_in_use_bytes Bytes allocated by malloc.\n");
+  out.append("# TYPE process_heap_in_use_bytes gauge\n");
+  out.append("process_heap_in_use_bytes ");
+  out.append(QByteArray::number(heapInUseBytes())).append('\n');
+  return out;
+}
+
+} // namespace Metrics
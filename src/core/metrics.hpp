@@ -0,0 +1,61 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <QByteArray>
+#include <atomic>
+
+// 进程内运行指标。热路径只做一次 relaxed 原子加法，不加锁；
+// 渲染为 Prometheus 文本格式时才读取。
+namespace Metrics {
+
+class Counter {
+public:
+  Counter() : m_value(0) {}
+  void inc(quint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+  quint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<quint64> m_value;
+};
+
+// 固定桶的直方图，单位为秒
+class Histogram {
+public:
+  static const int kMaxBuckets = 12;
+
+  Histogram(const double *upperBounds, int count);
+  void observe(double seconds);
+  void render(QByteArray *out, const char *name, const char *help) const;
+  quint64 count() const { return m_total.load(std::memory_order_relaxed); }
+
+private:
+  const double *m_bounds;
+  int m_count;
+  std::atomic<quint64> m_buckets[kMaxBuckets + 1]; // 最后一个为 +Inf
+  std::atomic<qint64> m_sumMicros;
+  std::atomic<quint64> m_total;
+};
+
+struct Registry {
+  Registry();
+
+  Counter remindersScheduled;   // 已预约的提醒
+  Counter remindersFired;       // 实际弹出的提醒
+  Counter remindersSuppressed;  // 因免打扰被跳过的提醒
+  Counter historyCacheHits;     // 历史明细块缓存命中
+  Counter historyCacheMisses;   // 历史明细块缓存未命中
+  Histogram schedulingDrift;    // 实际触发时间 - 预定触发时间
+  Histogram popupLatency;       // 提醒触发到弹窗首帧
+  Histogram drinkPersistLatency; // recordDrink 持久化耗时
+};
+
+Registry &registry();
+
+qint64 residentMemoryBytes();
+// malloc 已分配且未释放的字节数 (含 mmap 大块)，非 glibc 平台返回 0
+qint64 heapInUseBytes();
+QByteArray renderPrometheus();
+
+} // namespace Metrics
+
+#endif // METRICS_HPP
@@ -0,0 +1,112 @@
+#include "metrics_server.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+namespace {
+const qint64 kMaxRequestBytes = 8192;
+const int kRequestTimeoutMs = 5000; // 从连接建立起读完请求头的期限
+} // namespace
+
+MetricsServer::MetricsServer(QObject *parent)
+    : QObject(parent), m_tcpServer(nullptr), m_localServer(nullptr) {}
+
+bool MetricsServer::listenTcp(quint16 port) {
+  close();
+  m_tcpServer = new QTcpServer(this);
+  connect(m_tcpServer, &QTcpServer::newConnection, this,
+          &MetricsServer::onTcpConnection);
+  if (!m_tcpServer->listen(QHostAddress::LocalHost, port)) {
+    qCWarning(lcMetrics) << "Metrics endpoint failed to listen on port" << port
+                         << ":" << m_tcpServer->errorString();
+    close();
+    return false;
+  }
+  qCDebug(lcMetrics) << "Metrics endpoint listening on" << address();
+  return true;
+}
+
+bool MetricsServer::listenLocal(const QString &socketPath) {
+  close();
+  m_localServer = new QLocalServer(this);
+  m_localServer->setSocketOptions(QLocalServer::UserAccessOption);
+  connect(m_localServer, &QLocalServer::newConnection, this,
+          &MetricsServer::onLocalConnection);
+  // 上次异常退出可能残留套接字文件
+  QLocalServer::removeServer(socketPath);
+  if (!m_localServer->listen(socketPath)) {
+    qCWarning(lcMetrics) << "Metrics endpoint failed to listen on" << socketPath
+                         << ":" << m_localServer->errorString();
+    close();
+    return false;
+  }
+  qCDebug(lcMetrics) << "Metrics endpoint listening on" << address();
+  return true;
+}
+
+void MetricsServer::close() {
+  delete m_tcpServer;
+  m_tcpServer = nullptr;
+  delete m_localServer;
+  m_localServer = nullptr;
+}
+
+QString MetricsServer::address() const {
+  if (m_tcpServer)
+    return QString("http://127.0.0.1:%1/metrics")
+        .arg(m_tcpServer->serverPort());
+  if (m_localServer)
+    return m_localServer->fullServerName();
+  return QString();
+}
+
+void MetricsServer::onTcpConnection() {
+  while (QTcpSocket *socket = m_tcpServer->nextPendingConnection()) {
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    serve(socket);
+  }
+}
+
+void MetricsServer::onLocalConnection() {
+  while (QLocalSocket *socket = m_localServer->nextPendingConnection()) {
+    connect(socket, &QLocalSocket::disconnected, socket,
+            &QObject::deleteLater);
+    serve(socket);
+  }
+}
+
+void MetricsServer::serve(QIODevice *socket) {
+  // 读到请求头结束再应答；请求内容本身不关心
+  auto respond = [socket]() {
+    if (!socket->isOpen())
+      return;
+    QByteArray pending = socket->peek(kMaxRequestBytes);
+    if (!pending.contains("\r\n\r\n") && pending.size() < kMaxRequestBytes)
+      return;
+    socket->readAll();
+
+    QByteArray body = Metrics::renderPrometheus();
+    QByteArray response =
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Connection: close\r\n"
+        "Content-Length: " +
+        QByteArray::number(body.size()) + "\r\n\r\n" + body;
+    socket->write(response);
+    socket->close(); // 待写数据发送完毕后才断开，随后 disconnected 触发释放
+  };
+  connect(socket, &QIODevice::readyRead, socket, respond);
+  // 迟迟不发完请求头的客户端到期断开，不能一直占着连接；
+  // 已应答的连接 isOpen() 为假，不会打断尚未发完的响应
+  QTimer::singleShot(kRequestTimeoutMs, socket, [socket]() {
+    if (socket->isOpen())
+      socket->close();
+  });
+  if (socket->bytesAvailable() > 0)
+    respond();
+}
@@ -0,0 +1,34 @@
+#ifndef METRICS_SERVER_HPP
+#define METRICS_SERVER_HPP
+
+#include <QObject>
+#include <QString>
+
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+
+// 极简 HTTP/1.0 端点：任何请求都返回 Prometheus 文本格式的指标。
+// 只监听 127.0.0.1 或 Unix 域套接字，不对外暴露。
+class MetricsServer : public QObject {
+  Q_OBJECT
+public:
+  explicit MetricsServer(QObject *parent = nullptr);
+
+  bool listenTcp(quint16 port);
+  bool listenLocal(const QString &socketPath);
+  void close();
+  QString address() const;
+
+private slots:
+  void onTcpConnection();
+  void onLocalConnection();
+
+private:
+  void serve(QIODevice *socket);
+
+  QTcpServer *m_tcpServer;
+  QLocalServer *m_localServer;
+};
+
+#endif // METRICS_SERVER_HPP
@@ -0,0 +1,72 @@
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+
+// 无界多生产者单消费者队列 (Vyukov 侵入式链表)。push 只有一次原子交换，
+// 任意线程都可调用且从不阻塞；pop/isEmpty 只能由唯一的消费者线程调用。
+// 生产者刚交换完头指针、尚未挂上 next 的瞬间 pop 会返回 false 而
+// isEmpty 仍为 false，消费者稍后重试即可。
+template <typename T> class MpscQueue {
+public:
+  MpscQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+  ~MpscQueue() {
+    T value;
+    while (pop(&value)) {
+    }
+  }
+
+  void push(const T &value) { pushNode(new Node(value)); }
+
+  bool pop(T *value) {
+    Node *tail = m_tail;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (tail == &m_stub) {
+      if (!next)
+        return false;
+      m_tail = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (!next) {
+      if (tail != m_head.load())
+        return false; // 生产者尚未挂上 next
+      // tail 是最后一个节点：放回哑节点，才能取走 tail 而不留下悬空的头
+      pushNode(&m_stub);
+      next = tail->next.load(std::memory_order_acquire);
+      if (!next)
+        return false;
+    }
+    m_tail = next;
+    *value = tail->value;
+    delete tail;
+    return true;
+  }
+
+  // 头指针的读取与 push 的交换都是顺序一致的，消费者先清除自己的
+  // 「已调度」标记再调用它，就不会漏掉与之并发的 push
+  bool isEmpty() const { return m_tail == &m_stub && m_head.load() == &m_stub; }
+
+private:
+  struct Node {
+    Node() : next(nullptr), value() {}
+    explicit Node(const T &v) : next(nullptr), value(v) {}
+    std::atomic<Node *> next;
+    T value;
+  };
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  void pushNode(Node *node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node *prev = m_head.exchange(node);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  Node m_stub;
+  std::atomic<Node *> m_head; // 生产者交换
+  Node *m_tail;               // 只由消费者访问
+};
+
+#endif // MPSC_QUEUE_HPP
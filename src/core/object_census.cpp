@@ -0,0 +1,134 @@
+#include "object_census.hpp"
+#include "metrics.hpp"
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <algorithm>
+
+// 声明在 Qt 私有头 qhooks_p.h 中，按其布局自行声明，不依赖私有头文件
+QT_BEGIN_NAMESPACE
+extern quintptr Q_CORE_EXPORT qtHookData[];
+QT_END_NAMESPACE
+
+namespace {
+
+// 与 qhooks_p.h 中的 QHooks::HookIndex 一致
+enum HookIndex {
+  HookDataVersion = 0,
+  HookDataSize = 1,
+  AddQObject = 3,
+  RemoveQObject = 4
+};
+
+typedef void (*ObjectCallback)(QObject *);
+
+struct State {
+  State() : previousAdd(nullptr), previousRemove(nullptr), installed(false) {}
+
+  QMutex mutex;
+  QSet<QObject *> live;
+  ObjectCallback previousAdd; // 安装前已有的钩子，照常转发
+  ObjectCallback previousRemove;
+  bool installed;
+};
+
+// 故意不释放：静态对象析构之后仍可能有 QObject 析构并回调
+State &state() {
+  static State *instance = new State;
+  return *instance;
+}
+
+void onAddObject(QObject *object) {
+  State &s = state();
+  {
+    QMutexLocker locker(&s.mutex);
+    s.live.insert(object);
+  }
+  if (s.previousAdd)
+    s.previousAdd(object);
+}
+
+void onRemoveObject(QObject *object) {
+  State &s = state();
+  {
+    QMutexLocker locker(&s.mutex);
+    s.live.remove(object);
+  }
+  if (s.previousRemove)
+    s.previousRemove(object);
+}
+
+} // namespace
+
+namespace ObjectCensus {
+
+Sample::Sample() : liveObjects(0), rssBytes(0), heapBytes(0) {}
+
+bool install() {
+  State &s = state();
+  QMutexLocker locker(&s.mutex);
+  if (s.installed)
+    return true;
+  if (qtHookData[HookDataVersion] < 1 ||
+      qtHookData[HookDataSize] <= quintptr(RemoveQObject))
+    return false;
+  s.previousAdd = reinterpret_cast<ObjectCallback>(qtHookData[AddQObject]);
+  s.previousRemove =
+      reinterpret_cast<ObjectCallback>(qtHookData[RemoveQObject]);
+  qtHookData[AddQObject] = reinterpret_cast<quintptr>(&onAddObject);
+  qtHookData[RemoveQObject] = reinterpret_cast<quintptr>(&onRemoveObject);
+  s.installed = true;
+  return true;
+}
+
+void uninstall() {
+  State &s = state();
+  QMutexLocker locker(&s.mutex);
+  if (!s.installed)
+    return;
+  // 之后又有别的工具装了钩子时保留它们的，只是不再计数
+  if (qtHookData[AddQObject] == reinterpret_cast<quintptr>(&onAddObject))
+    qtHookData[AddQObject] = reinterpret_cast<quintptr>(s.previousAdd);
+  if (qtHookData[RemoveQObject] ==
+      reinterpret_cast<quintptr>(&onRemoveObject))
+    qtHookData[RemoveQObject] = reinterpret_cast<quintptr>(s.previousRemove);
+  s.live.clear();
+  s.installed = false;
+}
+
+bool isInstalled() {
+  State &s = state();
+  QMutexLocker locker(&s.mutex);
+  return s.installed;
+}
+
+Sample take() {
+  Sample sample;
+  sample.rssBytes = Metrics::residentMemoryBytes();
+  sample.heapBytes = Metrics::heapInUseBytes();
+  State &s = state();
+  QMutexLocker locker(&s.mutex);
+  sample.liveObjects = s.live.size();
+  // 持锁期间对象无法完成析构，读取类名是安全的
+  for (QObject *object : s.live)
+    ++sample.byClass[QByteArray(object->metaObject()->className())];
+  return sample;
+}
+
+QList<QPair<QByteArray, int> > growth(const Sample &from, const Sample &to) {
+  QList<QPair<QByteArray, int> > grown;
+  for (auto it = to.byClass.constBegin(); it != to.byClass.constEnd(); ++it) {
+    const int delta = it.value() - from.byClass.value(it.key());
+    if (delta > 0)
+      grown.append(qMakePair(it.key(), delta));
+  }
+  std::sort(grown.begin(), grown.end(),
+            [](const QPair<QByteArray, int> &a,
+               const QPair<QByteArray, int> &b) {
+              return a.second != b.second ? a.second > b.second
+                                          : a.first < b.first;
+            });
+  return grown;
+}
+
+} // namespace ObjectCensus
@@ -0,0 +1,39 @@
+#ifndef OBJECT_CENSUS_HPP
+#define OBJECT_CENSUS_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+
+// 存活 QObject 的按类统计，用于排查长时间运行下的缓慢增长。
+// 通过 Qt 为调试工具预留的 qtHookData 登记构造/析构回调 (GammaRay 用的
+// 同一机制)，安装前已存在的对象不计入。每次构造/析构多一次加锁，
+// 只应在诊断模式或耐久测试中安装。
+namespace ObjectCensus {
+
+// 某一时刻的存活对象与内存占用
+struct Sample {
+  Sample();
+
+  int liveObjects;
+  QHash<QByteArray, int> byClass; // 类名 -> 存活数
+  qint64 rssBytes;
+  qint64 heapBytes; // malloc 已分配且未释放的字节数
+};
+
+// Qt 的钩子版本不兼容时返回 false
+bool install();
+void uninstall();
+bool isInstalled();
+
+// 构造中的对象类名取不到，按安装后的对象指针在采样时才读取类名。
+// 其他线程里正在析构的对象可能被记到基类名下
+Sample take();
+
+// from -> to 之间存活数增加的类，按增量从大到小排列
+QList<QPair<QByteArray, int> > growth(const Sample &from, const Sample &to);
+
+} // namespace ObjectCensus
+
+#endif // OBJECT_CENSUS_HPP
@@ -0,0 +1,561 @@
+#include "plant_event_log.hpp"
+#include "logging.hpp"
+#include "plant_model.hpp"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QSaveFile>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+const quint32 kSnapshotMagic = 0x4F534E50; // "OSNP"
+const quint16 kSnapshotVersion = 2; // v2: 增加 goalByDay
+const quint32 kAnchorMagic = 0x4F414E43;   // "OANC"
+const quint16 kAnchorVersion = 1;
+// 锚点超过上限时整理：最近 kDenseAnchorDays 天全部保留，更早的每月一个
+const int kMaxAnchors = 64;
+const int kDenseAnchorDays = 30;
+
+// 快照与锚点共用的状态序列化
+void writeState(QDataStream &out, const PlantState &state) {
+  out << state.growthValue << state.harvestCount << state.dailyGoal
+      << state.lastDrinkTime << state.day << state.dayIntake
+      << static_cast<qint32>(state.dayDrinks.size());
+  for (int i = 0; i < state.dayDrinks.size(); ++i)
+    out << state.dayDrinks.epochAt(i)
+        << static_cast<qint32>(state.dayDrinks.amountAt(i));
+  out << state.goalByDay;
+}
+
+void readState(QDataStream &in, quint16 version, PlantState *state) {
+  qint32 drinks = 0;
+  in >> state->growthValue >> state->harvestCount >> state->dailyGoal >>
+      state->lastDrinkTime >> state->day >> state->dayIntake >> drinks;
+  state->dayDrinks.clear();
+  state->dayDrinks.reserve(drinks);
+  for (qint32 i = 0; i < drinks && in.status() == QDataStream::Ok; ++i) {
+    qint64 timestamp = 0;
+    qint32 amount = 0;
+    in >> timestamp >> amount;
+    state->dayDrinks.append(timestamp, amount);
+  }
+  state->goalByDay.clear();
+  if (version >= 2)
+    in >> state->goalByDay;
+}
+
+QVector<PlantEvent> parseEvents(const QByteArray &data) {
+  QVector<PlantEvent> events;
+  int start = 0;
+  int end;
+  while ((end = data.indexOf('\n', start)) >= 0) {
+    PlantEvent event;
+    if (PlantEvent::fromLine(data.mid(start, end - start), &event))
+      events.append(event);
+    start = end + 1;
+  }
+  return events;
+}
+} // namespace
+
+QByteArray PlantEvent::toLine() const {
+  QByteArray line;
+  line.append(static_cast<char>(type));
+  line.append(' ').append(QByteArray::number(timestamp));
+  line.append(' ').append(QByteArray::number(value));
+  if (type == Seed)
+    line.append(' ').append(QByteArray::number(extra));
+  if (!origin.isEmpty())
+    line.append(" @").append(origin).append(':').append(
+        QByteArray::number(seq));
+  line.append('\n');
+  return line;
+}
+
+bool PlantEvent::fromLine(const QByteArray &line, PlantEvent *event) {
+  QList<QByteArray> parts = line.trimmed().split(' ');
+  event->origin.clear();
+  event->seq = 0;
+  if (!parts.isEmpty() && parts.last().startsWith('@')) {
+    QByteArray id = parts.takeLast().mid(1);
+    int colon = id.lastIndexOf(':');
+    bool okSeq = false;
+    if (colon <= 0)
+      return false;
+    event->origin = id.left(colon);
+    event->seq = id.mid(colon + 1).toULongLong(&okSeq);
+    if (!okSeq)
+      return false;
+  }
+  if (parts.size() < 3 || parts[0].size() != 1)
+    return false;
+
+  char type = parts[0].at(0);
+  if (type != Drink && type != Harvest && type != GoalChange && type != Seed)
+    return false;
+
+  bool okTs = false, okValue = false;
+  event->type = static_cast<Type>(type);
+  event->timestamp = parts[1].toLongLong(&okTs);
+  event->value = parts[2].toInt(&okValue);
+  event->extra = parts.size() > 3 ? parts[3].toInt() : 0;
+  return okTs && okValue;
+}
+
+bool PlantEvent::before(const PlantEvent &a, const PlantEvent &b) {
+  if (a.timestamp != b.timestamp)
+    return a.timestamp < b.timestamp;
+  if (a.origin != b.origin)
+    return a.origin < b.origin;
+  return a.seq < b.seq;
+}
+
+PlantState::PlantState()
+    : growthValue(0), harvestCount(0), dailyGoal(0), lastDrinkTime(0),
+      dayIntake(0) {}
+
+void PlantState::apply(const PlantEvent &event) {
+  switch (event.type) {
+  case PlantEvent::Drink: {
+    QDate date = QDateTime::fromSecsSinceEpoch(event.timestamp).date();
+    if (date != day) {
+      day = date;
+      dayIntake = 0;
+      dayDrinks.clear();
+    }
+    const int ml = DrinkRecordStore::clampAmount(event.value);
+    dayIntake += ml;
+    dayDrinks.append(event.timestamp, ml);
+    growthValue += PlantModel::kGrowthPerDrink;
+    lastDrinkTime = qMax(lastDrinkTime, event.timestamp);
+    break;
+  }
+  case PlantEvent::Harvest:
+    harvestCount++;
+    growthValue = 0; // 重置成长周期
+    break;
+  case PlantEvent::GoalChange:
+    dailyGoal = event.value;
+    goalByDay[QDateTime::fromSecsSinceEpoch(event.timestamp).date()] =
+        event.value;
+    break;
+  case PlantEvent::Seed:
+    growthValue = event.value;
+    harvestCount = event.extra;
+    break;
+  }
+}
+
+PlantEventLog::PlantEventLog(const QString &dir)
+    : m_dir(dir), m_eventCount(0), m_eventsSinceSnapshot(0), m_last(),
+      m_hasLast(false), m_anchorLimit(kMaxAnchors) {}
+
+PlantEventLog::~PlantEventLog() {
+  if (m_file.isOpen())
+    m_file.close();
+}
+
+quint64 PlantEventLog::eventCount() const { return m_eventCount; }
+
+bool PlantEventLog::load(PlantState *state) {
+  QDir().mkpath(m_dir);
+  m_file.setFileName(m_dir + "/events.log");
+  bool existed = m_file.exists();
+  if (!m_file.open(QIODevice::ReadWrite)) {
+    qCWarning(lcPlant) << "无法打开事件流:" << m_file.fileName();
+    return existed;
+  }
+  recoverRewrite();
+  loadAnchors();
+
+  qint64 offset = 0;
+  quint64 count = 0;
+  PlantState snapshot;
+  if (readSnapshot(&snapshot, &offset, &count) && offset <= m_file.size()) {
+    *state = snapshot;
+  } else {
+    offset = 0;
+    count = 0;
+  }
+
+  // 只重放快照之后的尾部事件
+  m_file.seek(offset);
+  quint64 replayed = 0;
+  while (!m_file.atEnd()) {
+    qint64 lineStart = m_file.pos();
+    QByteArray line = m_file.readLine();
+    if (!line.endsWith('\n')) {
+      // 上次写入时崩溃留下的半行，截掉以免与下一条事件粘连
+      m_file.resize(lineStart);
+      break;
+    }
+    PlantEvent event;
+    if (PlantEvent::fromLine(line, &event)) {
+      state->apply(event);
+      m_last = event;
+      m_hasLast = true;
+      ++replayed;
+    }
+  }
+  m_eventCount = count + replayed;
+  m_eventsSinceSnapshot = replayed;
+  if (!m_hasLast)
+    readLastEvent();
+  m_file.seek(m_file.size());
+
+  qCDebug(lcPlant) << "事件流已恢复: 快照" << count << "条 + 重放" << replayed
+                   << "条";
+
+  if (m_eventsSinceSnapshot >= static_cast<quint64>(kSnapshotInterval))
+    writeSnapshot(*state);
+  return existed;
+}
+
+void PlantEventLog::append(const PlantEvent &event,
+                           const PlantState &stateAfter) {
+  if (!m_file.isOpen()) {
+    qCWarning(lcPlant) << "事件流未打开，事件丢失";
+    return;
+  }
+  writeEvent(event, stateAfter);
+  m_file.flush();
+}
+
+void PlantEventLog::writeEvent(const PlantEvent &event,
+                               const PlantState &stateAfter) {
+  m_file.write(event.toLine());
+  m_last = event;
+  m_hasLast = true;
+  ++m_eventCount;
+  if (++m_eventsSinceSnapshot >= static_cast<quint64>(kSnapshotInterval))
+    writeSnapshot(stateAfter);
+}
+
+QVector<PlantEvent> PlantEventLog::merge(const QVector<PlantEvent> &incoming,
+                                         PlantState *state) {
+  if (incoming.isEmpty() || !m_file.isOpen())
+    return QVector<PlantEvent>();
+
+  // 常见情况：新事件都晚于本地最后一条，直接追加
+  if (!m_hasLast || PlantEvent::before(m_last, incoming.first())) {
+    for (const PlantEvent &event : incoming) {
+      state->apply(event);
+      writeEvent(event, *state);
+    }
+    m_file.flush();
+    return incoming;
+  }
+
+  // 迟到事件：回到早于第一条新事件的最近锚点，只重写其后的尾部
+  int keep = m_anchors.size();
+  while (keep > 0 &&
+         !PlantEvent::before(m_anchors[keep - 1].last, incoming.first()))
+    --keep;
+  QVector<PlantEvent> tail = readEvents(keep > 0 ? m_anchors[keep - 1].offset
+                                                 : 0);
+  // 同一秒内本地与远端事件的追加顺序可能不符合全序，先整理
+  std::stable_sort(tail.begin(), tail.end(), PlantEvent::before);
+
+  // 尾部已有的 ID 之外的才是新事件 (批次可能在提交检查点前被重复送达)
+  QSet<QPair<QByteArray, quint64> > known;
+  for (const PlantEvent &event : tail) {
+    if (!event.origin.isEmpty())
+      known.insert(qMakePair(event.origin, event.seq));
+  }
+  QVector<PlantEvent> inserted;
+  for (const PlantEvent &event : incoming) {
+    QPair<QByteArray, quint64> id = qMakePair(event.origin, event.seq);
+    if (!known.contains(id)) {
+      known.insert(id);
+      inserted.append(event);
+    }
+  }
+  if (inserted.isEmpty())
+    return inserted;
+
+  QVector<PlantEvent> merged;
+  merged.reserve(tail.size() + incoming.size());
+  std::merge(tail.constBegin(), tail.constEnd(), incoming.constBegin(),
+             incoming.constEnd(), std::back_inserter(merged),
+             PlantEvent::before);
+  merged.erase(std::unique(merged.begin(), merged.end(),
+                           [](const PlantEvent &a, const PlantEvent &b) {
+                             return a.sameId(b);
+                           }),
+               merged.end());
+
+  qCDebug(lcPlant) << "合并迟到事件，重写尾部" << merged.size() << "条";
+  rewriteTail(keep, merged, state);
+  return inserted;
+}
+
+QVector<PlantEvent> PlantEventLog::adoptOrigin(const QByteArray &device,
+                                               PlantState *state) {
+  m_file.flush();
+  QVector<PlantEvent> events = readEvents(0);
+  quint64 seq = 0;
+  for (const PlantEvent &event : events) {
+    if (event.origin == device)
+      seq = qMax(seq, event.seq);
+  }
+
+  bool changed = false;
+  QVector<PlantEvent> own;
+  for (PlantEvent &event : events) {
+    if (event.origin.isEmpty()) {
+      event.origin = device;
+      event.seq = ++seq;
+      changed = true;
+    }
+    if (event.origin == device)
+      own.append(event);
+  }
+  // 行变长后所有偏移失效，按原顺序整体重写一次，状态不变
+  if (changed)
+    rewriteTail(0, events, state);
+  return own;
+}
+
+PlantState PlantEventLog::stateAt(qint64 secs) {
+  int keep = m_anchors.size();
+  while (keep > 0 && m_anchors[keep - 1].last.timestamp > secs)
+    --keep;
+  PlantState state;
+  qint64 offset = 0;
+  if (keep > 0) {
+    QDataStream in(m_anchors[keep - 1].state);
+    in.setVersion(QDataStream::Qt_5_12);
+    readState(in, kSnapshotVersion, &state);
+    offset = m_anchors[keep - 1].offset;
+  }
+  for (const PlantEvent &event : readEvents(offset)) {
+    if (event.timestamp <= secs)
+      state.apply(event);
+  }
+  return state;
+}
+
+void PlantEventLog::rewriteTail(int keep, const QVector<PlantEvent> &events,
+                                PlantState *state) {
+  PlantState base;
+  qint64 offset = 0;
+  quint64 count = 0;
+  if (keep > 0) {
+    const Anchor &anchor = m_anchors[keep - 1];
+    QDataStream in(anchor.state);
+    in.setVersion(QDataStream::Qt_5_12);
+    readState(in, kSnapshotVersion, &base);
+    offset = anchor.offset;
+    count = anchor.count;
+  }
+
+  // 先把旧尾部存为撤销记录，重写中断时下次启动据此恢复
+  m_file.flush();
+  m_file.seek(offset);
+  QSaveFile undo(m_dir + "/events.rewrite");
+  if (!undo.open(QIODevice::WriteOnly)) {
+    qCWarning(lcPlant) << "无法写入撤销记录，放弃重写:" << undo.fileName();
+    m_file.seek(m_file.size());
+    return;
+  }
+  QDataStream out(&undo);
+  out.setVersion(QDataStream::Qt_5_12);
+  out << offset << m_file.readAll();
+  if (!undo.commit()) {
+    qCWarning(lcPlant) << "无法写入撤销记录，放弃重写:" << undo.fileName();
+    m_file.seek(m_file.size());
+    return;
+  }
+
+  m_file.resize(offset);
+  m_file.seek(offset);
+  saveAnchors(keep);
+  m_eventCount = count;
+  m_eventsSinceSnapshot = 0;
+  m_hasLast = keep > 0;
+  if (m_hasLast)
+    m_last = m_anchors[keep - 1].last;
+
+  *state = base;
+  for (const PlantEvent &event : events) {
+    state->apply(event);
+    writeEvent(event, *state);
+  }
+  writeSnapshot(*state);
+  QFile::remove(undo.fileName());
+}
+
+QVector<PlantEvent> PlantEventLog::readEvents(qint64 offset) {
+  m_file.flush();
+  m_file.seek(offset);
+  QVector<PlantEvent> events = parseEvents(m_file.readAll());
+  m_file.seek(m_file.size());
+  return events;
+}
+
+bool PlantEventLog::readLastEvent() {
+  const qint64 kTailBytes = 4096;
+  qint64 size = m_file.size();
+  m_file.seek(qMax<qint64>(0, size - kTailBytes));
+  QVector<PlantEvent> tail = parseEvents(m_file.readAll());
+  if (tail.isEmpty())
+    return false;
+  m_last = tail.last();
+  m_hasLast = true;
+  return true;
+}
+
+void PlantEventLog::recoverRewrite() {
+  QFile undo(m_dir + "/events.rewrite");
+  if (!undo.open(QIODevice::ReadOnly))
+    return;
+
+  QDataStream in(&undo);
+  in.setVersion(QDataStream::Qt_5_12);
+  qint64 offset = 0;
+  QByteArray oldTail;
+  in >> offset >> oldTail;
+  if (in.status() == QDataStream::Ok && offset <= m_file.size()) {
+    m_file.resize(offset);
+    m_file.seek(offset);
+    m_file.write(oldTail);
+    m_file.flush();
+    qCWarning(lcPlant) << "上次尾部重写未完成，已恢复原事件流";
+  }
+  undo.close();
+  undo.remove();
+  // 快照与锚点可能指向重写后的内容，全部作废，下次启动从头重放
+  QFile::remove(m_dir + "/plant.snapshot");
+  QFile::remove(m_dir + "/plant.anchors");
+}
+
+void PlantEventLog::loadAnchors() {
+  m_anchors.clear();
+  QFile file(m_dir + "/plant.anchors");
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_12);
+  quint32 magic = 0;
+  quint16 version = 0;
+  in >> magic >> version;
+  if (magic != kAnchorMagic || version != kAnchorVersion)
+    return;
+
+  while (!in.atEnd()) {
+    Anchor anchor;
+    QByteArray lastLine;
+    in >> lastLine >> anchor.offset >> anchor.count >> anchor.state;
+    // 写到一半的记录或越过文件末尾的锚点都不可用
+    if (in.status() != QDataStream::Ok ||
+        !PlantEvent::fromLine(lastLine, &anchor.last) ||
+        anchor.offset > m_file.size())
+      break;
+    m_anchors.append(anchor);
+  }
+}
+
+void PlantEventLog::saveAnchors(int keep) {
+  m_anchors.resize(keep);
+  QSaveFile file(m_dir + "/plant.anchors");
+  if (!file.open(QIODevice::WriteOnly)) {
+    qCWarning(lcPlant) << "无法写入锚点:" << file.fileName();
+    return;
+  }
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_12);
+  out << kAnchorMagic << kAnchorVersion;
+  for (const Anchor &anchor : m_anchors)
+    out << anchor.last.toLine() << anchor.offset << anchor.count
+        << anchor.state;
+  file.commit();
+}
+
+bool PlantEventLog::readSnapshot(PlantState *state, qint64 *offset,
+                                 quint64 *count) const {
+  QFile file(m_dir + "/plant.snapshot");
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_12);
+  quint32 magic = 0;
+  quint16 version = 0;
+  in >> magic >> version;
+  if (magic != kSnapshotMagic || version < 1 || version > kSnapshotVersion)
+    return false;
+
+  in >> *count >> *offset;
+  readState(in, version, state);
+  return in.status() == QDataStream::Ok;
+}
+
+void PlantEventLog::writeSnapshot(const PlantState &state) {
+  m_file.flush();
+  QSaveFile file(m_dir + "/plant.snapshot");
+  if (!file.open(QIODevice::WriteOnly)) {
+    qCWarning(lcPlant) << "无法写入快照:" << file.fileName();
+    return;
+  }
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_12);
+  out << kSnapshotMagic << kSnapshotVersion << m_eventCount << m_file.pos();
+  writeState(out, state);
+  if (!file.commit())
+    return;
+  m_eventsSinceSnapshot = 0;
+
+  // 同一状态追加为锚点，供合并迟到事件时回退
+  if (!m_hasLast)
+    return;
+  Anchor anchor;
+  anchor.last = m_last;
+  anchor.offset = m_file.pos();
+  anchor.count = m_eventCount;
+  QDataStream blob(&anchor.state, QIODevice::WriteOnly);
+  blob.setVersion(QDataStream::Qt_5_12);
+  writeState(blob, state);
+
+  QFile anchors(m_dir + "/plant.anchors");
+  if (!anchors.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    qCWarning(lcPlant) << "无法写入锚点:" << anchors.fileName();
+    return;
+  }
+  QDataStream record(&anchors);
+  record.setVersion(QDataStream::Qt_5_12);
+  if (anchors.size() == 0)
+    record << kAnchorMagic << kAnchorVersion;
+  record << anchor.last.toLine() << anchor.offset << anchor.count
+         << anchor.state;
+  m_anchors.append(anchor);
+  if (m_anchors.size() > m_anchorLimit)
+    compactAnchors();
+}
+
+void PlantEventLog::compactAnchors() {
+  // 迟到事件多在最近几天内，更早的合并少见，回退远一些也只是多重放
+  const qint64 dense =
+      m_anchors.last().last.timestamp - qint64(kDenseAnchorDays) * 86400;
+  QVector<Anchor> kept;
+  kept.reserve(m_anchors.size());
+  int month = -1;
+  for (const Anchor &anchor : m_anchors) {
+    if (anchor.last.timestamp < dense) {
+      const QDate day =
+          QDateTime::fromSecsSinceEpoch(anchor.last.timestamp).date();
+      const int key = day.year() * 12 + day.month();
+      if (key == month)
+        continue;
+      month = key;
+    }
+    kept.append(anchor);
+  }
+  qCDebug(lcPlant) << "整理锚点" << m_anchors.size() << "->" << kept.size();
+  m_anchors = kept;
+  saveAnchors(m_anchors.size());
+  // 近期锚点本身就多时不必每次快照都重写
+  m_anchorLimit = qMax(kMaxAnchors, m_anchors.size() * 2);
+}
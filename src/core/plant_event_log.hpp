@@ -0,0 +1,116 @@
+#ifndef PLANT_EVENT_LOG_HPP
+#define PLANT_EVENT_LOG_HPP
+
+#include "drink_record_store.hpp"
+#include <QByteArray>
+#include <QDate>
+#include <QFile>
+#include <QMap>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+// 植物系统的领域事件，只追加、永不修改
+struct PlantEvent {
+  enum Type {
+    Drink = 'D',      // value: 饮水量 ml
+    Harvest = 'H',    // 收成一次
+    GoalChange = 'G', // value: 新的每日目标 ml
+    Seed = 'S'        // 旧版数据迁移: value 成长值, extra 收成次数
+  };
+
+  Type type;
+  qint64 timestamp; // Unix 秒
+  int value;
+  int extra;
+  QByteArray origin; // 产生事件的设备 ID，启用同步前为空
+  quint64 seq;       // 该设备上的序号，(origin, seq) 全局唯一
+
+  // 行格式: "D 1760000000 250"，启用同步后追加 " @<origin>:<seq>"
+  QByteArray toLine() const;
+  static bool fromLine(const QByteArray &line, PlantEvent *event);
+
+  // 多设备合并后的全序: (时间, 设备, 序号)，各设备折叠出的状态因此一致
+  static bool before(const PlantEvent &a, const PlantEvent &b);
+  bool sameId(const PlantEvent &other) const {
+    return !origin.isEmpty() && origin == other.origin && seq == other.seq;
+  }
+};
+
+Q_DECLARE_METATYPE(PlantEvent)
+
+// 事件流折叠出的植物状态，快照就是它的序列化结果
+struct PlantState {
+  PlantState();
+  void apply(const PlantEvent &event);
+
+  int growthValue;
+  int harvestCount;
+  int dailyGoal;        // 0 表示尚未记录过目标
+  QMap<QDate, int> goalByDay; // 目标变化时间线：某日最后一次设定的目标
+  qint64 lastDrinkTime; // 0 表示从未喝过水
+  QDate day;            // dayIntake / dayDrinks 所属的日期
+  int dayIntake;
+  DrinkRecordStore dayDrinks;
+};
+
+// logs/events.log 追加写事件，每 kSnapshotInterval 条事件写一次
+// logs/plant.snapshot。启动时只需加载快照并重放其后的少量事件。
+// 每次快照同时追加到 logs/plant.anchors，合并其他设备的迟到事件时
+// 从最近的锚点重写尾部，而不是重放全部历史。锚点过多时较早的
+// 只保留每月一个，文件与内存占用不随历史无限增长。
+class PlantEventLog {
+public:
+  static const int kSnapshotInterval = 100;
+
+  explicit PlantEventLog(const QString &dir = "logs");
+  ~PlantEventLog();
+
+  // 恢复状态；返回 false 表示事件流此前不存在 (需要迁移旧数据)
+  bool load(PlantState *state);
+  void append(const PlantEvent &event, const PlantState &stateAfter);
+
+  // 并入按 PlantEvent::before 排好序的外部事件，已有的同 ID 事件跳过。
+  // 全部晚于已有事件时直接追加，否则从早于它们的最近锚点起重写尾部。
+  // 返回实际新增的事件，重复送达的批次返回空
+  QVector<PlantEvent> merge(const QVector<PlantEvent> &incoming,
+                            PlantState *state);
+  // 给尚未标注来源的事件补上本机来源 (首次启用同步时)，返回本机的全部事件
+  QVector<PlantEvent> adoptOrigin(const QByteArray &device, PlantState *state);
+  // 截至 secs (含) 的状态：从不晚于它的最近锚点折叠，不改动事件流
+  PlantState stateAt(qint64 secs);
+
+  quint64 eventCount() const;
+
+private:
+  struct Anchor {
+    PlantEvent last; // 锚点前的最后一条事件
+    qint64 offset;
+    quint64 count;
+    QByteArray state;
+  };
+
+  bool readSnapshot(PlantState *state, qint64 *offset, quint64 *count) const;
+  void writeSnapshot(const PlantState &state);
+  void writeEvent(const PlantEvent &event, const PlantState &stateAfter);
+  // 从第 keep 个锚点处截断并写入 events，state 从该锚点的状态折叠
+  void rewriteTail(int keep, const QVector<PlantEvent> &events,
+                   PlantState *state);
+  QVector<PlantEvent> readEvents(qint64 offset);
+  bool readLastEvent();
+  void loadAnchors();
+  void saveAnchors(int keep); // 只保留前 keep 个锚点
+  void compactAnchors();      // 稀疏化较早的锚点并重写锚点文件
+  void recoverRewrite();      // 撤销上次中断的尾部重写
+
+  QString m_dir;
+  QFile m_file;
+  quint64 m_eventCount;
+  quint64 m_eventsSinceSnapshot;
+  PlantEvent m_last; // 事件流中的最后一条事件 (m_hasLast 为真时有效)
+  bool m_hasLast;
+  QVector<Anchor> m_anchors;
+  int m_anchorLimit; // 锚点数超过它时整理
+};
+
+#endif // PLANT_EVENT_LOG_HPP
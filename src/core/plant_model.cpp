@@ -0,0 +1,77 @@
+#include "plant_model.hpp"
+
+namespace PlantModel {
+
+namespace {
+
+const GrowthStage kGrowthStages[] = {
+    {0, PlantSystem::Seedling}, {50, PlantSystem::Small},
+    {150, PlantSystem::Medium}, {300, PlantSystem::Large},
+    {kHarvestGrowth, PlantSystem::Flowering}};
+
+// 24 小时不喝水开始枯萎
+const DecayStage kDecayStages[] = {{24 * 3600, PlantSystem::Wilting}};
+
+const StatusInfo kStatusInfo[] = {
+    {PlantSystem::Seedling, "萌芽期", "🌱"},
+    {PlantSystem::Small, "小苗期", "🌿"},
+    {PlantSystem::Medium, "成长期", "🌳"},
+    {PlantSystem::Large, "繁茂期", "🌲"},
+    {PlantSystem::Flowering, "开花期", "🌸"},
+    {PlantSystem::Wilting, "缺水枯萎", "🍂"}};
+
+template <typename T, int N> int countOf(const T (&)[N]) { return N; }
+
+const StatusInfo *findInfo(PlantSystem::PlantStatus status) {
+  for (int i = 0; i < countOf(kStatusInfo); ++i) {
+    if (kStatusInfo[i].status == status)
+      return &kStatusInfo[i];
+  }
+  return nullptr;
+}
+
+} // namespace
+
+PlantSystem::PlantStatus evaluate(int growthValue, const QDateTime &lastDrink,
+                                  const QDateTime &now) {
+  // 衰败优先：从最严重的阶段往回找
+  if (lastDrink.isValid()) {
+    qint64 idleSecs = lastDrink.secsTo(now);
+    for (int i = countOf(kDecayStages) - 1; i >= 0; --i) {
+      if (idleSecs >= kDecayStages[i].afterSecs)
+        return kDecayStages[i].status;
+    }
+  }
+
+  PlantSystem::PlantStatus status = kGrowthStages[0].status;
+  for (int i = 0; i < countOf(kGrowthStages); ++i) {
+    if (growthValue >= kGrowthStages[i].minGrowth)
+      status = kGrowthStages[i].status;
+  }
+  return status;
+}
+
+QDateTime nextDecayTransition(const QDateTime &lastDrink,
+                              const QDateTime &now) {
+  if (!lastDrink.isValid())
+    return QDateTime();
+
+  for (int i = 0; i < countOf(kDecayStages); ++i) {
+    QDateTime at = lastDrink.addSecs(kDecayStages[i].afterSecs);
+    if (at > now)
+      return at;
+  }
+  return QDateTime();
+}
+
+QString statusName(PlantSystem::PlantStatus status) {
+  const StatusInfo *info = findInfo(status);
+  return info ? QString::fromUtf8(info->name) : QString();
+}
+
+QString statusIcon(PlantSystem::PlantStatus status) {
+  const StatusInfo *info = findInfo(status);
+  return info ? QString::fromUtf8(info->icon) : QString();
+}
+
+} // namespace PlantModel
@@ -0,0 +1,45 @@
+#ifndef PLANT_MODEL_HPP
+#define PLANT_MODEL_HPP
+
+#include "plant_system.hpp"
+#include <QDateTime>
+#include <QString>
+
+// 表驱动的植物成长/衰败模型：状态完全由 (成长值, 上次饮水时间, 当前时间)
+// 惰性求值得出，不需要任何轮询。
+namespace PlantModel {
+
+// 成长曲线：成长值达到 minGrowth 即进入对应阶段 (按阈值升序排列)
+struct GrowthStage {
+  int minGrowth;
+  PlantSystem::PlantStatus status;
+};
+
+// 衰败阶段：距上次饮水超过 afterSecs 秒即进入对应阶段 (按时长升序排列)
+struct DecayStage {
+  qint64 afterSecs;
+  PlantSystem::PlantStatus status;
+};
+
+// 状态的展示信息 (日志、统计面板共用)
+struct StatusInfo {
+  PlantSystem::PlantStatus status;
+  const char *name;
+  const char *icon;
+};
+
+const int kGrowthPerDrink = 10;  // 每次饮水增加的成长值
+const int kHarvestGrowth = 500;  // 可收成的成长值
+
+PlantSystem::PlantStatus evaluate(int growthValue, const QDateTime &lastDrink,
+                                  const QDateTime &now);
+
+// 下一次「仅由时间流逝」引起的状态变化时刻，没有则返回无效时间
+QDateTime nextDecayTransition(const QDateTime &lastDrink, const QDateTime &now);
+
+QString statusName(PlantSystem::PlantStatus status);
+QString statusIcon(PlantSystem::PlantStatus status);
+
+} // namespace PlantModel
+
+#endif // PLANT_MODEL_HPP
@@ -1,217 +1,307 @@
 #include "plant_system.hpp"
-#include <QDebug>
-#include <QDir>
-#include <QFile>
+#include "clock.hpp"
+#include "history_sync.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include "plant_model.hpp"
+#include "trace.hpp"
+#include <QElapsedTimer>
 #include <QSettings>
-#include <QTextCodec>
-#include <QTextStream>
 
-PlantSystem::PlantSystem(QObject *parent)
-    : QObject(parent), m_growthValue(0), m_todayWaterIntake(0),
-      m_harvestCount(0), m_status(Seedling) {
-  loadGrowthData(); // 加载持久化成长数据
-  m_lastDrinkTime = QDateTime::currentDateTime();
-  loadTodayRecords(); // 加载今日历史记录
+namespace {
+// 系统休眠时单调时钟停走，定时器最长只睡一小时，保证唤醒后能及时追上
+const qint64 kMaxTransitionWaitMs = 3600 * 1000;
+
+// 以下查询由 PlantSystem 与 PlantSnapshot 共用
+int intakeToday(const PlantState &state, const QDate &currentDay) {
+  return state.day == currentDay ? state.dayIntake : 0;
 }
 
-void PlantSystem::recordDrink(int ml) {
-  m_todayWaterIntake += ml;
-  m_growthValue += 10; // 这里的数值可以更复杂一点
-  m_lastDrinkTime = QDateTime::currentDateTime();
+const DrinkRecordStore &recordsToday(const PlantState &state,
+                                     const QDate &currentDay) {
+  static const DrinkRecordStore kEmpty;
+  return state.day == currentDay ? state.dayDrinks : kEmpty;
+}
+
+int goalOnDay(const PlantState &state, const QDate &day) {
+  const QMap<QDate, int> &goals = state.goalByDay;
+  if (goals.isEmpty())
+    return state.dailyGoal;
+  QMap<QDate, int>::const_iterator it = goals.upperBound(day);
+  if (it == goals.constBegin())
+    return it.value(); // 早于第一次记录，沿用最早的目标
+  return (--it).value();
+}
+
+QDateTime lastDrinkOf(const PlantState &state) {
+  return state.lastDrinkTime > 0
+             ? QDateTime::fromSecsSinceEpoch(state.lastDrinkTime)
+             : QDateTime();
+}
+} // namespace
+
+PlantSystem::PlantSystem(const QString &historyBackend, QObject *parent)
+    : QObject(parent), m_historyBackend(historyBackend), m_store(nullptr),
+      m_sync(nullptr) {
+  qRegisterMetaType<QVector<PlantEvent>>("QVector<PlantEvent>");
+  m_transitionTimer = new ClockTimer(this);
+  m_transitionTimer->setSingleShot(true);
+  m_transitionTimer->setTimerType(Qt::VeryCoarseTimer);
+  connect(m_transitionTimer, &ClockTimer::timeout, this,
+          &PlantSystem::onTransitionDue);
+
+  m_currentDay = Clock::instance()->today();
+  // 一次快照加载 + 少量尾部事件重放
+  if (!m_eventLog.load(&m_state)) {
+    migrateLegacyData();
+    // 存储实例只能在打开它的线程中使用，移入状态线程后再重新打开
+    delete m_store;
+    m_store = nullptr;
+  }
+  publishSnapshot();
+  scheduleNextTransition();
+}
+
+PlantSystem::~PlantSystem() { delete m_store; }
 
-  // 添加饮水记录
-  DrinkRecord record;
-  record.timestamp = m_lastDrinkTime;
-  record.amount = ml;
-  m_drinkRecords.append(record);
+HistoryStore *PlantSystem::historyStore() {
+  if (!m_store)
+    m_store = HistoryStore::open(m_historyBackend, "logs",
+                                 HistoryStore::ReadWrite);
+  return m_store;
+}
 
-  // 写入日志文件
-  writeToLog(ml);
-  // 持久化保存
-  saveGrowthData();
+void PlantSystem::setSync(HistorySync *sync) {
+  m_sync = sync;
+  if (sync) {
+    sync->publishExisting(m_eventLog.adoptOrigin(sync->deviceId(), &m_state));
+    publishSnapshot();
+  }
+}
 
+int PlantSystem::mergeRemoteEvents(const QVector<PlantEvent> &events) {
+  OASIS_TRACE_SCOPE("PlantSystem::mergeRemoteEvents");
+  // 其他设备的事件不经过 DrinkIngest，饮水量按同样的范围在这里检查
+  QVector<PlantEvent> valid;
+  valid.reserve(events.size());
+  for (const PlantEvent &event : events) {
+    if (event.type == PlantEvent::Drink &&
+        (event.value <= 0 || event.value > DrinkRecordStore::kMaxAmount)) {
+      qCWarning(lcPlant) << "忽略超出范围的远端饮水量:" << event.value
+                         << "来源:" << event.origin;
+      continue;
+    }
+    valid.append(event);
+  }
+  // 只有事件流里真正新增的饮水才写入派生历史，重复送达的批次不会重复计数
+  const QVector<PlantEvent> inserted = m_eventLog.merge(valid, &m_state);
+  QVector<PlantEvent> drinks;
+  for (const PlantEvent &event : inserted) {
+    if (event.type != PlantEvent::Drink)
+      continue;
+    writeToLog(event, false);
+    drinks.append(event);
+  }
+  // 派生历史写完才推进检查点
+  if (m_sync)
+    m_sync->commit();
+  if (inserted.isEmpty())
+    return 0;
+  if (!drinks.isEmpty())
+    emit remoteDrinksMerged(drinks);
   updateState();
+  return drinks.size();
 }
 
-void PlantSystem::updateState() {
-  // 检查枯萎逻辑 (24小时不喝水开始枯萎)
-  qint64 hoursSinceLastDrink =
-      m_lastDrinkTime.secsTo(QDateTime::currentDateTime()) / 3600;
-
-  if (hoursSinceLastDrink > 24) {
-    m_status = Wilting;
-  } else {
-    calculateStatus();
+void PlantSystem::applyEvent(PlantEvent event) {
+  if (m_sync)
+    m_sync->publish(&event); // 分配来源与序号
+  m_state.apply(event);
+  m_eventLog.append(event, m_state);
+  publishSnapshot();
+}
+
+void PlantSystem::publishSnapshot() {
+  std::shared_ptr<PlantSnapshot> snapshot = std::make_shared<PlantSnapshot>();
+  snapshot->state = m_state;
+  snapshot->currentDay = m_currentDay;
+  std::atomic_store(&m_snapshot, PlantSnapshotPtr(std::move(snapshot)));
+}
+
+PlantSnapshotPtr PlantSystem::snapshot() const {
+  return std::atomic_load(&m_snapshot);
+}
+
+void PlantSystem::recordDrink(int ml) {
+  OASIS_TRACE_SCOPE("PlantSystem::recordDrink");
+  PlantEvent event = {PlantEvent::Drink, Clock::instance()->currentSecs(),
+                      ml, 0};
+  // 持久化耗时：事件日志 + 派生日志，不含信号分发
+  QElapsedTimer persistTimer;
+  persistTimer.start();
+  applyEvent(event);
+  writeToLog(event, true);
+  Metrics::registry().drinkPersistLatency.observe(persistTimer.nsecsElapsed() /
+                                                  1e9);
+
+  emit drinkRecorded(QDateTime::fromSecsSinceEpoch(event.timestamp), ml);
+  if (m_state.day != m_currentDay) {
+    // 跨天后定时器尚未触发就先喝了水
+    m_currentDay = m_state.day;
+    emit dayRolledOver(m_currentDay);
   }
 
+  updateState();
+}
+
+void PlantSystem::recordGoalChange(int ml) {
+  if (ml == m_state.dailyGoal)
+    return;
+  PlantEvent event = {PlantEvent::GoalChange, Clock::instance()->currentSecs(),
+                      ml, 0};
+  applyEvent(event);
+}
+
+void PlantSystem::updateState() {
+  publishSnapshot(); // 跨天只改变 m_currentDay，也要发布
+  scheduleNextTransition();
   emit plantUpdated();
 }
 
-void PlantSystem::calculateStatus() {
-  if (m_growthValue < 50)
-    m_status = Seedling;
-  else if (m_growthValue < 150)
-    m_status = Small;
-  else if (m_growthValue < 300)
-    m_status = Medium;
-  else if (m_growthValue < 500)
-    m_status = Large;
-  else
-    m_status = Flowering;
-}
-
-void PlantSystem::writeToLog(int ml) {
-  // 创建 logs 目录（如果不存在）
-  QDir logsDir("logs");
-  if (!logsDir.exists()) {
-    logsDir.mkpath(".");
-  }
+QDateTime PlantSystem::nextTransitionTime() const {
+  QDateTime now = Clock::instance()->now();
+  // 跨天 (今日数据归零) 与枯萎都是由时间驱动的状态变化，取最近的一个
+  QDateTime next = QDateTime(m_currentDay.addDays(1), QTime(0, 0));
+  QDateTime decay = PlantModel::nextDecayTransition(lastDrinkTime(), now);
+  if (decay.isValid() && decay < next)
+    next = decay;
+  return next;
+}
 
-  // 生成日志文件名（按日期）
-  QString dateStr = QDateTime::currentDateTime().toString("yyyy-MM-dd");
-  QString logFileName = QString("logs/%1.log").arg(dateStr);
-
-  // 以追加模式打开文件
-  QFile logFile(logFileName);
-  if (logFile.open(QIODevice::Append | QIODevice::Text)) {
-    // 格式化日志内容
-    QString timeStr = QDateTime::currentDateTime().toString("hh:mm:ss");
-    QString statusStr;
-    switch (m_status) {
-    case Seedling:
-      statusStr = "萌芽期";
-      break;
-    case Small:
-      statusStr = "小苗期";
-      break;
-    case Medium:
-      statusStr = "成长期";
-      break;
-    case Large:
-      statusStr = "繁茂期";
-      break;
-    case Flowering:
-      statusStr = "开花期";
-      break;
-    case Wilting:
-      statusStr = "缺水枯萎";
-      break;
-    }
+void PlantSystem::scheduleNextTransition() {
+  qint64 waitMs = nextTransitionTime().toMSecsSinceEpoch() -
+                  Clock::instance()->currentMSecs();
+  m_transitionTimer->start(
+      static_cast<int>(qBound<qint64>(0, waitMs, kMaxTransitionWaitMs)));
+}
+
+void PlantSystem::onTransitionDue() {
+  QDate today = Clock::instance()->today();
+  if (today != m_currentDay) {
+    m_currentDay = today;
+    emit dayRolledOver(today);
+  }
+  updateState();
+}
 
-    // 构建日志行：时间 | 饮水量 | 今日总量 | 成长值 | 状态
-    QString logLine =
-        QString("%1 | %2ml | 今日总量: %3ml | 成长值: %4 | 状态: %5\n")
-            .arg(timeStr)
-            .arg(ml)
-            .arg(m_todayWaterIntake)
-            .arg(m_growthValue)
-            .arg(statusStr);
-
-    // 使用 toUtf8() 转换为 UTF-8 字节流写入
-    logFile.write(logLine.toUtf8());
-    logFile.close();
-  } else {
-    qWarning() << "无法打开日志文件:" << logFileName;
+void PlantSystem::writeToLog(const PlantEvent &event, bool local) {
+  OASIS_TRACE_SCOPE("PlantSystem::writeToLog");
+  DrinkEntry entry = {QDateTime::fromSecsSinceEpoch(event.timestamp),
+                      event.value, -1, -1, QString()};
+  // 合并来的饮水可能属于更早的日子，当前的今日累计与状态对它不成立
+  if (local) {
+    entry.dayTotal = todayWaterIntake();
+    entry.growth = growthValue();
+    entry.status = PlantModel::statusName(status());
   }
+  HistoryStore *store = historyStore();
+  if (!store->append(entry))
+    qCWarning(lcPlant) << "写入饮水历史失败:" << store->backendName();
 }
 
-void PlantSystem::loadTodayRecords() {
-  // 生成今日日志文件名
-  QString dateStr = QDateTime::currentDateTime().toString("yyyy-MM-dd");
-  QString logFileName = QString("logs/%1.log").arg(dateStr);
+void PlantSystem::migrateLegacyData() {
+  // 先导入今日已有的饮水记录，再用旧版成长数据覆盖成长值/收成次数，
+  // 这样重放结果与迁移前完全一致
+  loadTodayRecords();
+  loadGrowthData();
+}
 
-  QFile logFile(logFileName);
-  if (!logFile.exists()) {
-    qDebug() << "今日日志文件不存在，从零开始";
+void PlantSystem::loadTodayRecords() {
+  OASIS_TRACE_SCOPE("PlantSystem::loadTodayRecords");
+  const QDate today = Clock::instance()->today();
+  int recordCount = historyStore()->readDay(
+      today, [this, &today](const QTime &time, int amount) {
+        // 转换为饮水事件
+        PlantEvent event = {PlantEvent::Drink,
+                            QDateTime(today, time).toSecsSinceEpoch(), amount,
+                            0};
+        applyEvent(event);
+      });
+
+  if (recordCount == 0) {
+    qCDebug(lcPlant) << "今日没有旧版饮水记录，从零开始";
     return;
   }
+  qCDebug(lcPlant) << "已导入" << recordCount << "条今日饮水记录，总量:"
+                   << todayWaterIntake() << "ml";
+}
 
-  if (logFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    QTextStream in(&logFile);
-    in.setCodec("UTF-8");
-
-    int recordCount = 0;
-    while (!in.atEnd()) {
-      QString line = in.readLine();
-      // 解析日志行格式: "14:30:25 | 250ml | 今日总量: 500ml | 成长值: 20 |
-      // 状态: 萌芽期"
-      QStringList parts = line.split(" | ");
-      if (parts.size() >= 4) {
-        // 提取时间
-        QString timeStr = parts[0].trimmed();
-        QTime time = QTime::fromString(timeStr, "hh:mm:ss");
-
-        // 提取饮水量
-        QString amountStr = parts[1].trimmed();
-        amountStr.remove("ml");
-        int amount = amountStr.toInt();
-
-        // 提取今日总量
-        QString totalStr = parts[2].trimmed();
-        totalStr.remove("今日总量: ").remove("ml");
-        int total = totalStr.toInt();
-
-        // 提取成长值
-        QString growthStr = parts[3].trimmed();
-        growthStr.remove("成长值: ");
-        int growth = growthStr.toInt();
-
-        // 创建记录
-        DrinkRecord record;
-        record.timestamp = QDateTime(QDate::currentDate(), time);
-        record.amount = amount;
-        m_drinkRecords.append(record);
-
-        // 更新统计数据（使用最后一条记录的值）
-        m_todayWaterIntake = total;
-        // 注意：不在这里加载 m_growthValue，已由 loadGrowthData 处理
-        m_lastDrinkTime = record.timestamp;
-
-        recordCount++;
-      }
-    }
+void PlantSystem::loadGrowthData() {
+  QSettings settings("Agil", "OasisGrowth");
+  if (!settings.contains("total_growth"))
+    return;
 
-    logFile.close();
+  PlantEvent event = {PlantEvent::Seed, Clock::instance()->currentSecs(),
+                      settings.value("total_growth", 0).toInt(),
+                      settings.value("harvest_count", 0).toInt()};
+  applyEvent(event);
+  qCDebug(lcPlant) << "已导入旧版成长数据，成长值:" << m_state.growthValue
+                   << "收成次数:" << m_state.harvestCount;
+}
 
-    // 更新状态
-    calculateStatus();
+int PlantSystem::growthValue() const { return m_state.growthValue; }
 
-    qDebug() << "已加载" << recordCount
-             << "条今日饮水记录，总量:" << m_todayWaterIntake
-             << "ml，成长值:" << m_growthValue;
-  } else {
-    qWarning() << "无法打开日志文件:" << logFileName;
-  }
+PlantSystem::PlantStatus PlantSystem::status() const {
+  return PlantModel::evaluate(m_state.growthValue, lastDrinkTime(),
+                              Clock::instance()->now());
+}
+
+PlantSystem::PlantStatus PlantSystem::statusAt(const QDateTime &when) {
+  const PlantState state = m_eventLog.stateAt(when.toSecsSinceEpoch());
+  return PlantModel::evaluate(state.growthValue, lastDrinkOf(state), when);
+}
+
+int PlantSystem::todayWaterIntake() const {
+  return intakeToday(m_state, m_currentDay);
 }
 
-int PlantSystem::growthValue() const { return m_growthValue; }
-PlantSystem::PlantStatus PlantSystem::status() const { return m_status; }
-int PlantSystem::todayWaterIntake() const { return m_todayWaterIntake; }
+const DrinkRecordStore &PlantSystem::todayDrinkRecords() const {
+  return recordsToday(m_state, m_currentDay);
+}
 
-QList<PlantSystem::DrinkRecord> PlantSystem::todayDrinkRecords() const {
-  return m_drinkRecords;
+int PlantSystem::goalOn(const QDate &day) const {
+  return goalOnDay(m_state, day);
 }
 
-int PlantSystem::harvestCount() const { return m_harvestCount; }
+QDateTime PlantSystem::lastDrinkTime() const { return lastDrinkOf(m_state); }
+
+int PlantSystem::harvestCount() const { return m_state.harvestCount; }
 
 void PlantSystem::harvest() {
-  if (m_status == Flowering || m_growthValue >= 500) {
-    m_harvestCount++;
-    m_growthValue = 0; // 重置成长周期
-    saveGrowthData();
-    calculateStatus();
+  if (status() == Flowering ||
+      m_state.growthValue >= PlantModel::kHarvestGrowth) {
+    PlantEvent event = {PlantEvent::Harvest,
+                        Clock::instance()->currentSecs(), 0, 0};
+    applyEvent(event);
     emit plantUpdated();
   }
 }
 
-void PlantSystem::saveGrowthData() {
-  QSettings settings("Agil", "OasisGrowth");
-  settings.setValue("total_growth", m_growthValue);
-  settings.setValue("harvest_count", m_harvestCount);
+int PlantSnapshot::todayWaterIntake() const {
+  return intakeToday(state, currentDay);
 }
 
-void PlantSystem::loadGrowthData() {
-  QSettings settings("Agil", "OasisGrowth");
-  m_growthValue = settings.value("total_growth", 0).toInt();
-  m_harvestCount = settings.value("harvest_count", 0).toInt();
+const DrinkRecordStore &PlantSnapshot::todayDrinkRecords() const {
+  return recordsToday(state, currentDay);
+}
+
+PlantSystem::PlantStatus PlantSnapshot::status() const {
+  return PlantModel::evaluate(state.growthValue, lastDrinkTime(),
+                              Clock::instance()->now());
 }
+
+int PlantSnapshot::goalOn(const QDate &day) const {
+  return goalOnDay(state, day);
+}
+
+QDateTime PlantSnapshot::lastDrinkTime() const { return lastDrinkOf(state); }
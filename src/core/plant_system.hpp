@@ -1,48 +1,102 @@
 #ifndef PLANT_SYSTEM_HPP
 #define PLANT_SYSTEM_HPP
 
+#include "history_store.hpp"
+#include "plant_event_log.hpp"
 #include <QDateTime>
 #include <QObject>
+#include <memory>
 
+class ClockTimer;
+class HistorySync;
+struct PlantSnapshot;
+typedef std::shared_ptr<const PlantSnapshot> PlantSnapshotPtr;
+
+// 植物状态的唯一持有者。运行时整个对象归独立的状态线程所有，
+// 饮水经 DrinkIngest 汇入；其他线程只通过 snapshot() 读取。
+// 除 snapshot() 外的查询只能在状态线程 (或未移入线程时的创建线程) 调用。
 class PlantSystem : public QObject {
   Q_OBJECT
 public:
   enum PlantStatus { Seedling, Small, Medium, Large, Flowering, Wilting };
 
-  // 饮水记录结构
-  struct DrinkRecord {
-    QDateTime timestamp;
-    int amount; // ml
-  };
+  // historyBackend 为按日历史的存储后端 ("text" 或 "sqlite")，
+  // 首次启用事件流时的旧数据迁移也从这里读取
+  explicit PlantSystem(const QString &historyBackend = "text",
+                       QObject *parent = nullptr);
+  ~PlantSystem();
 
-  explicit PlantSystem(QObject *parent = nullptr);
+  // 接入多设备同步 (不取得所有权)：补齐本机事件的来源并与共享日志对账，
+  // 之后的本机事件都会写入共享日志
+  void setSync(HistorySync *sync);
+  // 并入其他设备的新事件 (已排好全序) 并提交同步检查点，饮水量超出
+  // (0, DrinkRecordStore::kMaxAmount] 的丢弃。返回其中新增的饮水记录数
+  int mergeRemoteEvents(const QVector<PlantEvent> &events);
 
   void recordDrink(int ml);
-  void updateState(); // 每小时或每天调用一次，更新枯萎逻辑
+  void updateState(); // 重新求值状态并预约下一次状态变化
+
+  // 最近一次状态变化后的不可变快照，任意线程一次原子加载即可取得
+  PlantSnapshotPtr snapshot() const;
 
   int growthValue() const;
-  PlantStatus status() const;
+  PlantStatus status() const; // 按当前时间惰性求值
+  // 按 when 时的成长值与上次饮水求值 (回放事件流)，用于往周的周报
+  PlantStatus statusAt(const QDateTime &when);
   int todayWaterIntake() const;
   int harvestCount() const;
   void harvest();                               // 收成逻辑
-  QList<DrinkRecord> todayDrinkRecords() const; // 获取今日饮水记录
+  const DrinkRecordStore &todayDrinkRecords() const; // 获取今日饮水记录
+
+  // 该日生效的每日目标；早于首次记录时取最早的目标，没有记录时取当前目标
+  int goalOn(const QDate &day) const;
+  QDateTime lastDrinkTime() const;
+  QDateTime nextTransitionTime() const; // 下一次由时间驱动的状态变化时刻
+
+public slots:
+  void recordGoalChange(int ml); // 每日目标变化也进入事件流
 
 signals:
   void plantUpdated();
+  void drinkRecorded(const QDateTime &when, int ml);
+  void dayRolledOver(const QDate &newDay);
+  void remoteDrinksMerged(const QVector<PlantEvent> &drinks);
+
+private slots:
+  void onTransitionDue();
 
 private:
-  int m_growthValue;
-  int m_todayWaterIntake;
-  int m_harvestCount; // 收成次数
-  QDateTime m_lastDrinkTime;
-  PlantStatus m_status;
-  QList<DrinkRecord> m_drinkRecords; // 今日饮水记录
-
-  void calculateStatus();
-  void writeToLog(int ml); // 写入日志文件
-  void loadTodayRecords(); // 从日志文件加载今日记录
-  void saveGrowthData();   // 持久化成长数据
-  void loadGrowthData();   // 加载持久化成长数据
+  PlantState m_state;       // 由事件流重放得到的唯一状态
+  PlantEventLog m_eventLog; // 追加写事件 + 周期快照
+  QDate m_currentDay;
+  ClockTimer *m_transitionTimer; // 单次定时器，只在下一次状态变化时唤醒
+  QString m_historyBackend;
+  HistoryStore *m_store; // 按日饮水历史 (由事件派生)，按需在所在线程打开
+  HistorySync *m_sync;
+  PlantSnapshotPtr m_snapshot; // 只用 std::atomic_load/atomic_store 访问
+
+  void applyEvent(PlantEvent event); // 本机产生的事件
+  void publishSnapshot();
+  void scheduleNextTransition();
+  // 写入按日历史 (由事件派生)；local 为假时不记录当时的养成状态
+  void writeToLog(const PlantEvent &event, bool local);
+  HistoryStore *historyStore();
+  void migrateLegacyData();   // 首次启用事件流时导入旧版数据
+  void loadTodayRecords();    // 从旧版日志文件导入今日记录
+  void loadGrowthData();      // 从旧版 QSettings 导入成长数据
+};
+
+// 某一时刻的植物状态副本，发布后不再修改。各容器隐式共享，发布只是
+// 引用计数加一；状态线程下一次写入时分离复制，开销与当天记录数成正比。
+struct PlantSnapshot {
+  PlantState state;
+  QDate currentDay; // 状态线程认定的今天，跨天后今日数据归零
+
+  int todayWaterIntake() const;
+  const DrinkRecordStore &todayDrinkRecords() const;
+  PlantSystem::PlantStatus status() const; // 按当前时间惰性求值
+  int goalOn(const QDate &day) const;
+  QDateTime lastDrinkTime() const;
 };
 
 #endif // PLANT_SYSTEM_HPP
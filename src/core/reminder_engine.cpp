@@ -1,23 +1,35 @@
 #include "reminder_engine.hpp"
+#include "clock.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
 #include <QDateTime>
-#include <QDebug>
+
+namespace {
+// 固定时刻模式的最长休眠，防止系统休眠或改时钟后错过时刻
+const int kMaxFixedWaitMs = 3600 * 1000;
+} // namespace
 
 ReminderEngine::ReminderEngine(QObject *parent)
     : QObject(parent), m_mode(IntervalMode), m_intervalMinutes(60),
-      m_isDND(false), m_dndEnabled(true), m_dndStart(23, 0), m_dndEnd(8, 0) {
-
-  m_timer = new QTimer(this);
-  connect(m_timer, &QTimer::timeout, this, &ReminderEngine::onTimerTimeout);
-
-  m_momentChecker = new QTimer(this);
-  m_momentChecker->setInterval(1000); // 每秒检查一次，实现精准提醒
-  connect(m_momentChecker, &QTimer::timeout, this,
+      m_fixedRunning(false), m_isDND(false), m_dndEnabled(true),
+      m_dndStart(23, 0), m_dndEnd(8, 0) {
+
+  m_timer = new ClockTimer(this);
+  connect(m_timer, &ClockTimer::timeout, this,
+          &ReminderEngine::onTimerTimeout);
+
+  // 精确定时器不会提前触发，唤醒时一定已进入目标分钟
+  m_momentChecker = new ClockTimer(this);
+  m_momentChecker->setSingleShot(true);
+  m_momentChecker->setTimerType(Qt::PreciseTimer);
+  connect(m_momentChecker, &ClockTimer::timeout, this,
           &ReminderEngine::checkFixedMoments);
 }
 
 void ReminderEngine::setMode(ReminderMode mode) {
   m_mode = mode;
-  if (m_timer->isActive() || m_momentChecker->isActive()) {
+  if (m_timer->isActive() || m_fixedRunning) {
     stop();
     start();
   }
@@ -26,28 +38,35 @@ void ReminderEngine::setMode(ReminderMode mode) {
 void ReminderEngine::setInterval(int minutes) {
   m_intervalMinutes = minutes;
   if (m_mode == IntervalMode && m_timer->isActive()) {
-    m_timer->start(m_intervalMinutes * 60000);
+    armInterval();
   }
 }
 
 void ReminderEngine::setFixedMoments(const QList<QTime> &moments) {
   m_fixedMoments = moments;
+  if (m_fixedRunning)
+    armFixedMoment();
 }
 
 void ReminderEngine::start() {
   if (m_mode == IntervalMode) {
-    m_timer->start(m_intervalMinutes * 60000);
+    armInterval();
   } else {
-    m_momentChecker->start();
+    m_fixedRunning = true;
+    armFixedMoment();
   }
-  qDebug() << "Reminder Engine started in"
-           << (m_mode == IntervalMode ? "Interval" : "Fixed") << "mode";
+  qCDebug(lcReminder) << "Reminder Engine started in"
+                      << (m_mode == IntervalMode ? "Interval" : "Fixed")
+                      << "mode";
 }
 
 void ReminderEngine::stop() {
   m_timer->stop();
   m_momentChecker->stop();
-  qDebug() << "Reminder Engine stopped";
+  m_fixedRunning = false;
+  m_armedMoment = QDateTime();
+  emit nextReminderChanged();
+  qCDebug(lcReminder) << "Reminder Engine stopped";
 }
 
 void ReminderEngine::setDND(bool active) { m_isDND = active; }
@@ -66,7 +85,7 @@ bool ReminderEngine::isDNDActive() const {
   if (!m_dndEnabled)
     return false;
 
-  QTime now = QTime::currentTime();
+  QTime now = Clock::instance()->time();
   if (m_dndStart <= m_dndEnd) {
     // 同一天内，如 23:00 - 23:59 (虽然通常跨天)
     return now >= m_dndStart && now <= m_dndEnd;
@@ -76,31 +95,94 @@ bool ReminderEngine::isDNDActive() const {
   }
 }
 
-void ReminderEngine::onTimerTimeout() {
-  if (!isDNDActive()) {
-    m_lastTriggerTime = QDateTime::currentDateTime();
-    emit reminderTriggered();
-  } else {
-    qDebug() << "Reminder skipped due to DND";
+void ReminderEngine::armInterval() {
+  m_timer->start(m_intervalMinutes * 60000);
+  m_nextIntervalDue = Clock::instance()->now().addSecs(m_intervalMinutes * 60);
+  Metrics::registry().remindersScheduled.inc();
+  emit nextReminderChanged();
+}
+
+QDateTime ReminderEngine::nextReminderTime() const {
+  if (m_mode == IntervalMode)
+    return m_timer->isActive() ? m_nextIntervalDue : QDateTime();
+  if (!m_fixedRunning)
+    return QDateTime();
+
+  QDateTime now = Clock::instance()->now();
+  QDateTime next;
+  for (const QTime &moment : m_fixedMoments) {
+    QDateTime at(now.date(), QTime(moment.hour(), moment.minute()));
+    // 该分钟已过去或本分钟内已触发过，则顺延到明天
+    if (at.addSecs(60) <= now ||
+        (m_lastTriggerTime.isValid() && m_lastTriggerTime >= at))
+      at = at.addDays(1);
+    if (!next.isValid() || at < next)
+      next = at;
   }
+  return next;
 }
 
-void ReminderEngine::checkFixedMoments() {
-  if (isDNDActive())
+void ReminderEngine::armFixedMoment() {
+  QDateTime next = nextReminderTime();
+  if (!next.isValid()) {
+    m_momentChecker->stop();
     return;
+  }
 
-  QDateTime now = QDateTime::currentDateTime();
-  // 如果 60 秒内已经触发过，跳过
-  if (m_lastTriggerTime.isValid() && m_lastTriggerTime.secsTo(now) < 60)
-    return;
+  qint64 wait = next.toMSecsSinceEpoch() - Clock::instance()->currentMSecs();
+  m_momentChecker->start(
+      static_cast<int>(qBound<qint64>(0, wait, kMaxFixedWaitMs)));
+  // 封顶后的中途唤醒不算新的预约
+  if (next != m_armedMoment) {
+    m_armedMoment = next;
+    Metrics::registry().remindersScheduled.inc();
+    emit nextReminderChanged();
+  }
+}
 
-  QTime currentTime = now.time();
-  for (const QTime &moment : m_fixedMoments) {
-    if (currentTime.hour() == moment.hour() &&
-        currentTime.minute() == moment.minute()) {
-      m_lastTriggerTime = now;
-      emit reminderTriggered();
-      break;
+void ReminderEngine::onTimerTimeout() {
+  OASIS_TRACE_SCOPE("ReminderEngine::onTimerTimeout");
+  QDateTime intended = m_nextIntervalDue;
+  // 重复定时器已自动进入下一周期
+  m_nextIntervalDue = intended.addSecs(m_intervalMinutes * 60);
+  Metrics::registry().remindersScheduled.inc();
+  fire(intended);
+  emit nextReminderChanged();
+}
+
+void ReminderEngine::checkFixedMoments() {
+  OASIS_TRACE_SCOPE("ReminderEngine::checkFixedMoments");
+  QDateTime now = Clock::instance()->now();
+  // 如果 60 秒内已经触发过（或已被免打扰跳过），不再重复触发
+  if (!m_lastTriggerTime.isValid() || m_lastTriggerTime.secsTo(now) >= 60) {
+    QTime currentTime = now.time();
+    for (const QTime &moment : m_fixedMoments) {
+      if (currentTime.hour() == moment.hour() &&
+          currentTime.minute() == moment.minute()) {
+        m_lastTriggerTime = now;
+        fire(QDateTime(now.date(), QTime(moment.hour(), moment.minute())));
+        break;
+      }
     }
   }
+  // 预约下一个固定时刻
+  armFixedMoment();
+}
+
+void ReminderEngine::fire(const QDateTime &intended) {
+  Metrics::Registry &metrics = Metrics::registry();
+  if (isDNDActive()) {
+    metrics.remindersSuppressed.inc();
+    qCDebug(lcReminder) << "Reminder skipped due to DND";
+    return;
+  }
+
+  const Clock *clock = Clock::instance();
+  QDateTime now = clock->now();
+  if (intended.isValid())
+    metrics.schedulingDrift.observe(
+        (clock->currentMSecs() - intended.toMSecsSinceEpoch()) / 1000.0);
+  metrics.remindersFired.inc();
+  m_lastTriggerTime = now;
+  emit reminderTriggered();
 }
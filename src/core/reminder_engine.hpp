@@ -5,7 +5,8 @@
 #include <QList>
 #include <QObject>
 #include <QTime>
-#include <QTimer>
+
+class ClockTimer;
 
 class ReminderEngine : public QObject {
   Q_OBJECT
@@ -21,6 +22,9 @@ public:
   void start();
   void stop();
 
+  // 下一次预定的提醒时刻 (不考虑免打扰)，未运行时无效
+  QDateTime nextReminderTime() const;
+
   bool isDNDActive() const; // Do Not Disturb
   void setDND(bool active);
   void setDNDRange(const QTime &start, const QTime &end);
@@ -28,18 +32,24 @@ public:
 
 signals:
   void reminderTriggered();
+  void nextReminderChanged();
 
 private slots:
   void onTimerTimeout();
   void checkFixedMoments();
 
 private:
+  void armInterval();
+  void armFixedMoment();
+  void fire(const QDateTime &intended);
+
   ReminderMode m_mode;
   int m_intervalMinutes;
   QList<QTime> m_fixedMoments;
 
-  QTimer *m_timer;
-  QTimer *m_momentChecker;
+  ClockTimer *m_timer;
+  ClockTimer *m_momentChecker; // 单次定时器，直接预约到下一个固定时刻
+  bool m_fixedRunning;
 
   bool m_isDND;
   bool m_dndEnabled;
@@ -47,6 +57,8 @@ private:
   QTime m_dndEnd;
 
   QDateTime m_lastTriggerTime;
+  QDateTime m_nextIntervalDue; // 间隔模式下预定的下一次触发时间
+  QDateTime m_armedMoment;     // 固定时刻模式下已预约的时刻
 };
 
 #endif // REMINDER_ENGINE_HPP
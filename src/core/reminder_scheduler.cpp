@@ -0,0 +1,218 @@
+#include "reminder_scheduler.hpp"
+#include "clock.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include "settings_manager.hpp"
+#include "trace.hpp"
+#include <algorithm>
+
+namespace {
+// 与 ReminderEngine 相同的最长休眠，系统休眠或改时钟后也能及时纠正
+const qint64 kMaxWaitSecs = 3600;
+const int kMinutesPerDay = 24 * 60;
+
+int minuteOf(const QTime &time) { return time.hour() * 60 + time.minute(); }
+
+qint64 roundUpToMinute(qint64 secs) { return (secs + 59) / 60 * 60; }
+} // namespace
+
+ReminderScheduler::Config::Config()
+    : fixedMode(false), intervalMinutes(45), dndEnabled(false),
+      dndStart(23, 0), dndEnd(8, 0), paused(false), style(0),
+      drinkAmount(250) {}
+
+ReminderScheduler::Config
+ReminderScheduler::Config::fromSettings(const SettingsManager &settings) {
+  Config config;
+  config.fixedMode =
+      settings.reminderMode() == SettingsManager::FixedMomentMode;
+  config.intervalMinutes = settings.reminderInterval();
+  config.moments = settings.fixedMoments();
+  config.dndEnabled = settings.isDNDEnabled();
+  config.dndStart = settings.dndStart();
+  config.dndEnd = settings.dndEnd();
+  config.paused = settings.isPaused();
+  config.style = settings.reminderStyle();
+  config.drinkAmount = settings.drinkAmount();
+  return config;
+}
+
+ReminderScheduler::ReminderScheduler(QObject *parent)
+    : QObject(parent), m_wakeups(0) {
+  m_timer = new ClockTimer(this);
+  m_timer->setSingleShot(true);
+  // 到期时刻已对齐到整分钟，允许系统合并唤醒
+  m_timer->setTimerType(Qt::CoarseTimer);
+  connect(m_timer, &ClockTimer::timeout, this, &ReminderScheduler::onTimeout);
+}
+
+void ReminderScheduler::setUser(quint32 uid, const Config &config) {
+  quint32 slot;
+  auto it = m_slotOf.constFind(uid);
+  if (it != m_slotOf.constEnd()) {
+    slot = it.value();
+  } else if (!m_freeSlots.isEmpty()) {
+    slot = m_freeSlots.takeLast();
+    m_slotOf.insert(uid, slot);
+  } else {
+    slot = m_schedules.size();
+    m_schedules.append(Schedule());
+    m_slotOf.insert(uid, slot);
+  }
+
+  Schedule &schedule = m_schedules[slot];
+  schedule.uid = uid;
+  schedule.intervalMinutes =
+      static_cast<quint16>(qBound(1, config.intervalMinutes, kMinutesPerDay));
+  schedule.dndStart = minuteOf(config.dndStart);
+  schedule.dndEnd = minuteOf(config.dndEnd);
+  schedule.drinkAmount = static_cast<quint16>(qBound(0, config.drinkAmount,
+                                                     65535));
+  schedule.style = static_cast<quint8>(config.style);
+  schedule.flags = (config.fixedMode ? FixedMode : 0) |
+                   (config.dndEnabled ? DndEnabled : 0) |
+                   (config.paused ? Paused : 0);
+
+  QVector<quint16> moments;
+  for (const QTime &moment : config.moments)
+    moments.append(minuteOf(moment));
+  std::sort(moments.begin(), moments.end());
+  moments.erase(std::unique(moments.begin(), moments.end()), moments.end());
+  schedule.momentCount =
+      static_cast<quint8>(qMin(moments.size(), int(kMaxMoments)));
+  std::copy(moments.constBegin(), moments.constBegin() + schedule.momentCount,
+            schedule.moments);
+
+  reschedule(slot, Clock::instance()->currentSecs());
+  arm();
+}
+
+void ReminderScheduler::removeUser(quint32 uid) {
+  auto it = m_slotOf.find(uid);
+  if (it == m_slotOf.end())
+    return;
+  Schedule &schedule = m_schedules[it.value()];
+  ++schedule.generation;
+  schedule.due = 0;
+  m_freeSlots.append(it.value());
+  m_slotOf.erase(it);
+  arm();
+}
+
+qint64 ReminderScheduler::nextWakeup() const {
+  return m_heap.empty() ? -1 : m_heap.top().due;
+}
+
+bool ReminderScheduler::inDnd(const Schedule &schedule,
+                              int minuteOfDay) const {
+  if (!(schedule.flags & DndEnabled))
+    return false;
+  // 结束的那一分钟整体算作免打扰，宁可晚一分钟提醒
+  if (schedule.dndStart <= schedule.dndEnd)
+    return minuteOfDay >= schedule.dndStart && minuteOfDay <= schedule.dndEnd;
+  return minuteOfDay >= schedule.dndStart || minuteOfDay <= schedule.dndEnd;
+}
+
+qint64 ReminderScheduler::nextDue(const Schedule &schedule,
+                                  qint64 nowSecs) const {
+  if (schedule.flags & Paused)
+    return 0;
+
+  const QDateTime now = QDateTime::fromSecsSinceEpoch(nowSecs);
+  if (schedule.flags & FixedMode) {
+    // 今明两天中第一个晚于现在、且不在免打扰内的固定时刻
+    for (int day = 0; day < 2; ++day) {
+      const QDate date = now.date().addDays(day);
+      for (int i = 0; i < schedule.momentCount; ++i) {
+        const int minute = schedule.moments[i];
+        qint64 at =
+            QDateTime(date, QTime(minute / 60, minute % 60)).toSecsSinceEpoch();
+        if (at > nowSecs && !inDnd(schedule, minute))
+          return at;
+      }
+    }
+    return 0;
+  }
+
+  qint64 due = roundUpToMinute(nowSecs + schedule.intervalMinutes * 60);
+  QDateTime at = QDateTime::fromSecsSinceEpoch(due);
+  if (inDnd(schedule, minuteOf(at.time()))) {
+    // 免打扰期间不唤醒，直接排到结束后的下一分钟
+    QDateTime end(at.date(), QTime(schedule.dndEnd / 60, schedule.dndEnd % 60));
+    end = end.addSecs(60);
+    if (end <= at)
+      end = end.addDays(1);
+    due = end.toSecsSinceEpoch();
+  }
+  return due;
+}
+
+void ReminderScheduler::reschedule(quint32 slot, qint64 nowSecs) {
+  Schedule &schedule = m_schedules[slot];
+  ++schedule.generation;
+  schedule.due = nextDue(schedule, nowSecs);
+  if (schedule.due == 0)
+    return;
+  Entry entry = {schedule.due, slot, schedule.generation};
+  m_heap.push(entry);
+  Metrics::registry().remindersScheduled.inc();
+}
+
+bool ReminderScheduler::isLive(const Entry &entry) const {
+  return m_schedules[entry.slot].generation == entry.generation;
+}
+
+void ReminderScheduler::arm() {
+  // 丢掉堆顶已作废的条目，避免为已删除或已改期的用户空醒
+  while (!m_heap.empty() && !isLive(m_heap.top()))
+    m_heap.pop();
+
+  // 改期留下的旧条目太多时整体重建
+  if (m_heap.size() > static_cast<size_t>(2 * m_slotOf.size() + 64)) {
+    std::vector<Entry> live;
+    live.reserve(m_slotOf.size());
+    while (!m_heap.empty()) {
+      if (isLive(m_heap.top()))
+        live.push_back(m_heap.top());
+      m_heap.pop();
+    }
+    m_heap = std::priority_queue<Entry, std::vector<Entry>,
+                                 std::greater<Entry>>(std::greater<Entry>(),
+                                                      std::move(live));
+  }
+
+  if (m_heap.empty()) {
+    m_timer->stop();
+    return;
+  }
+  qint64 wait = m_heap.top().due - Clock::instance()->currentSecs();
+  m_timer->start(static_cast<int>(qBound<qint64>(0, wait, kMaxWaitSecs)) *
+                 1000);
+}
+
+void ReminderScheduler::onTimeout() {
+  OASIS_TRACE_SCOPE("ReminderScheduler::onTimeout");
+  ++m_wakeups;
+  const Clock *clock = Clock::instance();
+  const qint64 now = clock->currentSecs();
+  Metrics::Registry &metrics = Metrics::registry();
+
+  // 同一分钟到期的所有用户在这一次唤醒中处理
+  while (!m_heap.empty() && m_heap.top().due <= now) {
+    Entry entry = m_heap.top();
+    m_heap.pop();
+    if (!isLive(entry))
+      continue;
+    const Schedule &schedule = m_schedules[entry.slot];
+    metrics.schedulingDrift.observe(
+        (clock->currentMSecs() - entry.due * 1000) / 1000.0);
+    metrics.remindersFired.inc();
+    emit reminderDue(schedule.uid, schedule.style, schedule.drinkAmount);
+    // 槽函数里可能删除或更新了该用户
+    if (isLive(entry))
+      reschedule(entry.slot, now);
+  }
+  qCDebug(lcReminder) << "scheduler wakeup, users" << m_slotOf.size()
+                      << "pending" << m_heap.size();
+  arm();
+}
@@ -0,0 +1,100 @@
+#ifndef REMINDER_SCHEDULER_HPP
+#define REMINDER_SCHEDULER_HPP
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTime>
+#include <QVector>
+#include <functional>
+#include <queue>
+#include <vector>
+
+class ClockTimer;
+class SettingsManager;
+
+// 多用户提醒调度 (守护进程模式)：所有用户的下一次提醒放在同一个最小堆里，
+// 只用一个定时器等待堆顶。到期时刻向上取整到整分钟，同一分钟到期的用户
+// 在一次唤醒中处理完，所以唤醒次数几乎不随用户数增长 (每天至多 1440 次)。
+// 每个用户只保留一个定长的 Schedule，暂停的用户不进堆。免打扰的处理与
+// ReminderEngine 不同：落在时段内的间隔提醒不跳过，而是推迟到时段结束后
+// 的下一分钟；固定时刻落在时段内的才跳过。
+class ReminderScheduler : public QObject {
+  Q_OBJECT
+public:
+  static const int kMaxMoments = 12;
+
+  struct Config {
+    Config();
+    static Config fromSettings(const SettingsManager &settings);
+
+    bool fixedMode;
+    int intervalMinutes;
+    QList<QTime> moments;
+    bool dndEnabled;
+    QTime dndStart;
+    QTime dndEnd;
+    bool paused;
+    int style;
+    int drinkAmount;
+  };
+
+  explicit ReminderScheduler(QObject *parent = nullptr);
+
+  // 新增或更新用户；间隔模式从现在重新计时
+  void setUser(quint32 uid, const Config &config);
+  void removeUser(quint32 uid);
+  bool hasUser(quint32 uid) const { return m_slotOf.contains(uid); }
+  int userCount() const { return m_slotOf.size(); }
+
+  quint64 wakeups() const { return m_wakeups; }
+  // 下一次唤醒的 Unix 秒，没有待发提醒时为 -1
+  qint64 nextWakeup() const;
+  static int scheduleBytes() { return sizeof(Schedule); }
+
+signals:
+  void reminderDue(quint32 uid, int style, int drinkAmount);
+
+private slots:
+  void onTimeout();
+
+private:
+  enum Flag : quint8 { FixedMode = 1, DndEnabled = 2, Paused = 4 };
+
+  struct Schedule {
+    quint32 uid;
+    quint32 generation; // 每次改期递增，堆中旧条目随之作废
+    qint64 due;         // Unix 秒，0 表示未排期
+    quint16 intervalMinutes;
+    quint16 dndStart; // 距零点的分钟
+    quint16 dndEnd;
+    quint16 drinkAmount;
+    quint8 style;
+    quint8 flags;
+    quint8 momentCount;
+    quint8 reserved;
+    quint16 moments[kMaxMoments]; // 距零点的分钟，升序
+  };
+
+  struct Entry {
+    qint64 due;
+    quint32 slot;
+    quint32 generation;
+    bool operator>(const Entry &other) const { return due > other.due; }
+  };
+
+  bool inDnd(const Schedule &schedule, int minuteOfDay) const;
+  qint64 nextDue(const Schedule &schedule, qint64 nowSecs) const;
+  void reschedule(quint32 slot, qint64 nowSecs);
+  bool isLive(const Entry &entry) const;
+  void arm();
+
+  QVector<Schedule> m_schedules; // 按槽位存放，槽位可复用
+  QVector<quint32> m_freeSlots;
+  QHash<quint32, quint32> m_slotOf; // uid -> 槽位
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> m_heap;
+  ClockTimer *m_timer;
+  quint64 m_wakeups;
+};
+
+#endif // REMINDER_SCHEDULER_HPP
@@ -1,14 +1,20 @@
 #include "settings_manager.hpp"
+#include "logging.hpp"
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
 #include <QStandardPaths>
 #include <QTextStream>
-#include <QDebug>
+#include <QUuid>
 
 SettingsManager::SettingsManager(QObject *parent)
     : QObject(parent), m_settings("Agil", "Oasis") {
-  qDebug() << "Settings loaded from:" << m_settings.fileName();
+  qCDebug(lcSettings) << "Settings loaded from:" << m_settings.fileName();
+}
+
+SettingsManager::SettingsManager(const QString &fileName, QObject *parent)
+    : QObject(parent), m_settings(fileName, QSettings::IniFormat) {
+  qCDebug(lcSettings) << "Settings loaded from:" << m_settings.fileName();
 }
 
 void SettingsManager::setReminderMode(ReminderMode mode) {
@@ -138,16 +144,18 @@ void SettingsManager::setAutoStart(bool enable) {
       out << "Categories=Utility;\n";
       out << "X-GNOME-Autostart-enabled=true\n";
       file.close();
-      qDebug() << "Autostart enabled: created" << desktopFilePath;
+      qCDebug(lcSettings) << "Autostart enabled: created" << desktopFilePath;
     } else {
-      qWarning() << "Failed to create autostart file:" << desktopFilePath;
+      qCWarning(lcSettings) << "Failed to create autostart file:"
+                            << desktopFilePath;
     }
   } else {
     if (QFile::exists(desktopFilePath)) {
       if (QFile::remove(desktopFilePath)) {
-        qDebug() << "Autostart disabled: removed" << desktopFilePath;
+        qCDebug(lcSettings) << "Autostart disabled: removed" << desktopFilePath;
       } else {
-        qWarning() << "Failed to remove autostart file:" << desktopFilePath;
+        qCWarning(lcSettings) << "Failed to remove autostart file:"
+                              << desktopFilePath;
       }
     }
   }
@@ -156,3 +164,61 @@ void SettingsManager::setAutoStart(bool enable) {
 bool SettingsManager::autoStart() const {
   return m_settings.value("auto_start", false).toBool();
 }
+
+QString SettingsManager::popupBackend() const {
+  return m_settings.value("popup_backend", "widget").toString();
+}
+
+QString SettingsManager::historyBackend() const {
+  return m_settings.value("history_backend", "text").toString();
+}
+
+int SettingsManager::historyCacheBudgetKb() const {
+  return qMax(16, m_settings.value("history_cache_kb", 512).toInt());
+}
+
+void SettingsManager::setMetricsEnabled(bool enabled) {
+  m_settings.setValue("metrics_enabled", enabled);
+}
+
+bool SettingsManager::metricsEnabled() const {
+  return m_settings.value("metrics_enabled", false).toBool();
+}
+
+int SettingsManager::metricsPort() const {
+  return m_settings.value("metrics_port", 9464).toInt();
+}
+
+QString SettingsManager::metricsSocketPath() const {
+  return m_settings.value("metrics_socket").toString();
+}
+
+bool SettingsManager::objectCensusEnabled() const {
+  return m_settings.value("object_census", false).toBool();
+}
+
+bool SettingsManager::weeklyReportPopup() const {
+  return m_settings.value("weekly_report_popup", true).toBool();
+}
+
+QDate SettingsManager::lastWeeklyReport() const {
+  return QDate::fromString(m_settings.value("weekly_report_last").toString(),
+                           Qt::ISODate);
+}
+
+void SettingsManager::setLastWeeklyReport(const QDate &weekStart) {
+  m_settings.setValue("weekly_report_last", weekStart.toString(Qt::ISODate));
+}
+
+QString SettingsManager::syncDir() const {
+  return m_settings.value("sync_dir").toString();
+}
+
+QByteArray SettingsManager::deviceId() {
+  QByteArray id = m_settings.value("device_id").toString().toLatin1();
+  if (id.isEmpty()) {
+    id = QUuid::createUuid().toRfc4122().toHex();
+    m_settings.setValue("device_id", QString::fromLatin1(id));
+  }
+  return id;
+}
@@ -1,6 +1,7 @@
 #ifndef SETTINGS_MANAGER_HPP
 #define SETTINGS_MANAGER_HPP
 
+#include <QDate>
 #include <QList>
 #include <QObject>
 #include <QSettings>
@@ -18,6 +19,8 @@ public:
   };
 
   explicit SettingsManager(QObject *parent = nullptr);
+  // 直接读写指定的配置文件 (INI 格式)，守护进程用它读取各用户的设置
+  explicit SettingsManager(const QString &fileName, QObject *parent = nullptr);
 
   void setReminderMode(ReminderMode mode);
   ReminderMode reminderMode() const;
@@ -49,6 +52,33 @@ public:
   void setAutoStart(bool enable);
   bool autoStart() const;
 
+  // 提醒送达方式："widget" (默认)、更轻量的 "raster" 或桌面通知 "dbus"
+  QString popupBackend() const;
+
+  // 饮水历史存储后端："text" (默认，按日文本日志) 或 "sqlite"
+  QString historyBackend() const;
+  // 历史明细块缓存的内存预算 (KB)
+  int historyCacheBudgetKb() const;
+
+  // 本地指标端点，默认关闭；设置了 socket 路径时优先使用 Unix 域套接字
+  void setMetricsEnabled(bool enabled);
+  bool metricsEnabled() const;
+  int metricsPort() const;
+  QString metricsSocketPath() const;
+
+  // 诊断模式：统计存活 QObject，每天把对象数与内存占用写入日志，默认关闭
+  bool objectCensusEnabled() const;
+
+  // 周报：每周开始时生成上周的报告 (保存到 reports/)，默认同时弹出展示
+  bool weeklyReportPopup() const;
+  QDate lastWeeklyReport() const; // 最近一次自动生成周报的那一周 (周一)
+  void setLastWeeklyReport(const QDate &weekStart);
+
+  // 多设备同步的共享目录，为空表示不同步
+  QString syncDir() const;
+  // 本机的设备 ID，首次调用时生成并保存
+  QByteArray deviceId();
+
 private:
   QSettings m_settings;
 };
@@ -0,0 +1,238 @@
+#include "simulation.hpp"
+#include "clock.hpp"
+#include "metrics.hpp"
+#include "plant_system.hpp"
+#include "reminder_engine.hpp"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <algorithm>
+
+namespace {
+
+// 固定的起点 (周一零点)，同一场景每次结果相同
+const QDate kStartDay(2025, 1, 6);
+const qint64 kWiltingSecs = 24 * 3600;
+
+// 独立于 ReminderEngine 的免打扰判断，用来核对引擎的行为
+bool inDnd(const Simulation::Scenario &scenario, const QTime &time) {
+  if (scenario.dndStart <= scenario.dndEnd)
+    return time >= scenario.dndStart && time <= scenario.dndEnd;
+  return time >= scenario.dndStart || time <= scenario.dndEnd;
+}
+
+bool isSkippedDay(const Simulation::Scenario &scenario, int dayIndex) {
+  return scenario.skipEvery > 0 && (dayIndex + 1) % scenario.skipEvery == 0;
+}
+
+// 按场景推算预定的提醒时刻
+QList<QDateTime> expectedReminders(const Simulation::Scenario &scenario,
+                                   const QDateTime &start,
+                                   const QDateTime &end) {
+  QList<QDateTime> reminders;
+  if (scenario.fixedMoments.isEmpty()) {
+    const qint64 step = scenario.intervalMinutes * 60000LL;
+    for (qint64 at = start.toMSecsSinceEpoch() + step;
+         at <= end.toMSecsSinceEpoch(); at += step)
+      reminders.append(QDateTime::fromMSecsSinceEpoch(at));
+    return reminders;
+  }
+  for (int d = 0; d <= scenario.days; ++d) {
+    for (const QTime &moment : scenario.fixedMoments) {
+      QDateTime at(kStartDay.addDays(d), QTime(moment.hour(), moment.minute()));
+      if (at >= start && at <= end)
+        reminders.append(at);
+    }
+  }
+  return reminders;
+}
+
+// 相邻两次饮水间隔达到枯萎阈值的次数 (含最后一次饮水到结束)
+int expectedWilting(const Simulation::Scenario &scenario,
+                    const QDateTime &end) {
+  int episodes = 0;
+  qint64 last = 0;
+  for (int d = 0; d < scenario.days; ++d) {
+    if (isSkippedDay(scenario, d))
+      continue;
+    for (const QPair<QTime, int> &drink : scenario.drinks) {
+      qint64 at =
+          QDateTime(kStartDay.addDays(d), drink.first).toSecsSinceEpoch();
+      if (last > 0 && at - last >= kWiltingSecs)
+        ++episodes;
+      last = at;
+    }
+  }
+  if (last > 0 && end.toSecsSinceEpoch() - last >= kWiltingSecs)
+    ++episodes;
+  return episodes;
+}
+
+} // namespace
+
+namespace Simulation {
+
+Scenario::Scenario()
+    : days(30), intervalMinutes(45), dndStart(23, 0), dndEnd(8, 0),
+      skipEvery(7) {
+  parseDrinkPattern("08:30=250,10:30=250,13:00=300,15:30=250,18:00=300,"
+                    "21:00=200",
+                    &drinks);
+}
+
+Report::Report()
+    : remindersFired(0), remindersSuppressed(0), expectedFired(0),
+      expectedSuppressed(0), drinks(0), wiltingEpisodes(0),
+      expectedWiltingEpisodes(0), rollovers(0), elapsedMs(0) {}
+
+bool parseDrinkPattern(const QString &text, QList<QPair<QTime, int> > *drinks) {
+  QList<QPair<QTime, int> > parsed;
+  for (const QString &item : text.split(',', QString::SkipEmptyParts)) {
+    QStringList parts = item.trimmed().split('=');
+    if (parts.size() != 2)
+      return false;
+    QTime time = QTime::fromString(parts[0], "HH:mm");
+    bool ok = false;
+    int ml = parts[1].toInt(&ok);
+    if (!time.isValid() || !ok || ml <= 0)
+      return false;
+    parsed.append(qMakePair(time, ml));
+  }
+  std::sort(parsed.begin(), parsed.end(),
+            [](const QPair<QTime, int> &a, const QPair<QTime, int> &b) {
+              return a.first < b.first;
+            });
+  *drinks = parsed;
+  return true;
+}
+
+Report run(const Scenario &scenario) {
+  Report report;
+  QElapsedTimer wallClock;
+  wallClock.start();
+
+  // 事件流、文本日志与旧版 QSettings 都重定向到临时目录。
+  // QSettings 的路径无法还原，因此一个进程只应模拟一次
+  QTemporaryDir sandbox;
+  if (!sandbox.isValid()) {
+    report.failures << "无法创建临时目录";
+    return report;
+  }
+  const QString previousDir = QDir::currentPath();
+  QDir::setCurrent(sandbox.path());
+  QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope,
+                     sandbox.path());
+  QSettings::setPath(QSettings::IniFormat, QSettings::UserScope,
+                     sandbox.path());
+
+  const QDateTime start(kStartDay, QTime(0, 0));
+  const QDateTime end(kStartDay.addDays(scenario.days), QTime(0, 0));
+  VirtualClock clock(start.toMSecsSinceEpoch());
+  Clock::setInstance(&clock);
+
+  Metrics::Registry &metrics = Metrics::registry();
+  const quint64 firedBefore = metrics.remindersFired.value();
+  const quint64 suppressedBefore = metrics.remindersSuppressed.value();
+
+  {
+    PlantSystem plant;
+    ReminderEngine engine;
+    engine.setDNDRange(scenario.dndStart, scenario.dndEnd);
+    engine.setDNDEnabled(true);
+    if (scenario.fixedMoments.isEmpty()) {
+      engine.setInterval(scenario.intervalMinutes);
+    } else {
+      engine.setMode(ReminderEngine::FixedMomentMode);
+      engine.setFixedMoments(scenario.fixedMoments);
+    }
+
+    QObject::connect(&engine, &ReminderEngine::reminderTriggered, [&]() {
+      QDateTime now = clock.now();
+      if (inDnd(scenario, now.time()))
+        report.failures << QString("免打扰时段内弹出了提醒: %1")
+                               .arg(now.toString(Qt::ISODate));
+    });
+
+    bool wilting = false;
+    QObject::connect(&plant, &PlantSystem::plantUpdated, [&]() {
+      bool nowWilting = plant.status() == PlantSystem::Wilting;
+      if (nowWilting && !wilting)
+        ++report.wiltingEpisodes;
+      wilting = nowWilting;
+    });
+
+    auto onRollover = [&](const QDate &day) {
+      ++report.rollovers;
+      QString date = day.toString(Qt::ISODate);
+      if (day != clock.today())
+        report.failures << QString("跨天日期错误: %1").arg(date);
+      if (plant.todayWaterIntake() != 0)
+        report.failures << QString("%1 跨天后今日饮水量未归零").arg(date);
+    };
+    QObject::connect(&plant, &PlantSystem::dayRolledOver, onRollover);
+
+    engine.start();
+
+    for (int d = 0; d < scenario.days; ++d) {
+      const QDate day = kStartDay.addDays(d);
+      int dayTotal = 0;
+      if (!isSkippedDay(scenario, d)) {
+        for (const QPair<QTime, int> &drink : scenario.drinks) {
+          clock.advanceTo(QDateTime(day, drink.first).toMSecsSinceEpoch());
+          plant.recordDrink(drink.second);
+          ++report.drinks;
+          dayTotal += drink.second;
+          if (plant.status() == PlantSystem::Wilting)
+            report.failures << QString("%1 %2 饮水后仍处于枯萎状态")
+                                   .arg(day.toString(Qt::ISODate))
+                                   .arg(drink.first.toString("HH:mm"));
+        }
+      }
+      clock.advanceTo(QDateTime(day, QTime(23, 59, 59)).toMSecsSinceEpoch());
+      if (plant.todayWaterIntake() != dayTotal)
+        report.failures << QString("%1 今日饮水量 %2 ml，应为 %3 ml")
+                               .arg(day.toString(Qt::ISODate))
+                               .arg(plant.todayWaterIntake())
+                               .arg(dayTotal);
+    }
+    clock.advanceTo(end.toMSecsSinceEpoch());
+    engine.stop();
+  }
+
+  Clock::setInstance(nullptr);
+  QDir::setCurrent(previousDir);
+
+  report.remindersFired = metrics.remindersFired.value() - firedBefore;
+  report.remindersSuppressed =
+      metrics.remindersSuppressed.value() - suppressedBefore;
+  for (const QDateTime &at : expectedReminders(scenario, start, end)) {
+    if (inDnd(scenario, at.time()))
+      ++report.expectedSuppressed;
+    else
+      ++report.expectedFired;
+  }
+  report.expectedWiltingEpisodes = expectedWilting(scenario, end);
+
+  if (report.remindersFired != report.expectedFired)
+    report.failures << QString("提醒次数 %1，应为 %2")
+                           .arg(report.remindersFired)
+                           .arg(report.expectedFired);
+  if (report.remindersSuppressed != report.expectedSuppressed)
+    report.failures << QString("免打扰跳过 %1 次，应为 %2 次")
+                           .arg(report.remindersSuppressed)
+                           .arg(report.expectedSuppressed);
+  if (report.wiltingEpisodes != report.expectedWiltingEpisodes)
+    report.failures << QString("枯萎 %1 次，应为 %2 次")
+                           .arg(report.wiltingEpisodes)
+                           .arg(report.expectedWiltingEpisodes);
+  if (report.rollovers != scenario.days)
+    report.failures << QString("跨天 %1 次，应为 %2 次")
+                           .arg(report.rollovers)
+                           .arg(scenario.days);
+
+  report.elapsedMs = wallClock.elapsed();
+  return report;
+}
+
+} // namespace Simulation
@@ -0,0 +1,50 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <QList>
+#include <QPair>
+#include <QStringList>
+#include <QTime>
+
+// 虚拟时间快进模拟：在 VirtualClock 上用真实的 ReminderEngine 与
+// PlantSystem 重放脚本化的饮水模式，几秒内跑完数月，并逐项核对
+// 提醒次数、免打扰、枯萎与跨天归零。数据写入临时目录，不触碰用户数据。
+namespace Simulation {
+
+struct Scenario {
+  Scenario();
+
+  int days;
+  int intervalMinutes;         // 间隔模式的提醒间隔
+  QList<QTime> fixedMoments;   // 非空时改用固定时刻模式
+  QTime dndStart;
+  QTime dndEnd;
+  QList<QPair<QTime, int> > drinks; // 每天的饮水脚本 (时刻, 毫升)
+  int skipEvery;               // 每隔几天整天不喝水 (0 表示不跳过)
+};
+
+struct Report {
+  Report();
+
+  qint64 remindersFired;
+  qint64 remindersSuppressed;
+  qint64 expectedFired;
+  qint64 expectedSuppressed;
+  int drinks;
+  int wiltingEpisodes;
+  int expectedWiltingEpisodes;
+  int rollovers;
+  qint64 elapsedMs; // 实际耗时
+  QStringList failures;
+
+  bool ok() const { return failures.isEmpty(); }
+};
+
+// 解析 "08:30=250,10:30=300" 形式的饮水脚本，格式错误返回 false
+bool parseDrinkPattern(const QString &text, QList<QPair<QTime, int> > *drinks);
+
+Report run(const Scenario &scenario);
+
+} // namespace Simulation
+
+#endif // SIMULATION_HPP
@@ -0,0 +1,195 @@
+#include "sqlite_history_store.hpp"
+#include "day_log.hpp"
+#include "logging.hpp"
+#include <QAtomicInt>
+#include <QDir>
+#include <QFile>
+#include <QSqlError>
+#include <QVariant>
+
+namespace {
+QAtomicInt s_connectionCounter;
+} // namespace
+
+SqliteHistoryStore::SqliteHistoryStore(const QString &dir, OpenMode mode)
+    : m_dir(dir),
+      m_connectionName(QString("oasis-history-%1")
+                           .arg(s_connectionCounter.fetchAndAddRelaxed(1))),
+      m_open(false) {
+  const QString path = databasePath(dir);
+  const bool existed = QFile::exists(path);
+  if (mode == ReadOnly && !existed)
+    return;
+  if (mode == ReadWrite)
+    QDir().mkpath(dir);
+
+  m_db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+  m_db.setDatabaseName(path);
+  // 写连接持锁时读方等待而不是立即报 SQLITE_BUSY
+  QString options = "QSQLITE_BUSY_TIMEOUT=5000";
+  if (mode == ReadOnly)
+    options += ";QSQLITE_OPEN_READONLY";
+  m_db.setConnectOptions(options);
+  if (!m_db.open()) {
+    qCWarning(lcHistory) << "无法打开历史数据库:" << path
+                         << m_db.lastError().text();
+    return;
+  }
+
+  if (mode == ReadWrite) {
+    // WAL：读者读取快照，不阻塞写者；NORMAL 在 WAL 下仍保证崩溃一致
+    if (!exec("PRAGMA journal_mode=WAL") || !exec("PRAGMA synchronous=NORMAL") ||
+        !createSchema())
+      return;
+    m_insert = QSqlQuery(m_db);
+    m_insert.prepare("INSERT INTO drinks (ts, day, ml, day_total, growth, "
+                     "status) VALUES (?, ?, ?, ?, ?, ?)");
+  }
+
+  m_selectDays = QSqlQuery(m_db);
+  m_selectDays.setForwardOnly(true);
+  m_selectDays.prepare("SELECT DISTINCT day FROM drinks ORDER BY day");
+  m_selectDay = QSqlQuery(m_db);
+  m_selectDay.setForwardOnly(true);
+  m_selectDay.prepare("SELECT ts, ml FROM drinks WHERE day = ? ORDER BY ts");
+  m_selectRange = QSqlQuery(m_db);
+  m_selectRange.setForwardOnly(true);
+  m_selectRange.prepare(
+      "SELECT ts, ml FROM drinks WHERE ts >= ? AND ts < ? ORDER BY ts");
+  m_open = true;
+
+  if (mode == ReadWrite && !existed)
+    importTextLogs();
+}
+
+SqliteHistoryStore::~SqliteHistoryStore() {
+  // 语句必须先于连接释放，之后才能移除连接
+  m_insert = QSqlQuery();
+  m_selectDays = QSqlQuery();
+  m_selectDay = QSqlQuery();
+  m_selectRange = QSqlQuery();
+  if (m_db.isValid()) {
+    m_db.close();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
+  }
+}
+
+QString SqliteHistoryStore::databasePath(const QString &dir) {
+  return QDir(dir).filePath("history.db");
+}
+
+bool SqliteHistoryStore::exec(const QString &sql) {
+  QSqlQuery query(m_db);
+  if (!query.exec(sql)) {
+    qCWarning(lcHistory) << "SQL 执行失败:" << sql << query.lastError().text();
+    return false;
+  }
+  return true;
+}
+
+bool SqliteHistoryStore::createSchema() {
+  // day 为本地日期的儒略日，按日查询与分组都走索引
+  return exec("CREATE TABLE IF NOT EXISTS drinks ("
+              "id INTEGER PRIMARY KEY, ts INTEGER NOT NULL, "
+              "day INTEGER NOT NULL, ml INTEGER NOT NULL, "
+              "day_total INTEGER, growth INTEGER, status TEXT)") &&
+         exec("CREATE INDEX IF NOT EXISTS drinks_ts ON drinks (ts)") &&
+         exec("CREATE INDEX IF NOT EXISTS drinks_day ON drinks (day, ts)") &&
+         exec(QString("PRAGMA user_version=%1").arg(kSchemaVersion));
+}
+
+bool SqliteHistoryStore::importTextLogs() {
+  // 今日总量、成长值、状态一并迁移，文本里为 "-" 的仍记为未知
+  QVector<DrinkEntry> entries;
+  for (const QDate &day : DayLog::availableDays(m_dir)) {
+    DayLog::readEntries(
+        day, [&](const DrinkEntry &entry) { entries.append(entry); }, m_dir);
+  }
+  if (entries.isEmpty())
+    return true;
+  qCDebug(lcHistory) << "导入文本日志到 SQLite:" << entries.size() << "条记录";
+  return appendBatch(entries);
+}
+
+bool SqliteHistoryStore::insert(const DrinkEntry &entry) {
+  m_insert.bindValue(0, entry.timestamp.toSecsSinceEpoch());
+  m_insert.bindValue(1, entry.timestamp.date().toJulianDay());
+  m_insert.bindValue(2, entry.ml);
+  // 未知的状态存为 NULL
+  m_insert.bindValue(3, entry.dayTotal >= 0 ? QVariant(entry.dayTotal)
+                                            : QVariant(QVariant::Int));
+  m_insert.bindValue(4, entry.growth >= 0 ? QVariant(entry.growth)
+                                          : QVariant(QVariant::Int));
+  m_insert.bindValue(5, entry.status.isEmpty() ? QVariant(QVariant::String)
+                                               : QVariant(entry.status));
+  if (!m_insert.exec()) {
+    qCWarning(lcHistory) << "写入饮水记录失败:" << m_insert.lastError().text();
+    return false;
+  }
+  return true;
+}
+
+bool SqliteHistoryStore::append(const DrinkEntry &entry) {
+  return m_open && insert(entry);
+}
+
+bool SqliteHistoryStore::appendBatch(const QVector<DrinkEntry> &entries) {
+  if (!m_open || !m_db.transaction())
+    return false;
+  for (const DrinkEntry &entry : entries) {
+    if (!insert(entry)) {
+      m_db.rollback();
+      return false;
+    }
+  }
+  return m_db.commit();
+}
+
+QList<QDate> SqliteHistoryStore::availableDays() const {
+  QList<QDate> days;
+  if (!m_open || !m_selectDays.exec())
+    return days;
+  while (m_selectDays.next())
+    days << QDate::fromJulianDay(m_selectDays.value(0).toLongLong());
+  m_selectDays.finish();
+  return days;
+}
+
+int SqliteHistoryStore::readDay(
+    const QDate &day,
+    const std::function<void(const QTime &, int)> &onRecord) const {
+  if (!m_open)
+    return 0;
+  m_selectDay.bindValue(0, day.toJulianDay());
+  if (!m_selectDay.exec())
+    return 0;
+  int count = 0;
+  while (m_selectDay.next()) {
+    QDateTime when =
+        QDateTime::fromSecsSinceEpoch(m_selectDay.value(0).toLongLong());
+    onRecord(when.time(), m_selectDay.value(1).toInt());
+    ++count;
+  }
+  m_selectDay.finish(); // 及时结束读事务，避免 WAL 无法回卷
+  return count;
+}
+
+int SqliteHistoryStore::readRange(
+    qint64 fromEpoch, qint64 toEpoch,
+    const std::function<void(qint64, int)> &onRecord) const {
+  if (!m_open)
+    return 0;
+  m_selectRange.bindValue(0, fromEpoch);
+  m_selectRange.bindValue(1, toEpoch);
+  if (!m_selectRange.exec())
+    return 0;
+  int count = 0;
+  while (m_selectRange.next()) {
+    onRecord(m_selectRange.value(0).toLongLong(),
+             m_selectRange.value(1).toInt());
+    ++count;
+  }
+  m_selectRange.finish();
+  return count;
+}
@@ -0,0 +1,51 @@
+#ifndef SQLITE_HISTORY_STORE_HPP
+#define SQLITE_HISTORY_STORE_HPP
+
+#include "history_store.hpp"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+// logs/history.db。WAL 模式下读连接与写连接互不阻塞；语句只预编译一次，
+// 批量写入合并为单个事务。每个实例持有一个独立的连接。
+class SqliteHistoryStore : public HistoryStore {
+public:
+  static const int kSchemaVersion = 1;
+
+  SqliteHistoryStore(const QString &dir = "logs", OpenMode mode = ReadWrite);
+  ~SqliteHistoryStore() override;
+
+  static QString databasePath(const QString &dir = "logs");
+
+  bool isOpen() const override { return m_open; }
+  QString backendName() const override { return "sqlite"; }
+
+  bool append(const DrinkEntry &entry) override;
+  bool appendBatch(const QVector<DrinkEntry> &entries) override;
+
+  QList<QDate> availableDays() const override;
+  int readDay(const QDate &day,
+              const std::function<void(const QTime &, int)> &onRecord)
+      const override;
+  int readRange(qint64 fromEpoch, qint64 toEpoch,
+                const std::function<void(qint64, int)> &onRecord)
+      const override;
+
+private:
+  bool exec(const QString &sql);
+  bool createSchema();
+  bool importTextLogs(); // 首次创建数据库时导入已有的按日文本日志
+  bool insert(const DrinkEntry &entry);
+
+  QString m_dir;
+  QString m_connectionName;
+  QSqlDatabase m_db;
+  bool m_open;
+
+  // 预编译语句 (读语句在 const 查询中复用)
+  QSqlQuery m_insert;
+  mutable QSqlQuery m_selectDays;
+  mutable QSqlQuery m_selectDay;
+  mutable QSqlQuery m_selectRange;
+};
+
+#endif // SQLITE_HISTORY_STORE_HPP
@@ -0,0 +1,126 @@
+#ifndef STATUS_PAGE_HPP
+#define STATUS_PAGE_HPP
+
+// 共享内存状态页：Oasis 把今日进度、植物状态与下一次提醒时间写入
+// $XDG_RUNTIME_DIR/oasis-status (或 /dev/shm/oasis-status-<uid>)。
+// 页面由 seqlock 保护，读者 mmap 一次后即可无锁、无系统调用地读取一致快照。
+//
+// 本头文件只依赖 C++11 标准库与 POSIX，状态栏脚本或其他程序可直接包含。
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace OasisStatus {
+
+const uint32_t kMagic = 0x5453414F; // "OAST"
+const uint32_t kVersion = 1;
+
+// 布局只允许在末尾追加字段；不兼容的改动需提升 kVersion
+struct Page {
+  uint32_t magic;
+  uint32_t version;
+  std::atomic<uint32_t> sequence; // 奇数表示写入中
+  uint32_t pageSize;              // sizeof(Page)，便于读者检查
+  int64_t updatedAt;              // Unix 秒
+  int32_t intakeMl;
+  int32_t goalMl;
+  int32_t status;                 // PlantSystem::PlantStatus
+  int32_t paused;
+  int64_t nextReminderAt;         // Unix 秒，0 表示没有预定的提醒
+  int32_t growth;
+  int32_t harvestCount;
+  char statusName[32];            // UTF-8，以 0 结尾
+};
+
+// 读者拿到的普通快照
+struct Snapshot {
+  int64_t updatedAt;
+  int32_t intakeMl;
+  int32_t goalMl;
+  int32_t status;
+  int32_t paused;
+  int64_t nextReminderAt;
+  int32_t growth;
+  int32_t harvestCount;
+  char statusName[32];
+};
+
+inline std::string defaultPath() {
+  const char *runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+  if (runtimeDir && *runtimeDir)
+    return std::string(runtimeDir) + "/oasis-status";
+  return "/dev/shm/oasis-status-" + std::to_string(getuid());
+}
+
+// 写者在每次发布前后各递增一次序号
+inline void beginWrite(Page *page) {
+  uint32_t seq = page->sequence.load(std::memory_order_relaxed);
+  page->sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+inline void endWrite(Page *page) {
+  uint32_t seq = page->sequence.load(std::memory_order_relaxed);
+  page->sequence.store(seq + 1, std::memory_order_release);
+}
+
+// 读取一致快照；写者持续写入导致多次重试失败时返回 false
+inline bool read(const Page *page, Snapshot *out, int maxRetries = 1000) {
+  if (page->magic != kMagic || page->version != kVersion ||
+      page->pageSize < sizeof(Page))
+    return false;
+  for (int attempt = 0; attempt < maxRetries; ++attempt) {
+    uint32_t before = page->sequence.load(std::memory_order_acquire);
+    if (before & 1)
+      continue;
+    out->updatedAt = page->updatedAt;
+    out->intakeMl = page->intakeMl;
+    out->goalMl = page->goalMl;
+    out->status = page->status;
+    out->paused = page->paused;
+    out->nextReminderAt = page->nextReminderAt;
+    out->growth = page->growth;
+    out->harvestCount = page->harvestCount;
+    std::memcpy(out->statusName, page->statusName, sizeof(out->statusName));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (page->sequence.load(std::memory_order_relaxed) == before) {
+      out->statusName[sizeof(out->statusName) - 1] = '\0';
+      return true;
+    }
+  }
+  return false;
+}
+
+// 只读映射状态页；失败返回 nullptr。映射在进程生命周期内保持有效，
+// 之后每次 read 都不再进入内核。
+inline const Page *attach(const std::string &path = defaultPath()) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+  // 文件短于页面时访问映射会触发 SIGBUS
+  struct stat info;
+  if (::fstat(fd, &info) != 0 ||
+      info.st_size < static_cast<off_t>(sizeof(Page))) {
+    ::close(fd);
+    return nullptr;
+  }
+  void *addr = ::mmap(nullptr, sizeof(Page), PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  return addr == MAP_FAILED ? nullptr : static_cast<const Page *>(addr);
+}
+
+inline void detach(const Page *page) {
+  if (page)
+    ::munmap(const_cast<Page *>(page), sizeof(Page));
+}
+
+} // namespace OasisStatus
+
+#endif // STATUS_PAGE_HPP
@@ -0,0 +1,62 @@
+#include "status_publisher.hpp"
+#include "clock.hpp"
+#include "logging.hpp"
+#include "status_page.hpp"
+#include <new>
+
+StatusPublisher::StatusPublisher(const QString &path)
+    : m_file(path.isEmpty()
+                 ? QString::fromStdString(OasisStatus::defaultPath())
+                 : path),
+      m_page(nullptr) {
+  // 每次启动都重建页面，避免读者看到上次异常退出时写了一半的内容
+  QFile::remove(m_file.fileName());
+  if (!m_file.open(QIODevice::ReadWrite) ||
+      !m_file.resize(sizeof(OasisStatus::Page))) {
+    qCWarning(lcStatus) << "无法创建状态页:" << m_file.fileName()
+                        << m_file.errorString();
+    return;
+  }
+  m_file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+  uchar *memory = m_file.map(0, sizeof(OasisStatus::Page));
+  if (!memory) {
+    qCWarning(lcStatus) << "无法映射状态页:" << m_file.errorString();
+    return;
+  }
+  m_page = new (memory) OasisStatus::Page();
+  m_page->pageSize = sizeof(OasisStatus::Page);
+  m_page->version = OasisStatus::kVersion;
+  m_page->magic = OasisStatus::kMagic; // 最后写入，读者据此判断页面可用
+}
+
+StatusPublisher::~StatusPublisher() {
+  if (m_page) {
+    m_file.unmap(reinterpret_cast<uchar *>(m_page));
+    m_file.remove(); // 程序退出后状态栏显示为未运行
+  }
+}
+
+void StatusPublisher::publish(int intakeMl, int goalMl, int status,
+                              const QString &statusName, int growth,
+                              int harvestCount, bool paused,
+                              const QDateTime &nextReminder) {
+  if (!m_page)
+    return;
+
+  QByteArray name = statusName.toUtf8().left(sizeof(m_page->statusName) - 1);
+
+  OasisStatus::beginWrite(m_page);
+  m_page->updatedAt = Clock::instance()->currentSecs();
+  m_page->intakeMl = intakeMl;
+  m_page->goalMl = goalMl;
+  m_page->status = status;
+  m_page->paused = paused ? 1 : 0;
+  m_page->nextReminderAt =
+      nextReminder.isValid() ? nextReminder.toSecsSinceEpoch() : 0;
+  m_page->growth = growth;
+  m_page->harvestCount = harvestCount;
+  std::memset(m_page->statusName, 0, sizeof(m_page->statusName));
+  std::memcpy(m_page->statusName, name.constData(), name.size());
+  OasisStatus::endWrite(m_page);
+}
@@ -0,0 +1,31 @@
+#ifndef STATUS_PUBLISHER_HPP
+#define STATUS_PUBLISHER_HPP
+
+#include <QDateTime>
+#include <QFile>
+#include <QString>
+
+namespace OasisStatus {
+struct Page;
+}
+
+// 把托盘提示中的进度同步写入共享内存状态页 (布局见 status_page.hpp)
+class StatusPublisher {
+public:
+  explicit StatusPublisher(const QString &path = QString()); // 空为默认路径
+  ~StatusPublisher();
+
+  bool isOpen() const { return m_page != nullptr; }
+  QString path() const { return m_file.fileName(); }
+
+  void publish(int intakeMl, int goalMl, int status, const QString &statusName,
+               int growth, int harvestCount, bool paused,
+               const QDateTime &nextReminder);
+
+private:
+  Q_DISABLE_COPY(StatusPublisher)
+  QFile m_file;
+  OasisStatus::Page *m_page;
+};
+
+#endif // STATUS_PUBLISHER_HPP
@@ -0,0 +1,606 @@
+#include "team_aggregator.hpp"
+#include "clock.hpp"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QSaveFile>
+#include <QVector>
+#include <QtConcurrent>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace {
+
+const int kChunkSize = 16 * 1024;    // 每个日志每次读取的字节数
+const int kMaxLineBuffer = 256 * 1024; // 超长的坏行直接丢弃
+const int kNoDay = std::numeric_limits<int>::max();
+const int kDayBucketMl = 50;
+const int kDayBuckets = 121; // 0..6000ml，最后一格收纳更大的值
+const int kHourBucketMl = 25;
+const int kHourBuckets = 41; // 0..1000ml
+const quint32 kCheckpointMagic = 0x4F414747; // "OAGG"
+const quint32 kCheckpointVersion = 1;
+const char *const kDailyHeader =
+    "team,date,users,mean_ml,p10_ml,p50_ml,p90_ml,goal_hit_rate\n";
+
+struct Sample {
+  qint64 ts;
+  int value;
+  char type;
+};
+
+// 只取聚合需要的字段，不做内存分配: "<类型> <秒> <值> ..."
+bool parseSample(const char *p, const char *end, Sample *sample) {
+  if (end - p < 5 || p[1] != ' ' || (p[0] != 'D' && p[0] != 'G'))
+    return false;
+  sample->type = p[0];
+  p += 2;
+  qint64 ts = 0;
+  const char *digits = p;
+  while (p < end && *p >= '0' && *p <= '9')
+    ts = ts * 10 + (*p++ - '0');
+  if (p == digits || p >= end || *p != ' ')
+    return false;
+  ++p;
+  int value = 0;
+  digits = p;
+  while (p < end && *p >= '0' && *p <= '9' && value < 1000000)
+    value = value * 10 + (*p++ - '0');
+  if (p == digits || (p < end && *p != ' ' && *p != '\r'))
+    return false;
+  sample->ts = ts;
+  sample->value = value;
+  return true;
+}
+
+// 顺序读取一个设备日志，每次只缓存一小块，不长期占用文件句柄
+class JournalCursor {
+public:
+  QString path;
+  QString key;          // 检查点中的相对路径
+  qint64 resumeOffset;  // 第一条未封存事件的位置，-1 表示尚未遇到
+  bool hasHead;
+  Sample head;
+  qint64 headOffset;
+
+  void open(qint64 offset) {
+    m_base = offset;
+    m_buffer.clear();
+    m_pos = 0;
+    m_eof = false;
+    resumeOffset = -1;
+    advance();
+  }
+
+  void advance() {
+    hasHead = false;
+    for (;;) {
+      int newline = m_buffer.indexOf('\n', m_pos);
+      if (newline < 0) {
+        if (!refill())
+          return;
+        continue;
+      }
+      const char *data = m_buffer.constData();
+      qint64 lineOffset = m_base + m_pos;
+      bool ok = parseSample(data + m_pos, data + newline, &head);
+      m_pos = newline + 1;
+      if (ok) {
+        headOffset = lineOffset;
+        hasHead = true;
+        return;
+      }
+    }
+  }
+
+  // 已完整读过的位置；末尾不完整的行留到下次运行
+  qint64 consumed() const { return m_base + m_pos; }
+
+private:
+  bool refill() {
+    if (m_eof)
+      return false;
+    if (m_buffer.size() - m_pos > kMaxLineBuffer)
+      m_pos = m_buffer.size();
+    m_buffer.remove(0, m_pos);
+    m_base += m_pos;
+    m_pos = 0;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) ||
+        !file.seek(m_base + m_buffer.size())) {
+      m_eof = true;
+      return false;
+    }
+    QByteArray chunk = file.read(kChunkSize);
+    if (chunk.isEmpty()) {
+      m_eof = true;
+      return false;
+    }
+    m_buffer.append(chunk);
+    return true;
+  }
+
+  QByteArray m_buffer;
+  int m_pos;
+  qint64 m_base;
+  bool m_eof;
+};
+
+struct DaySummary {
+  int day; // 儒略日
+  int goal;
+  int total;
+  int hours[24];
+};
+
+struct Window {
+  int start;
+  int end;
+  int sealedBefore; // 上次运行已封存的日期之前
+  int watermark;    // 本次运行封存到这一天之前
+};
+
+struct UserState {
+  int team;
+  int goal;       // 当前生效的目标
+  int sealedGoal; // 封存边界处的目标，写入检查点
+  int nextDay;    // 下一条事件的日期
+  qint64 events;
+  qint64 late;
+  QVector<JournalCursor> journals;
+  QVector<DaySummary> days; // 当前窗口内有记录的日子，按日期排序
+
+  qint64 dayStart;
+  qint64 dayEnd;
+  int dayNumber;
+
+  // 本地日期；按距零点的秒数换算小时，夏令时切换当天会偏一小时
+  int dayOf(qint64 ts, int *hour) {
+    if (ts < dayStart || ts >= dayEnd) {
+      QDate date = QDateTime::fromSecsSinceEpoch(ts).date();
+      dayStart = QDateTime(date, QTime(0, 0)).toSecsSinceEpoch();
+      dayEnd = QDateTime(date.addDays(1), QTime(0, 0)).toSecsSinceEpoch();
+      dayNumber = static_cast<int>(date.toJulianDay());
+    }
+    *hour = qBound(0, static_cast<int>((ts - dayStart) / 3600), 23);
+    return dayNumber;
+  }
+
+  // 多台设备的日志按时间归并；设备数很少，线性选最早的即可
+  JournalCursor *earliest() {
+    JournalCursor *best = nullptr;
+    for (JournalCursor &cursor : journals) {
+      if (cursor.hasHead && (!best || cursor.head.ts < best->head.ts))
+        best = &cursor;
+    }
+    return best;
+  }
+
+  int headDay() {
+    JournalCursor *cursor = earliest();
+    int hour = 0;
+    return cursor ? dayOf(cursor->head.ts, &hour) : kNoDay;
+  }
+
+  DaySummary *summaryFor(int day) {
+    int i = days.size();
+    while (i > 0 && days[i - 1].day > day)
+      --i;
+    if (i > 0 && days[i - 1].day == day)
+      return &days[i - 1];
+    DaySummary summary;
+    summary.day = day;
+    summary.goal = goal;
+    summary.total = 0;
+    std::fill(summary.hours, summary.hours + 24, 0);
+    days.insert(i, summary);
+    return &days[i];
+  }
+
+  void fillWindow(const Window &window) {
+    days.clear();
+    for (;;) {
+      JournalCursor *cursor = earliest();
+      if (!cursor)
+        break;
+      const Sample sample = cursor->head;
+      int hour = 0;
+      int day = dayOf(sample.ts, &hour);
+      if (day >= window.end)
+        break; // 留给下一个窗口
+      if (day >= window.watermark && cursor->resumeOffset < 0)
+        cursor->resumeOffset = cursor->headOffset;
+      cursor->advance();
+
+      if (sample.type == 'G') {
+        goal = sample.value;
+        if (day < window.watermark)
+          sealedGoal = sample.value;
+        continue;
+      }
+      if (day < window.start || day < window.sealedBefore) {
+        ++late; // 所属日期已经输出，不再改动
+        continue;
+      }
+      DaySummary *summary = summaryFor(day);
+      summary->goal = goal;
+      summary->total += sample.value;
+      summary->hours[hour] += sample.value;
+      ++events;
+    }
+    nextDay = headDay();
+  }
+};
+
+// 团队当天的分布，逐日清零
+struct TeamDay {
+  int users;
+  int hits;
+  qint64 sum;
+  QVector<quint32> histogram;
+};
+
+// 团队分时分布：每个“用户日”在各小时的饮水量
+struct TeamHours {
+  quint32 userDays;
+  QVector<quint64> sums;
+  QVector<quint32> bins;
+
+  TeamHours()
+      : userDays(0), sums(24, 0), bins(24 * kHourBuckets, 0) {}
+
+  void add(const DaySummary &summary) {
+    ++userDays;
+    for (int h = 0; h < 24; ++h) {
+      sums[h] += summary.hours[h];
+      ++bins[h * kHourBuckets +
+             qMin(kHourBuckets - 1, summary.hours[h] / kHourBucketMl)];
+    }
+  }
+
+  void addAll(const TeamHours &other) {
+    userDays += other.userDays;
+    for (int i = 0; i < sums.size(); ++i)
+      sums[i] += other.sums[i];
+    for (int i = 0; i < bins.size(); ++i)
+      bins[i] += other.bins[i];
+  }
+};
+
+// 直方图上的分位数，桶内线性插值
+int percentile(const quint32 *bins, int count, quint64 total, int bucketMl,
+               double q) {
+  double rank = q * total;
+  quint64 seen = 0;
+  for (int i = 0; i < count; ++i) {
+    if (bins[i] && seen + bins[i] >= rank) {
+      double fraction = (rank - seen) / bins[i];
+      return qRound((i + fraction) * bucketMl);
+    }
+    seen += bins[i];
+  }
+  return count * bucketMl;
+}
+
+struct Checkpoint {
+  int watermark; // 儒略日，之前的日期已写入 daily.csv
+  qint64 dailySize;
+  qint64 lateEvents;
+  QMap<QString, qint64> offsets;
+  QMap<QString, qint32> goals;
+  QMap<QString, TeamHours> hours;
+
+  Checkpoint()
+      : watermark(std::numeric_limits<int>::min()), dailySize(-1),
+        lateEvents(0) {}
+};
+
+bool loadCheckpoint(const QString &path, Checkpoint *checkpoint) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+  QDataStream in(&file);
+  quint32 magic = 0, version = 0;
+  in >> magic >> version;
+  if (magic != kCheckpointMagic || version != kCheckpointVersion)
+    return false;
+  qint32 watermark = 0;
+  quint32 teams = 0;
+  in >> watermark >> checkpoint->dailySize >> checkpoint->lateEvents;
+  in >> checkpoint->offsets >> checkpoint->goals >> teams;
+  for (quint32 i = 0; i < teams && in.status() == QDataStream::Ok; ++i) {
+    QString team;
+    TeamHours hours;
+    in >> team >> hours.userDays >> hours.sums >> hours.bins;
+    if (hours.sums.size() != 24 || hours.bins.size() != 24 * kHourBuckets)
+      return false;
+    checkpoint->hours.insert(team, hours);
+  }
+  checkpoint->watermark = watermark;
+  return in.status() == QDataStream::Ok;
+}
+
+bool saveCheckpoint(const QString &path, const Checkpoint &checkpoint) {
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+  QDataStream out(&file);
+  out << kCheckpointMagic << kCheckpointVersion;
+  out << static_cast<qint32>(checkpoint.watermark) << checkpoint.dailySize
+      << checkpoint.lateEvents << checkpoint.offsets << checkpoint.goals
+      << static_cast<quint32>(checkpoint.hours.size());
+  for (auto it = checkpoint.hours.constBegin();
+       it != checkpoint.hours.constEnd(); ++it)
+    out << it.key() << it->userDays << it->sums << it->bins;
+  return out.status() == QDataStream::Ok && file.commit();
+}
+
+QByteArray dailyRow(const QString &team, int day, const TeamDay &stats) {
+  const quint32 *bins = stats.histogram.constData();
+  QByteArray row = team.toUtf8();
+  row.append(',').append(QDate::fromJulianDay(day).toString("yyyy-MM-dd"));
+  row.append(',').append(QByteArray::number(stats.users));
+  row.append(',').append(QByteArray::number(stats.sum / stats.users));
+  for (double q : {0.1, 0.5, 0.9})
+    row.append(',').append(QByteArray::number(
+        percentile(bins, kDayBuckets, stats.users, kDayBucketMl, q)));
+  row.append(',').append(
+      QByteArray::number(double(stats.hits) / stats.users, 'f', 3));
+  row.append('\n');
+  return row;
+}
+
+QByteArray hourlyRows(const QString &team, const TeamHours &hours) {
+  quint64 dayTotal = 0;
+  for (quint64 sum : hours.sums)
+    dayTotal += sum;
+  QByteArray rows;
+  for (int h = 0; h < 24; ++h) {
+    const quint32 *bins = hours.bins.constData() + h * kHourBuckets;
+    rows.append(team.toUtf8()).append(',').append(QByteArray::number(h));
+    rows.append(',').append(QByteArray::number(hours.userDays));
+    rows.append(',').append(
+        QByteArray::number(hours.sums[h] / hours.userDays));
+    for (double q : {0.5, 0.9})
+      rows.append(',').append(QByteArray::number(percentile(
+          bins, kHourBuckets, hours.userDays, kHourBucketMl, q)));
+    rows.append(',').append(QByteArray::number(
+        dayTotal ? double(hours.sums[h]) / dayTotal : 0.0, 'f', 3));
+    rows.append('\n');
+  }
+  return rows;
+}
+
+} // namespace
+
+TeamAggregator::TeamAggregator(const QString &root, const QString &outDir,
+                               QObject *parent)
+    : QObject(parent), m_root(root), m_outDir(outDir), m_defaultGoal(2000),
+      m_cancelled(0) {}
+
+void TeamAggregator::cancel() { m_cancelled.storeRelease(1); }
+
+void TeamAggregator::run() {
+  m_cancelled.storeRelease(0);
+
+  QDir out(m_outDir);
+  if (!out.mkpath(".")) {
+    emit finished(false, 0, 0, tr("无法创建输出目录 %1").arg(m_outDir));
+    return;
+  }
+  const QString checkpointPath = out.filePath("aggregate.checkpoint");
+  Checkpoint checkpoint;
+  bool resumed = loadCheckpoint(checkpointPath, &checkpoint);
+  if (!resumed)
+    checkpoint = Checkpoint();
+
+  // 扫描目录: <root>/<团队>/<用户>/oasis-<设备>.journal
+  QStringList teams;
+  QVector<UserState> users;
+  QDir rootDir(m_root);
+  const QDir::Filters subdirs = QDir::Dirs | QDir::NoDotAndDotDot;
+  for (const QString &team : rootDir.entryList(subdirs, QDir::Name)) {
+    QDir teamDir(rootDir.filePath(team));
+    for (const QString &user : teamDir.entryList(subdirs, QDir::Name)) {
+      QDir userDir(teamDir.filePath(user));
+      UserState state;
+      for (const QString &name :
+           userDir.entryList(QStringList() << "oasis-*.journal", QDir::Files,
+                             QDir::Name)) {
+        // 同步工具产生的冲突副本 (设备 ID 中带 '.') 不是本应用写的
+        if (name.mid(6, name.size() - 14).contains('.'))
+          continue;
+        JournalCursor cursor;
+        cursor.path = userDir.filePath(name);
+        cursor.key = team + '/' + user + '/' + name;
+        state.journals.append(cursor);
+      }
+      if (state.journals.isEmpty())
+        continue;
+      if (teams.isEmpty() || teams.last() != team)
+        teams << team;
+      const QString key = team + '/' + user;
+      state.team = teams.size() - 1;
+      state.goal = checkpoint.goals.value(key, m_defaultGoal);
+      state.sealedGoal = state.goal;
+      state.events = 0;
+      state.late = 0;
+      state.dayStart = 1;
+      state.dayEnd = 0;
+      state.dayNumber = 0;
+      users.append(state);
+    }
+  }
+
+  // daily.csv 只追加；上次运行在写检查点前中断时，截掉多写的行
+  QFile daily(out.filePath("daily.csv"));
+  if (!daily.open(QIODevice::ReadWrite) ||
+      !daily.resize(resumed ? qMin(daily.size(), checkpoint.dailySize) : 0) ||
+      !daily.seek(daily.size())) {
+    emit finished(false, 0, 0, daily.errorString());
+    return;
+  }
+  if (daily.size() == 0)
+    daily.write(kDailyHeader);
+
+  const int today = static_cast<int>(Clock::instance()->today().toJulianDay());
+  Window window;
+  window.sealedBefore = checkpoint.watermark;
+  window.watermark =
+      qMax(checkpoint.watermark, today + 1 - kAllowedLatenessDays);
+
+  const QMap<QString, qint64> offsets = checkpoint.offsets;
+  QtConcurrent::blockingMap(users, [&offsets](UserState &user) {
+    for (JournalCursor &cursor : user.journals) {
+      qint64 offset = offsets.value(cursor.key, 0);
+      if (QFileInfo(cursor.path).size() < offset)
+        offset = 0; // 日志被替换过，从头读，已封存的日期会被跳过
+      cursor.open(offset);
+    }
+    user.nextDay = user.headDay();
+  });
+
+  auto firstPending = [&users]() {
+    int day = kNoDay;
+    for (const UserState &user : users)
+      day = qMin(day, user.nextDay);
+    return day;
+  };
+
+  QVector<TeamDay> teamDays(teams.size());
+  for (TeamDay &stats : teamDays) {
+    stats.users = stats.hits = 0;
+    stats.sum = 0;
+    stats.histogram.fill(0, kDayBuckets);
+  }
+  QVector<TeamHours> sealedHours(teams.size());
+  QVector<TeamHours> openHours(teams.size());
+  for (int t = 0; t < teams.size(); ++t)
+    sealedHours[t] = checkpoint.hours.value(teams[t]);
+  QByteArray openRows;
+  bool writeOk = true;
+
+  auto finalizeDay = [&](int day) {
+    for (int t = 0; t < teamDays.size(); ++t) {
+      TeamDay &stats = teamDays[t];
+      if (stats.users == 0)
+        continue;
+      // 人数太少的团队日不输出，避免反推出个人
+      if (stats.users >= kMinTeamSize) {
+        QByteArray row = dailyRow(teams[t], day, stats);
+        if (day < window.watermark)
+          writeOk = writeOk && daily.write(row) == row.size();
+        else
+          openRows.append(row);
+      }
+      stats.users = stats.hits = 0;
+      stats.sum = 0;
+      stats.histogram.fill(0);
+    }
+  };
+
+  // 窗口内各用户的每日汇总已按日期排序，按日期做 k 路归并并逐日封存
+  typedef QPair<int, int> HeapItem; // (日期, 用户)
+  std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>>
+      heap;
+  QVector<int> positions(users.size());
+
+  const int firstDay = firstPending();
+  const int totalDays = firstDay == kNoDay ? 0 : qMax(0, today + 1 - firstDay);
+  window.start = firstDay;
+  while (window.start != kNoDay) {
+    if (m_cancelled.loadAcquire()) {
+      emit finished(false, 0, 0, tr("汇总已取消"));
+      return;
+    }
+    window.end = window.start + kWindowDays;
+    QtConcurrent::blockingMap(
+        users, [&window](UserState &user) { user.fillWindow(window); });
+
+    for (int u = 0; u < users.size(); ++u) {
+      positions[u] = 0;
+      if (!users[u].days.isEmpty())
+        heap.push(HeapItem(users[u].days.first().day, u));
+    }
+    int current = kNoDay;
+    while (!heap.empty()) {
+      const int day = heap.top().first;
+      const int u = heap.top().second;
+      heap.pop();
+      if (day != current) {
+        if (current != kNoDay)
+          finalizeDay(current);
+        current = day;
+      }
+      const UserState &user = users[u];
+      const DaySummary &summary = user.days[positions[u]];
+      TeamDay &stats = teamDays[user.team];
+      ++stats.users;
+      stats.sum += summary.total;
+      if (summary.total >= summary.goal)
+        ++stats.hits;
+      ++stats.histogram[qMin(kDayBuckets - 1, summary.total / kDayBucketMl)];
+      (day < window.watermark ? sealedHours : openHours)[user.team].add(
+          summary);
+      if (++positions[u] < user.days.size())
+        heap.push(HeapItem(user.days[positions[u]].day, u));
+    }
+    if (current != kNoDay)
+      finalizeDay(current);
+
+    emit progress(qMin(totalDays, window.end - firstDay), totalDays);
+    window.start = qMax(window.end, firstPending());
+  }
+
+  // 未封存的日期与分时分布每次整体重写
+  QSaveFile openDaily(out.filePath("daily_open.csv"));
+  if (openDaily.open(QIODevice::WriteOnly)) {
+    openDaily.write(kDailyHeader);
+    openDaily.write(openRows);
+  }
+  QSaveFile hourly(out.filePath("hourly.csv"));
+  if (hourly.open(QIODevice::WriteOnly)) {
+    hourly.write("team,hour,user_days,mean_ml,p50_ml,p90_ml,share\n");
+    for (int t = 0; t < teams.size(); ++t) {
+      TeamHours hours = sealedHours[t];
+      hours.addAll(openHours[t]);
+      if (hours.userDays >= static_cast<quint32>(kMinTeamSize))
+        hourly.write(hourlyRows(teams[t], hours));
+    }
+  }
+  daily.flush();
+  if (!writeOk || !openDaily.commit() || !hourly.commit()) {
+    emit finished(false, 0, 0, tr("写入汇总结果失败"));
+    return;
+  }
+
+  // 检查点最后提交：其中的 daily.csv 长度与各日志位置互相对应
+  Checkpoint next;
+  next.watermark = window.watermark;
+  next.dailySize = daily.size();
+  next.lateEvents = checkpoint.lateEvents;
+  qint64 events = 0;
+  for (const UserState &user : users) {
+    const JournalCursor &first = user.journals.first();
+    const QString key = first.key.left(first.key.lastIndexOf('/'));
+    next.goals.insert(key, user.sealedGoal);
+    next.lateEvents += user.late;
+    events += user.events;
+    for (const JournalCursor &cursor : user.journals)
+      next.offsets.insert(cursor.key, cursor.resumeOffset >= 0
+                                          ? cursor.resumeOffset
+                                          : cursor.consumed());
+  }
+  for (int t = 0; t < teams.size(); ++t)
+    next.hours.insert(teams[t], sealedHours[t]);
+  if (!saveCheckpoint(checkpointPath, next)) {
+    emit finished(false, events, next.lateEvents, tr("无法保存检查点"));
+    return;
+  }
+  emit finished(true, events, next.lateEvents, QString());
+}
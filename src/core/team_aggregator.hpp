@@ -0,0 +1,42 @@
+#ifndef TEAM_AGGREGATOR_HPP
+#define TEAM_AGGREGATOR_HPP
+
+#include <QAtomicInt>
+#include <QObject>
+
+// 团队饮水看板：汇总共享目录中大量用户的同步日志 (见 HistorySync)，
+// 输出按团队匿名的每日与分时分布。目录结构为
+//   <root>/<团队>/<用户>/oasis-<设备ID>.journal
+// 按日期窗口并行扫描各用户日志，用户内多台设备的日志按时间做 k 路归并，
+// 窗口内再按日期对所有用户做 k 路归并并逐日封存，内存占用只与用户数和
+// 窗口长度有关。检查点记录每个日志的读取位置，下次运行只读新增部分。
+class TeamAggregator : public QObject {
+  Q_OBJECT
+public:
+  static const int kWindowDays = 32;        // 每轮并行扫描的天数
+  static const int kMinTeamSize = 5;        // 人数更少的团队日不输出
+  static const int kAllowedLatenessDays = 2; // 更早的日期视为已封存
+
+  explicit TeamAggregator(const QString &root, const QString &outDir,
+                          QObject *parent = nullptr);
+
+  void setDefaultGoal(int ml) { m_defaultGoal = ml; } // 用户未设定目标时
+  void cancel(); // 线程安全
+
+public slots:
+  void run();
+
+signals:
+  void progress(int doneDays, int totalDays);
+  // lateEvents: 所属日期已封存、因而未计入的迟到事件数
+  void finished(bool ok, qint64 events, qint64 lateEvents,
+                const QString &error);
+
+private:
+  QString m_root;
+  QString m_outDir;
+  int m_defaultGoal;
+  QAtomicInt m_cancelled;
+};
+
+#endif // TEAM_AGGREGATOR_HPP
@@ -0,0 +1,79 @@
+#include "text_log_store.hpp"
+#include "day_log.hpp"
+#include "logging.hpp"
+#include <QDir>
+#include <QFile>
+
+TextLogStore::TextLogStore(const QString &dir) : m_dir(dir) {}
+
+QByteArray TextLogStore::formatLine(const DrinkEntry &entry) {
+  // 时间 | 饮水量 | 今日总量 | 成长值 | 状态，未知的状态写作 "-"
+  return QString("%1 | %2ml | 今日总量: %3 | 成长值: %4 | 状态: %5\n")
+      .arg(entry.timestamp.toString("hh:mm:ss"))
+      .arg(entry.ml)
+      .arg(entry.dayTotal >= 0 ? QString("%1ml").arg(entry.dayTotal)
+                               : QString("-"))
+      .arg(entry.growth >= 0 ? QString::number(entry.growth) : QString("-"))
+      .arg(entry.status.isEmpty() ? QString("-") : entry.status)
+      .toUtf8();
+}
+
+bool TextLogStore::append(const DrinkEntry &entry) {
+  return appendBatch(QVector<DrinkEntry>() << entry);
+}
+
+bool TextLogStore::appendBatch(const QVector<DrinkEntry> &entries) {
+  QDir().mkpath(m_dir);
+
+  // 连续同日的记录共用一次打开
+  int i = 0;
+  while (i < entries.size()) {
+    const QDate day = entries[i].timestamp.date();
+    QByteArray lines;
+    int end = i;
+    while (end < entries.size() && entries[end].timestamp.date() == day)
+      lines.append(formatLine(entries[end++]));
+
+    QFile file(DayLog::fileName(day, m_dir));
+    if (!file.open(QIODevice::Append | QIODevice::Text) ||
+        file.write(lines) != lines.size()) {
+      qCWarning(lcHistory) << "无法写入日志文件:" << file.fileName();
+      return false;
+    }
+    i = end;
+  }
+  return true;
+}
+
+QList<QDate> TextLogStore::availableDays() const {
+  return DayLog::availableDays(m_dir);
+}
+
+int TextLogStore::readDay(
+    const QDate &day,
+    const std::function<void(const QTime &, int)> &onRecord) const {
+  return DayLog::readDay(day, onRecord, m_dir);
+}
+
+int TextLogStore::readRange(
+    qint64 fromEpoch, qint64 toEpoch,
+    const std::function<void(qint64, int)> &onRecord) const {
+  const QDate first = QDateTime::fromSecsSinceEpoch(fromEpoch).date();
+  const QDate last = QDateTime::fromSecsSinceEpoch(toEpoch).date();
+  int count = 0;
+  for (const QDate &day : availableDays()) {
+    if (day < first || day > last)
+      continue;
+    DayLog::readDay(
+        day,
+        [&](const QTime &time, int ml) {
+          qint64 epoch = QDateTime(day, time).toSecsSinceEpoch();
+          if (epoch >= fromEpoch && epoch < toEpoch) {
+            onRecord(epoch, ml);
+            ++count;
+          }
+        },
+        m_dir);
+  }
+  return count;
+}
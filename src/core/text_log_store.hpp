@@ -0,0 +1,31 @@
+#ifndef TEXT_LOG_STORE_HPP
+#define TEXT_LOG_STORE_HPP
+
+#include "history_store.hpp"
+
+// logs/yyyy-MM-dd.log 按日文本日志，格式见 DayLog
+class TextLogStore : public HistoryStore {
+public:
+  explicit TextLogStore(const QString &dir = "logs");
+
+  bool isOpen() const override { return true; }
+  QString backendName() const override { return "text"; }
+
+  bool append(const DrinkEntry &entry) override;
+  bool appendBatch(const QVector<DrinkEntry> &entries) override;
+
+  QList<QDate> availableDays() const override;
+  int readDay(const QDate &day,
+              const std::function<void(const QTime &, int)> &onRecord)
+      const override;
+  int readRange(qint64 fromEpoch, qint64 toEpoch,
+                const std::function<void(qint64, int)> &onRecord)
+      const override;
+
+  static QByteArray formatLine(const DrinkEntry &entry);
+
+private:
+  QString m_dir;
+};
+
+#endif // TEXT_LOG_STORE_HPP
@@ -0,0 +1,157 @@
+#include "trace.hpp"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <chrono>
+
+namespace Trace {
+
+namespace {
+
+const int kRingCapacity = 1 << 14; // 每线程 16384 个 span
+
+struct Event {
+  const char *name;
+  qint64 startNs;
+  qint64 durationNs;
+};
+
+// 单写者 (所属线程) 环形缓冲区。导出方读取后重新检查写指针，
+// 丢弃读取期间可能被覆盖的槽位，因此两边都无需加锁。
+struct Ring {
+  Ring(int id, const char *name)
+      : threadId(id), threadName(name), head(0), tail(0) {}
+
+  int threadId;
+  const char *threadName;
+  std::atomic<quint64> head; // 已写入的事件总数
+  quint64 tail;              // 已导出的位置，只由 flush 访问 (持 s_ringsMutex)
+  Event events[kRingCapacity];
+};
+
+QMutex s_ringsMutex;
+QVector<Ring *> s_rings; // 线程退出后保留，保证其事件仍能导出
+
+const std::chrono::steady_clock::time_point s_epoch =
+    std::chrono::steady_clock::now();
+
+Ring *threadRing() {
+  // 每个线程只在首次记录时注册一次
+  static thread_local Ring *ring = nullptr;
+  if (!ring) {
+    QMutexLocker locker(&s_ringsMutex);
+    QCoreApplication *app = QCoreApplication::instance();
+    bool isMain = app && QThread::currentThread() == app->thread();
+    ring = new Ring(s_rings.size() + 1, isMain ? "main" : "worker");
+    s_rings.append(ring);
+  }
+  return ring;
+}
+
+void appendJsonString(QByteArray *out, const char *text) {
+  out->append('"');
+  for (const char *p = text; *p; ++p) {
+    if (*p == '"' || *p == '\\')
+      out->append('\\');
+    out->append(*p);
+  }
+  out->append('"');
+}
+
+} // namespace
+
+qint64 nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - s_epoch)
+      .count();
+}
+
+void record(const char *name, qint64 startNs, qint64 endNs) {
+  Ring *ring = threadRing();
+  quint64 head = ring->head.load(std::memory_order_relaxed);
+  Event &slot = ring->events[head % kRingCapacity];
+  slot.name = name;
+  slot.startNs = startNs;
+  slot.durationNs = endNs - startNs;
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+QString flush(const QString &dir) {
+  const qint64 pid = QCoreApplication::applicationPid();
+  QByteArray json;
+  json.reserve(1 << 20);
+  json.append("{\"traceEvents\":[\n");
+  bool first = true;
+  int exported = 0;
+
+  QMutexLocker locker(&s_ringsMutex);
+  for (Ring *ring : s_rings) {
+    quint64 head = ring->head.load(std::memory_order_acquire);
+    quint64 begin = ring->tail;
+    if (head - begin > static_cast<quint64>(kRingCapacity))
+      begin = head - kRingCapacity;
+
+    QVector<Event> copy;
+    copy.reserve(static_cast<int>(head - begin));
+    for (quint64 i = begin; i < head; ++i)
+      copy.append(ring->events[i % kRingCapacity]);
+
+    // 复制期间写者可能绕回，覆盖了最前面的若干槽位；写者此刻可能
+    // 正在写 headAfter 所在的槽位，即下标 headAfter - kRingCapacity
+    quint64 headAfter = ring->head.load(std::memory_order_acquire);
+    int skip = 0;
+    if (headAfter - begin >= static_cast<quint64>(kRingCapacity))
+      skip = static_cast<int>(qMin<quint64>(
+          headAfter - kRingCapacity - begin + 1, copy.size()));
+    ring->tail = head;
+
+    if (copy.size() - skip <= 0)
+      continue;
+    if (!first)
+      json.append(",\n");
+    first = false;
+    json.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":");
+    json.append(QByteArray::number(pid));
+    json.append(",\"tid\":").append(QByteArray::number(ring->threadId));
+    json.append(",\"args\":{\"name\":");
+    appendJsonString(&json, ring->threadName);
+    json.append("}}");
+
+    for (int i = skip; i < copy.size(); ++i) {
+      const Event &event = copy[i];
+      json.append(",\n{\"name\":");
+      appendJsonString(&json, event.name);
+      json.append(",\"ph\":\"X\",\"ts\":");
+      json.append(QByteArray::number(event.startNs / 1000.0, 'f', 3));
+      json.append(",\"dur\":");
+      json.append(QByteArray::number(event.durationNs / 1000.0, 'f', 3));
+      json.append(",\"pid\":").append(QByteArray::number(pid));
+      json.append(",\"tid\":").append(QByteArray::number(ring->threadId));
+      json.append('}');
+      ++exported;
+    }
+  }
+  locker.unlock();
+  json.append("\n]}\n");
+
+  if (exported == 0)
+    return QString();
+
+  QDir().mkpath(dir);
+  QString path =
+      QDir(dir).filePath(QString("trace-%1.json")
+                             .arg(QDateTime::currentDateTime().toString(
+                                 "yyyyMMdd-hhmmss-zzz")));
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() ||
+      !file.commit())
+    return QString();
+  return path;
+}
+
+} // namespace Trace
@@ -0,0 +1,46 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <QString>
+#include <QtGlobal>
+
+// 热路径追踪，输出 Chrome / Perfetto 可读的 trace-event JSON。
+// 仅在以 -DOASIS_ENABLE_TRACING=ON 构建时生效，否则 OASIS_TRACE_SCOPE
+// 展开为空语句，不产生任何开销。
+//
+// 每个线程写入自己的固定容量环形缓冲区，记录时不加锁；缓冲区写满后
+// 覆盖最旧的事件。span 名称必须是字符串字面量 (只保存指针)。
+namespace Trace {
+
+qint64 nowNs();
+void record(const char *name, qint64 startNs, qint64 endNs);
+
+// 把各线程缓冲区中尚未导出的事件写入 dir 下新的 trace-*.json，
+// 返回文件路径；没有事件或写入失败时返回空字符串
+QString flush(const QString &dir = "logs");
+
+class Scope {
+public:
+  explicit Scope(const char *name) : m_name(name), m_start(nowNs()) {}
+  ~Scope() { record(m_name, m_start, nowNs()); }
+
+private:
+  Q_DISABLE_COPY(Scope)
+  const char *m_name;
+  qint64 m_start;
+};
+
+} // namespace Trace
+
+#ifdef OASIS_ENABLE_TRACING
+#define OASIS_TRACE_CONCAT_(a, b) a##b
+#define OASIS_TRACE_CONCAT(a, b) OASIS_TRACE_CONCAT_(a, b)
+#define OASIS_TRACE_SCOPE(name)                                                \
+  Trace::Scope OASIS_TRACE_CONCAT(oasisTraceScope_, __LINE__)(name)
+#else
+#define OASIS_TRACE_SCOPE(name)                                                \
+  do {                                                                         \
+  } while (0)
+#endif
+
+#endif // TRACE_HPP
@@ -68,6 +68,37 @@ public:
     int index = QRandomGenerator::global()->bounded(copies.size());
     return copies.at(index);
   }
+
+  // 各风格的标题与按钮文案
+  static QString title(int style = 0) {
+    if (style == 1)
+      return "独立团团部公告箱";
+    if (style == 2)
+      return "【摸鱼办】紧急通知";
+    if (style == 3)
+      return "【陈塘关第一混世魔王】";
+    return "[干一杯]~(￣▽￣)~*";
+  }
+
+  static QString confirmText(int style = 0) {
+    if (style == 1)
+      return "执行命令";
+    if (style == 2)
+      return "带薪喝水";
+    if (style == 3)
+      return "去他爷的，喝！";
+    return "好哒";
+  }
+
+  static QString delayText(int style = 0) {
+    if (style == 1)
+      return "待会儿再说";
+    if (style == 2)
+      return "再卷一会儿";
+    if (style == 3)
+      return "爷就不喝";
+    return "等会儿";
+  }
 };
 
 #endif // WARMING_COPY_HPP
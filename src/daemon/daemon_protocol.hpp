@@ -0,0 +1,19 @@
+#ifndef DAEMON_PROTOCOL_HPP
+#define DAEMON_PROTOCOL_HPP
+
+// Oasis --daemon 与各会话中 oasis-notifier 之间的行协议，UTF-8，以 '\n' 结尾：
+//   守护进程 -> 会话   REMIND\t<饮水量 ml>\t<标题>\t<正文>
+//   会话 -> 守护进程   RELOAD   (重新读取该用户的设置)
+// 用户由套接字对端的 uid 确定，不在协议中传递。
+//
+// 本头文件只依赖 C++ 标准库，不依赖 Qt。
+namespace OasisDaemon {
+
+const char *const kDefaultSocketPath = "/run/oasis/daemon.sock";
+const char *const kRemind = "REMIND";
+const char *const kReload = "RELOAD";
+const int kMaxLineBytes = 4096;
+
+} // namespace OasisDaemon
+
+#endif // DAEMON_PROTOCOL_HPP
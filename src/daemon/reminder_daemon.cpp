@@ -0,0 +1,174 @@
+#include "reminder_daemon.hpp"
+#include "../core/logging.hpp"
+#include "../core/reminder_scheduler.hpp"
+#include "../core/settings_manager.hpp"
+#include "../core/warming_copy.hpp"
+#include "daemon_protocol.hpp"
+#include <QDir>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <pwd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace {
+
+// 本机任何用户都能连上，以下上限防止单个用户让守护进程无限增长
+const int kMaxSessionsPerUser = 16;
+const qint64 kMinReloadIntervalMs = 1000; // 同一用户两次 RELOAD 的最短间隔
+const qint64 kMaxPendingWriteBytes = 64 * 1024; // 会话长期不读就断开
+
+// 套接字对端的 uid，由内核提供，客户端无法伪造
+bool peerUid(qintptr fd, quint32 *uid) {
+#ifdef Q_OS_LINUX
+  struct ucred cred;
+  socklen_t length = sizeof(cred);
+  if (getsockopt(static_cast<int>(fd), SOL_SOCKET, SO_PEERCRED, &cred,
+                 &length) != 0)
+    return false;
+  *uid = cred.uid;
+#else
+  uid_t peer;
+  gid_t group;
+  if (getpeereid(static_cast<int>(fd), &peer, &group) != 0)
+    return false;
+  *uid = peer;
+#endif
+  return true;
+}
+
+QString configPathFor(quint32 uid) {
+  struct passwd entry;
+  struct passwd *result = nullptr;
+  char buffer[1024];
+  if (getpwuid_r(uid, &entry, buffer, sizeof(buffer), &result) != 0 ||
+      !result)
+    return QString();
+  return QDir(QString::fromLocal8Bit(result->pw_dir))
+      .filePath(".config/Agil/Oasis.conf");
+}
+
+QByteArray field(const QString &text) {
+  QByteArray bytes = text.toUtf8();
+  bytes.replace('\t', ' ').replace('\n', ' ');
+  return bytes;
+}
+
+} // namespace
+
+ReminderDaemon::ReminderDaemon(QObject *parent)
+    : QObject(parent), m_server(new QLocalServer(this)),
+      m_scheduler(new ReminderScheduler(this)) {
+  m_uptime.start();
+  connect(m_server, &QLocalServer::newConnection, this,
+          &ReminderDaemon::onConnection);
+  connect(m_scheduler, &ReminderScheduler::reminderDue, this,
+          &ReminderDaemon::onReminderDue);
+}
+
+bool ReminderDaemon::listen(const QString &socketPath) {
+  // 所有用户都要能连上；身份由对端 uid 决定
+  m_server->setSocketOptions(QLocalServer::WorldAccessOption);
+  QDir().mkpath(QFileInfo(socketPath).absolutePath());
+  QLocalServer::removeServer(socketPath);
+  if (!m_server->listen(socketPath)) {
+    qCWarning(lcReminder) << "守护进程无法监听" << socketPath << ":"
+                          << m_server->errorString();
+    return false;
+  }
+  qCInfo(lcReminder) << "守护进程已在" << socketPath << "监听";
+  return true;
+}
+
+void ReminderDaemon::onConnection() {
+  while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+    quint32 uid = 0;
+    if (!peerUid(socket->socketDescriptor(), &uid)) {
+      qCWarning(lcReminder) << "无法识别会话的用户，断开连接";
+      socket->deleteLater();
+      continue;
+    }
+    if (m_sessions.count(uid) >= kMaxSessionsPerUser) {
+      qCWarning(lcReminder) << "用户" << uid << "的会话数已达上限，拒绝连接";
+      socket->abort();
+      socket->deleteLater();
+      continue;
+    }
+    socket->setProperty("uid", uid);
+    socket->setReadBufferSize(OasisDaemon::kMaxLineBytes);
+    connect(socket, &QLocalSocket::readyRead, this,
+            [this, socket]() { onReadyRead(socket); });
+    connect(socket, &QLocalSocket::disconnected, this,
+            [this, socket]() { onDisconnected(socket); });
+
+    // 同一用户的新会话也会重读设置，设置改动后重新登录即生效
+    m_sessions.insert(uid, socket);
+    loadUser(uid);
+  }
+}
+
+void ReminderDaemon::onReadyRead(QLocalSocket *socket) {
+  const quint32 uid = socket->property("uid").toUInt();
+  while (socket->canReadLine()) {
+    QByteArray line = socket->readLine().trimmed();
+    if (line != OasisDaemon::kReload)
+      continue;
+    // 每次重读都要解析配置文件，过于频繁的请求直接忽略
+    const qint64 now = m_uptime.elapsed();
+    QHash<quint32, qint64>::const_iterator last = m_lastReload.constFind(uid);
+    if (last != m_lastReload.constEnd() &&
+        now - last.value() < kMinReloadIntervalMs)
+      continue;
+    m_lastReload.insert(uid, now);
+    loadUser(uid);
+  }
+  // 读缓冲区已满仍没有完整的一行，说明对端不是 notifier
+  if (socket->bytesAvailable() >= OasisDaemon::kMaxLineBytes)
+    socket->abort();
+}
+
+void ReminderDaemon::onDisconnected(QLocalSocket *socket) {
+  const quint32 uid = socket->property("uid").toUInt();
+  m_sessions.remove(uid, socket);
+  socket->deleteLater();
+  if (!m_sessions.contains(uid)) {
+    m_scheduler->removeUser(uid);
+    m_lastReload.remove(uid);
+    qCDebug(lcReminder) << "用户" << uid << "的会话已全部断开";
+  }
+}
+
+void ReminderDaemon::loadUser(quint32 uid) {
+  const QString path = configPathFor(uid);
+  if (path.isEmpty()) {
+    m_scheduler->setUser(uid, ReminderScheduler::Config());
+    return;
+  }
+  // 配置文件不存在时得到默认设置；SettingsManager 用完即释放
+  SettingsManager settings(path);
+  m_scheduler->setUser(uid, ReminderScheduler::Config::fromSettings(settings));
+  qCDebug(lcReminder) << "已载入用户" << uid << "的设置:" << path;
+}
+
+void ReminderDaemon::onReminderDue(quint32 uid, int style, int drinkAmount) {
+  QByteArray line(OasisDaemon::kRemind);
+  line.append('\t').append(QByteArray::number(drinkAmount));
+  line.append('\t').append(field(WarmingCopy::title(style)));
+  line.append('\t').append(field(WarmingCopy::getRandomCopy(style)));
+  line.append('\n');
+  QList<QLocalSocket *> stalled;
+  for (auto it = m_sessions.constFind(uid);
+       it != m_sessions.constEnd() && it.key() == uid; ++it) {
+    if (it.value()->bytesToWrite() + line.size() > kMaxPendingWriteBytes)
+      stalled << it.value();
+    else
+      it.value()->write(line);
+  }
+  // 断开会同步触发 onDisconnected 修改 m_sessions，遍历结束后再做
+  for (QLocalSocket *socket : stalled) {
+    qCWarning(lcReminder) << "用户" << uid << "的会话长期未读取提醒，断开";
+    socket->abort();
+  }
+}
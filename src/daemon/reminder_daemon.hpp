@@ -0,0 +1,41 @@
+#ifndef REMINDER_DAEMON_HPP
+#define REMINDER_DAEMON_HPP
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMultiHash>
+#include <QObject>
+
+class QLocalServer;
+class QLocalSocket;
+class ReminderScheduler;
+
+// 多用户提醒守护进程 (终端服务器、多席位主机)：每个登录会话只运行一个
+// 不依赖 Qt 的 oasis-notifier，连到同一个 Unix 套接字。守护进程按对端 uid
+// 识别用户，读取其 ~/.config/Agil/Oasis.conf 交给 ReminderScheduler；
+// 到期时把提醒推送给该用户的所有会话。用户的最后一个会话断开后即停止调度。
+class ReminderDaemon : public QObject {
+  Q_OBJECT
+public:
+  explicit ReminderDaemon(QObject *parent = nullptr);
+
+  bool listen(const QString &socketPath);
+  ReminderScheduler *scheduler() const { return m_scheduler; }
+
+private slots:
+  void onConnection();
+  void onReminderDue(quint32 uid, int style, int drinkAmount);
+
+private:
+  void onReadyRead(QLocalSocket *socket);
+  void onDisconnected(QLocalSocket *socket);
+  void loadUser(quint32 uid);
+
+  QLocalServer *m_server;
+  ReminderScheduler *m_scheduler;
+  QMultiHash<quint32, QLocalSocket *> m_sessions; // uid -> 会话
+  QHash<quint32, qint64> m_lastReload; // uid -> 上次重读设置的 m_uptime
+  QElapsedTimer m_uptime;
+};
+
+#endif // REMINDER_DAEMON_HPP
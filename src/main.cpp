@@ -1,30 +1,72 @@
 #include <QAction>
 #include <QApplication>
-#include <QDebug>
 #include <QFile>
 #include <QIcon>
+#include <QLabel>
 #include <QMenu>
 #include <QMessageBox>
+#include <QPixmap>
 #include <QProcess>
+#include <QScopedPointer>
 #include <QSystemTrayIcon>
+#include <QThread>
 #include <QTimer>
+#include <memory>
 
 #ifndef Q_OS_WIN
 #include <QDesktopWidget>
 #endif
 
+#include "cli/cli.hpp"
+#include "core/clock.hpp"
+#include "core/drink_ingest.hpp"
+#include "core/history_backfill.hpp"
+#include "core/history_index.hpp"
+#include "core/history_sync.hpp"
+#include "core/hydration_analytics.hpp"
+#include "core/logging.hpp"
+#include "core/metrics_server.hpp"
+#include "core/object_census.hpp"
+#include "core/plant_model.hpp"
 #include "core/plant_system.hpp"
 #include "core/reminder_engine.hpp"
 #include "core/settings_manager.hpp"
-#include "ui/popup_widget.hpp"
+#ifdef Q_OS_UNIX
+#include "core/status_publisher.hpp"
+#endif
+#include "core/trace.hpp"
+#include "ui/export_dialog.hpp"
+#include "ui/history_widget.hpp"
+#include "ui/reminder_channel.hpp"
 #include "ui/settings_widget.hpp"
 #include "ui/stats_widget.hpp"
+#include "ui/tray_progress_icon.hpp"
+#include "ui/weekly_report.hpp"
 
 int main(int argc, char *argv[]) {
+  // 命令行模式不需要图形界面
+  if (Cli::isCliInvocation(argc, argv)) {
+    QScopedPointer<QCoreApplication> app;
+    if (Cli::needsWidgets(argc, argv)) {
+      // 耐久测试驱动真实窗口，没有指定平台时不需要显示器
+      if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+      app.reset(new QApplication(argc, argv));
+    } else {
+      app.reset(new QCoreApplication(argc, argv));
+    }
+    app->setApplicationName("Oasis");
+    app->setOrganizationName("Agil");
+    return Cli::run(*app);
+  }
+
   QApplication app(argc, argv);
   app.setApplicationName("Oasis");
   app.setOrganizationName("Agil");
 
+  // 日志交给后台线程写入 logs/oasis.log，界面线程不再同步写终端
+  Logging::install("logs");
+
   // 注入莫兰迪风格全局样式
   app.setStyleSheet(R"(
     * {
@@ -137,13 +179,75 @@ int main(int argc, char *argv[]) {
 
   // 初始化核心逻辑
   SettingsManager *settings = new SettingsManager(&app);
+  // 诊断模式要在其余对象创建前装上计数钩子
+  const bool census =
+      settings->objectCensusEnabled() && ObjectCensus::install();
   ReminderEngine *engine = new ReminderEngine(&app);
-  PlantSystem *plantSystem = new PlantSystem(&app);
+
+  // 植物状态归独立的状态线程所有：各来源的饮水经 DrinkIngest 无锁汇入，
+  // 界面、托盘与状态页只读取 snapshot()
+  QThread *plantThread = new QThread(&app);
+  plantThread->setObjectName("oasis-plant");
+  PlantSystem *plantSystem = new PlantSystem(settings->historyBackend());
+  plantSystem->recordGoalChange(settings->dailyGoal());
+  DrinkIngest *drinkIngest = new DrinkIngest(plantSystem);
+  plantSystem->moveToThread(plantThread);
+  QObject::connect(plantThread, &QThread::finished, plantSystem,
+                   &QObject::deleteLater);
+  plantThread->start();
+  QObject::connect(&app, &QCoreApplication::aboutToQuit, [=]() {
+    // 排在已投递的饮水之后退出，积压的记录不会丢
+    QTimer::singleShot(0, plantSystem, [=]() { plantThread->quit(); });
+    plantThread->wait();
+    // 事件循环已停止：把这些饮水发回的 drinkRecorded 等排队调用处理完，
+    // 否则按日日志有记录而 history.idx 没有
+    QCoreApplication::sendPostedEvents();
+  });
+
+  // 历史汇总索引：随每次饮水增量更新，缺失时在后台并行回填 (见下方)
+  HistoryIndex *historyIndex = new HistoryIndex("logs", &app);
+  bool needsBackfill = !historyIndex->load();
+  QObject::connect(plantSystem, &PlantSystem::drinkRecorded, historyIndex,
+                   &HistoryIndex::recordDrink);
+
+  // 习惯分析：启动时初始化一次，之后订阅饮水与跨天事件增量更新
+  HydrationAnalytics *analytics = new HydrationAnalytics(&app);
+  auto goalForDay = [=](const QDate &day) {
+    int goal = plantSystem->snapshot()->goalOn(day);
+    return goal > 0 ? goal : settings->dailyGoal();
+  };
+  auto rebuildAnalytics = [=]() {
+    analytics->rebuild(historyIndex, Clock::instance()->today(), goalForDay);
+  };
+  rebuildAnalytics();
+  QObject::connect(plantSystem, &PlantSystem::drinkRecorded, analytics,
+                   &HydrationAnalytics::recordDrink);
+  QObject::connect(plantSystem, &PlantSystem::dayRolledOver, analytics,
+                   &HydrationAnalytics::rollOver);
 
   // 初始化 UI 组件
-  PopupWidget *popup = new PopupWidget();
-  StatsWidget *statsWidget = new StatsWidget(plantSystem, settings);
-  SettingsWidget *settingsWidget = new SettingsWidget(settings);
+  // 提醒送达方式可在配置文件中通过 popup_backend 切换 (widget/raster/dbus)
+  // 弹窗是顶层窗口，须在 QApplication 析构前释放
+  QScopedPointer<ReminderChannel> reminderChannelOwner(
+      ReminderChannel::create(settings->popupBackend()));
+  ReminderChannel *reminderChannel = reminderChannelOwner.data();
+  auto showPopup = [=]() {
+    reminderChannel->deliver(settings->drinkAmount(),
+                             settings->reminderStyle());
+  };
+  // 顶层窗口同样没有父对象，由作用域指针在 QApplication 之前释放
+  QScopedPointer<StatsWidget> statsWidgetOwner(
+      new StatsWidget(plantSystem, settings, historyIndex, analytics));
+  StatsWidget *statsWidget = statsWidgetOwner.data();
+  QScopedPointer<SettingsWidget> settingsWidgetOwner(
+      new SettingsWidget(settings));
+  SettingsWidget *settingsWidget = settingsWidgetOwner.data();
+  QScopedPointer<ExportDialog> exportDialogOwner(
+      new ExportDialog(settings->historyBackend()));
+  ExportDialog *exportDialog = exportDialogOwner.data();
+  QScopedPointer<HistoryWidget> historyWidgetOwner(
+      new HistoryWidget(historyIndex, settings));
+  HistoryWidget *historyWidget = historyWidgetOwner.data();
 
   engine->setMode(
       static_cast<ReminderEngine::ReminderMode>(settings->reminderMode()));
@@ -154,12 +258,25 @@ int main(int argc, char *argv[]) {
   engine->setDND(settings->isPaused());
   engine->start();
 
+  // 本地指标端点 (默认关闭，在配置文件中设置 metrics_enabled=true 开启)
+  if (settings->metricsEnabled()) {
+    MetricsServer *metricsServer = new MetricsServer(&app);
+    if (settings->metricsSocketPath().isEmpty())
+      metricsServer->listenTcp(static_cast<quint16>(settings->metricsPort()));
+    else
+      metricsServer->listenLocal(settings->metricsSocketPath());
+  }
+
   // 基础系统托盘初始化
   QSystemTrayIcon *trayIcon = new QSystemTrayIcon(&app);
   trayIcon->setIcon(QIcon(":/icon.png"));
   trayIcon->setToolTip("Oasis (干一杯) - 智能补水助手");
+  // 图标帧在后台画好后才替换默认图标
+  TrayProgressIcon *trayProgress = new TrayProgressIcon(trayIcon, &app);
 
-  QMenu *trayMenu = new QMenu();
+  // QSystemTrayIcon 不接管菜单的所有权
+  QScopedPointer<QMenu> trayMenuOwner(new QMenu());
+  QMenu *trayMenu = trayMenuOwner.data();
   QAction *testPopupAction =
       new QAction("测试弹窗", trayMenu); // Keep this action as it's used later
   QAction *quickDrinkAction = new QAction(
@@ -168,6 +285,9 @@ int main(int argc, char *argv[]) {
       new QAction(settings->isPaused() ? "恢复提醒" : "暂停提醒", trayMenu);
   QAction *settingsAction = new QAction("个人设置", trayMenu);
   QAction *statsAction = new QAction("进度报告", trayMenu);
+  QAction *historyAction = new QAction("历史趋势", trayMenu);
+  QAction *weeklyReportAction = new QAction("本周报告", trayMenu);
+  QAction *exportAction = new QAction("导出记录...", trayMenu);
   QAction *exitAction = new QAction("完全退出", trayMenu);
 
   trayMenu->addAction(quickDrinkAction);
@@ -177,6 +297,25 @@ int main(int argc, char *argv[]) {
   trayMenu->addSeparator();
   trayMenu->addAction(settingsAction);
   trayMenu->addAction(statsAction);
+  trayMenu->addAction(historyAction);
+  trayMenu->addAction(weeklyReportAction);
+  trayMenu->addAction(exportAction);
+#ifdef OASIS_ENABLE_TRACING
+  QAction *traceAction = new QAction("导出性能追踪", trayMenu);
+  trayMenu->addAction(traceAction);
+  QObject::connect(traceAction, &QAction::triggered, [=]() {
+    QString path = Trace::flush();
+    trayIcon->showMessage("Oasis", path.isEmpty()
+                                       ? QString("暂无追踪数据")
+                                       : QString("已写入 %1").arg(path));
+  });
+  // 退出时导出剩余的追踪数据
+  QObject::connect(&app, &QCoreApplication::aboutToQuit, []() {
+    QString path = Trace::flush();
+    if (!path.isEmpty())
+      qCDebug(lcApp) << "Trace written to" << path;
+  });
+#endif
   QAction *restartAction = new QAction("重启 Oasis", trayMenu);
   QAction *quitAction = new QAction("退出 Oasis", trayMenu);
 
@@ -184,7 +323,7 @@ int main(int argc, char *argv[]) {
   trayMenu->addAction(quitAction);
 
   QObject::connect(restartAction, &QAction::triggered, [=, &app]() {
-    qDebug() << "Restarting application...";
+    qCDebug(lcApp) << "Restarting application...";
     QProcess::startDetached(app.applicationFilePath(), app.arguments());
     app.quit();
   });
@@ -193,45 +332,219 @@ int main(int argc, char *argv[]) {
   trayIcon->setContextMenu(trayMenu);
   trayIcon->show();
 
+#ifdef Q_OS_UNIX
+  // 共享内存状态页，状态栏通过 oasis-status 读取；退出时删除
+  QScopedPointer<StatusPublisher> statusPublisher(new StatusPublisher());
+  StatusPublisher *statusPage = statusPublisher.data();
+#endif
+
   // 信号槽连接
   auto updateTooltip = [=]() {
-    int current = plantSystem->todayWaterIntake();
+    PlantSnapshotPtr plant = plantSystem->snapshot();
+    int current = plant->todayWaterIntake();
     int goal = settings->dailyGoal();
     trayIcon->setToolTip(QString("Oasis (干一杯) - 今日进度: %1/%2 ml (%3%)")
                              .arg(current)
                              .arg(goal)
                              .arg(current * 100 / (goal ? goal : 1)));
+    trayProgress->setProgress(current, goal);
+#ifdef Q_OS_UNIX
+    PlantSystem::PlantStatus status = plant->status();
+    statusPage->publish(current, goal, status, PlantModel::statusName(status),
+                        plant->state.growthValue, plant->state.harvestCount,
+                        settings->isPaused(), engine->nextReminderTime());
+#endif
   };
   updateTooltip();
+  QObject::connect(engine, &ReminderEngine::nextReminderChanged,
+                   updateTooltip);
 
-  QObject::connect(engine, &ReminderEngine::reminderTriggered, [=]() {
-    popup->setDrinkAmount(settings->drinkAmount());
-    popup->setReminderStyle(settings->reminderStyle());
-    popup->showAnimated();
-  });
-  QObject::connect(popup, &PopupWidget::drinkConfirmed, [=](int ml) {
-    plantSystem->recordDrink(ml);
-    updateTooltip();
-  });
+  // 周报：在后台线程渲染为 PNG，内容未变的周沿用已有文件
+  WeeklyReportRenderer *weeklyReports =
+      new WeeklyReportRenderer("reports", &app);
+  auto thisWeekStart = []() {
+    QDate today = Clock::instance()->today();
+    return today.addDays(1 - today.dayOfWeek());
+  };
+  auto requestWeeklyReport = [=](const QDate &weekStart) {
+    WeeklyReportData data;
+    data.fillWeek(historyIndex, weekStart, goalForDay);
+    // 连续天数与植物状态取该周最后一天结束时的值，本周取此刻的值，
+    // 周一跨天时生成的上周周报因此不受今天的影响
+    const QDate today = Clock::instance()->today();
+    const QDate lastDay = qMin(weekStart.addDays(6), today);
+    data.streak = analytics->streakOn(lastDay);
+    const QDateTime asOf = lastDay < today
+                               ? QDateTime(lastDay, QTime(23, 59, 59))
+                               : Clock::instance()->now();
+    // 往日的状态要回放事件流，只能在状态线程里求值
+    QMetaObject::invokeMethod(
+        plantSystem,
+        [=]() mutable {
+          PlantSystem::PlantStatus status = plantSystem->statusAt(asOf);
+          data.plantIcon = PlantModel::statusIcon(status);
+          data.plantStatus = PlantModel::statusName(status);
+          QMetaObject::invokeMethod(
+              weeklyReports, [=]() { weeklyReports->request(data); },
+              Qt::QueuedConnection);
+        },
+        Qt::QueuedConnection);
+  };
+  // 新的一周开始时生成上周的周报；首次运行只记下当前周。
+  // 周报生成成功后才记下，失败或生成前退出会在下次检查时重试
+  auto checkWeeklyReport = [=]() {
+    QDate thisWeek = thisWeekStart();
+    QDate last = settings->lastWeeklyReport();
+    if (last.isValid() && last >= thisWeek)
+      return;
+    if (last.isValid())
+      requestWeeklyReport(thisWeek.addDays(-7));
+    else
+      settings->setLastWeeklyReport(thisWeek);
+  };
+  QObject::connect(
+      weeklyReports, &WeeklyReportRenderer::reportReady,
+      [=](const QDate &weekStart, const QString &path, bool cached) {
+        Q_UNUSED(cached);
+        // 往周的报告已生成，记下它的下一周，之后不再重复生成
+        const QDate done = weekStart.addDays(7);
+        if (weekStart != thisWeekStart() &&
+            settings->lastWeeklyReport() < done)
+          settings->setLastWeeklyReport(done);
+        // 菜单里手动查看的是本周，总是展示；自动生成的上周报告按设置
+        if (weekStart != thisWeekStart() && !settings->weeklyReportPopup())
+          return;
+        QPixmap pixmap(path);
+        pixmap.setDevicePixelRatio(WeeklyReportRenderer::kPixelRatio);
+        QLabel *view = new QLabel();
+        view->setAttribute(Qt::WA_DeleteOnClose);
+        view->setWindowTitle("饮水周报");
+        view->setPixmap(pixmap);
+        view->show();
+      });
+  QObject::connect(weeklyReports, &WeeklyReportRenderer::reportFailed,
+                   [=](const QDate &weekStart, const QString &error) {
+                     Q_UNUSED(weekStart);
+                     trayIcon->showMessage("Oasis",
+                                           QString("周报生成失败: %1")
+                                               .arg(error));
+                   });
+  QObject::connect(weeklyReportAction, &QAction::triggered,
+                   [=]() { requestWeeklyReport(thisWeekStart()); });
+  QObject::connect(plantSystem, &PlantSystem::dayRolledOver, &app,
+                   checkWeeklyReport);
+
+  // 多设备同步 (在配置文件中设置 sync_dir 开启)。合并可能修正任意一天的
+  // 历史，要等回填结束再开始，否则会与回填读到的日志重复或遗漏
+  auto startSync = [=, &app]() {
+    if (settings->syncDir().isEmpty())
+      return;
+    // 同步日志与事件流一起只在状态线程中读写
+    HistorySync *sync =
+        new HistorySync(settings->syncDir(), settings->deviceId(), "logs");
+    sync->moveToThread(plantThread);
+    QObject::connect(plantThread, &QThread::finished, sync,
+                     &QObject::deleteLater);
+    QTimer::singleShot(0, plantSystem, [=]() {
+      plantSystem->setSync(sync);
+      sync->poll();
+    });
+    QObject::connect(sync, &HistorySync::changed, plantSystem, [=]() {
+      plantSystem->mergeRemoteEvents(sync->collect());
+    });
+    QObject::connect(plantSystem, &PlantSystem::remoteDrinksMerged, &app,
+                     [=](const QVector<PlantEvent> &drinks) {
+                       // 其他设备补来的历史只按受影响的天增量修正
+                       for (const PlantEvent &drink : drinks) {
+                         const QDateTime when =
+                             QDateTime::fromSecsSinceEpoch(drink.timestamp);
+                         historyIndex->add(when, drink.value);
+                         analytics->applyCorrection(when, drink.value);
+                       }
+                       historyIndex->save();
+                       historyWidget->refresh();
+                     });
+  };
+
+  if (needsBackfill) {
+    // 首次启用：在线程池里解析全部历史日志，托盘保持响应
+    HistoryBackfill *backfill = new HistoryBackfill(
+        historyIndex, "logs", settings->historyBackend(), &app);
+    // 近几天的记录在状态线程里读取，与排队中的 recordDrink 不重复计数
+    backfill->setWriter(plantSystem);
+    QObject::connect(backfill, &HistoryBackfill::progress,
+                     [=](int done, int total) {
+                       trayIcon->setToolTip(
+                           QString("Oasis (干一杯) - 正在整理历史记录 %1/%2")
+                               .arg(done)
+                               .arg(total));
+                     });
+    QObject::connect(backfill, &HistoryBackfill::finished,
+                     [=](bool ok, qint64 records) {
+                       Q_UNUSED(records);
+                       rebuildAnalytics();
+                       historyWidget->refresh();
+                       updateTooltip();
+                       checkWeeklyReport();
+                       if (ok) // 取消只发生在退出时，不再启动同步
+                         startSync();
+                       backfill->deleteLater();
+                     });
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, backfill,
+                     &HistoryBackfill::cancel);
+    backfill->start();
+  } else {
+    checkWeeklyReport();
+    startSync();
+  }
+
+  if (census) {
+    // 每天记录一次存活对象与内存，列出比前一天增加最多的类
+    auto previous =
+        std::make_shared<ObjectCensus::Sample>(ObjectCensus::take());
+    QObject::connect(plantSystem, &PlantSystem::dayRolledOver, &app, [=]() {
+      ObjectCensus::Sample sample = ObjectCensus::take();
+      qCInfo(lcApp) << "Census: objects" << sample.liveObjects << "rss KB"
+                    << sample.rssBytes / 1024 << "heap KB"
+                    << sample.heapBytes / 1024;
+      const QList<QPair<QByteArray, int> > grown =
+          ObjectCensus::growth(*previous, sample);
+      for (int i = 0; i < grown.size() && i < 5; ++i)
+        qCInfo(lcApp) << "Census:" << grown[i].first << "+" << grown[i].second;
+      *previous = sample;
+    });
+  }
+
+  // 跨天、枯萎等由时间驱动的状态变化也要同步到托盘
+  QObject::connect(plantSystem, &PlantSystem::plantUpdated, &app,
+                   updateTooltip);
+
+  QObject::connect(engine, &ReminderEngine::reminderTriggered, showPopup);
+  QObject::connect(reminderChannel, &ReminderChannel::drinkConfirmed,
+                   [=](int ml) {
+                     drinkIngest->submit(ml, DrinkIngest::Popup);
+                   });
   QObject::connect(quickDrinkAction, &QAction::triggered, [=]() {
-    plantSystem->recordDrink(settings->drinkAmount());
-    updateTooltip();
+    drinkIngest->submit(settings->drinkAmount(), DrinkIngest::Tray);
   });
   QObject::connect(pauseAction, &QAction::triggered, [=]() {
     bool newState = !settings->isPaused();
     settings->setPaused(newState);
     engine->setDND(newState);
     pauseAction->setText(newState ? "恢复提醒" : "暂停提醒");
+    updateTooltip();
   });
-  QObject::connect(testPopupAction, &QAction::triggered, [=]() {
-    popup->setDrinkAmount(settings->drinkAmount());
-    popup->setReminderStyle(settings->reminderStyle());
-    popup->showAnimated();
-  });
+  QObject::connect(testPopupAction, &QAction::triggered, showPopup);
   QObject::connect(statsAction, &QAction::triggered, statsWidget,
                    &StatsWidget::show);
+  QObject::connect(historyAction, &QAction::triggered, historyWidget,
+                   &HistoryWidget::show);
   QObject::connect(settingsAction, &QAction::triggered, settingsWidget,
                    &SettingsWidget::show);
+  QObject::connect(exportAction, &QAction::triggered, exportDialog,
+                   &ExportDialog::show);
+  QObject::connect(settingsWidget, &SettingsWidget::exportRequested,
+                   exportDialog, &ExportDialog::show);
   QObject::connect(settingsWidget, &SettingsWidget::settingsChanged, [=]() {
     engine->setMode(
         static_cast<ReminderEngine::ReminderMode>(settings->reminderMode()));
@@ -239,16 +552,21 @@ int main(int argc, char *argv[]) {
     engine->setFixedMoments(settings->fixedMoments());
     engine->setDNDRange(settings->dndStart(), settings->dndEnd());
     engine->setDNDEnabled(settings->isDNDEnabled());
+    QMetaObject::invokeMethod(plantSystem, "recordGoalChange",
+                              Qt::QueuedConnection,
+                              Q_ARG(int, settings->dailyGoal()));
+    analytics->setDailyGoal(settings->dailyGoal());
     quickDrinkAction->setText(
         QString("快捷补水 (+%1ml)").arg(settings->drinkAmount()));
     statsWidget->refresh();
+    historyWidget->refresh();
     updateTooltip();
-    qDebug() << "Settings applied to engine and stats";
+    qCDebug(lcApp) << "Settings applied to engine and stats";
   });
   QObject::connect(exitAction, &QAction::triggered, &app,
                    &QCoreApplication::quit);
 
-  qDebug() << "Oasis started...";
+  qCDebug(lcApp) << "Oasis started...";
 
   return app.exec();
 }
@@ -1,4 +1,5 @@
 #include "circular_progress.hpp"
+#include "../../core/trace.hpp"
 #include <QColor>
 #include <QPainter>
 #include <QPen>
@@ -29,18 +30,26 @@ void CircularProgressBar::setIconText(const QString &icon) {
 }
 
 void CircularProgressBar::paintEvent(QPaintEvent *event) {
+  OASIS_TRACE_SCOPE("CircularProgressBar::paintEvent");
   Q_UNUSED(event);
   QPainter painter(this);
+  double fraction =
+      m_max > m_min ? double(m_value - m_min) / (m_max - m_min) : 0.0;
+  paint(painter, rect(), fraction, m_iconText);
+}
+
+void CircularProgressBar::paint(QPainter &painter, const QRectF &bounds,
+                                double fraction, const QString &iconText,
+                                int iconPointSize, int thickness) {
+  painter.save();
   painter.setRenderHint(QPainter::Antialiasing);
 
-  int w = width();
-  int h = height();
-  int side = qMin(w, h);
-  int thickness = 8;
+  double side = qMin(bounds.width(), bounds.height());
 
   // 圆环居中展示
-  int circleSize = side - thickness;
-  QRectF circleRect(thickness / 2.0, thickness / 2.0, circleSize, circleSize);
+  double circleSize = side - thickness;
+  QRectF circleRect(0, 0, circleSize, circleSize);
+  circleRect.moveCenter(bounds.center());
 
   // 背景圆环
   QPen bgPen(QColor(255, 255, 255, 100));
@@ -56,15 +65,16 @@ void CircularProgressBar::paintEvent(QPaintEvent *event) {
   progressPen.setColor(QColor("#5A6B58"));
   painter.setPen(progressPen);
 
-  double spanAngle = -((double)(m_value - m_min) / (m_max - m_min)) * 360 * 16;
-  painter.drawArc(circleRect, 90 * 16, spanAngle);
+  double spanAngle = -qBound(0.0, fraction, 1.0) * 360 * 16;
+  painter.drawArc(circleRect, 90 * 16, int(spanAngle));
 
-  // 绘制圆心图标 (48px 大图标)
-  if (!m_iconText.isEmpty()) {
+  // 绘制圆心图标 (默认 48px 大图标)
+  if (!iconText.isEmpty()) {
     QFont iconFont = painter.font();
-    iconFont.setPointSize(48);
+    iconFont.setPointSize(iconPointSize);
     painter.setFont(iconFont);
     painter.setPen(Qt::white);
-    painter.drawText(circleRect, Qt::AlignCenter, m_iconText);
+    painter.drawText(circleRect, Qt::AlignCenter, iconText);
   }
+  painter.restore();
 }
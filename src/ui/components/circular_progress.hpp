@@ -4,6 +4,8 @@
 #include <QPropertyAnimation>
 #include <QWidget>
 
+class QPainter;
+
 class CircularProgressBar : public QWidget {
   Q_OBJECT
   Q_PROPERTY(int value READ value WRITE setValue)
@@ -17,6 +19,12 @@ public:
   void setRange(int min, int max);
   void setIconText(const QString &icon);
 
+  // 只负责绘制，不依赖控件本身：周报等离屏渲染在工作线程中复用。
+  // fraction 为 0.0 - 1.0 的进度，圆环取 bounds 内居中的最大正方形
+  static void paint(QPainter &painter, const QRectF &bounds, double fraction,
+                    const QString &iconText, int iconPointSize = 48,
+                    int thickness = 8);
+
 protected:
   void paintEvent(QPaintEvent *event) override;
 
@@ -0,0 +1,634 @@
+#include "history_chart.hpp"
+#include "../../core/clock.hpp"
+#include "../../core/history_index.hpp"
+#include "../../core/trace.hpp"
+#include <QFutureWatcher>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QThreadPool>
+#include <QToolTip>
+#include <QWheelEvent>
+#include <QtConcurrent>
+#include <QtMath>
+#include <cmath>
+#include <cstring>
+
+// 只读数据快照，工作线程与 GUI 线程共享，创建后不再修改
+struct HistoryChartData {
+  HistoryChartData() : maxDay(0), maxHour(0) {}
+
+  QDate firstDay;
+  QVector<qint32> dayTotals;
+  QVector<qint32> hourBins; // dayTotals.size() * 24
+  qint32 maxDay;
+  qint32 maxHour;
+
+  int dayCount() const { return dayTotals.size(); }
+};
+
+namespace {
+
+const int kTileWidth = 256;        // 时间线瓦片宽度 (逻辑像素)
+const int kMinLevel = -8;          // 1/256 像素每天，十年约 14 像素
+const int kMaxLevel = 8;           // 256 像素每天，约 10 像素每小时
+const double kHourlyPixelsPerDay = 48; // 达到后按小时画柱
+const double kDailyPixelsPerDay = 2;   // 达到后按天画柱，否则按列抽稀
+const int kAxisHeight = 20;
+const int kPlotTop = 8;
+const int kTileBudgetKB = 32 * 1024;
+const int kWeekdayLabelWidth = 28;
+const int kMonthLabelHeight = 18;
+
+const QColor kBarColor(96, 136, 90);
+const QColor kRangeColor(96, 136, 90, 90);
+const QColor kGoalColor(255, 255, 255, 170);
+const QColor kLabelColor(74, 74, 74);
+
+struct TileJob {
+  QSharedPointer<const HistoryChartData> data;
+  int kind;
+  int level;
+  int index;
+  QSize size;
+  qreal dpr;
+  int goal;
+};
+
+double levelPixelsPerDay(int level) { return std::ldexp(1.0, level); }
+
+QImage newTileImage(const QSize &size, qreal dpr) {
+  QImage image(size * dpr, QImage::Format_ARGB32_Premultiplied);
+  image.setDevicePixelRatio(dpr);
+  image.fill(Qt::transparent);
+  return image;
+}
+
+// 日历热力图布局：53 列 (周) x 7 行 (周一..周日)
+struct HeatmapLayout {
+  double cell;
+  QPointF origin;
+};
+
+HeatmapLayout heatmapLayout(const QSize &size) {
+  HeatmapLayout layout;
+  layout.cell = qMax(2.0, qMin((size.width() - kWeekdayLabelWidth - 8) / 53.0,
+                               (size.height() - kMonthLabelHeight - 8) / 7.0));
+  layout.origin = QPointF(kWeekdayLabelWidth, kMonthLabelHeight);
+  return layout;
+}
+
+// 1 月 1 日所在周的周一为第 0 列
+QDate heatmapColumnStart(int year) {
+  QDate jan1(year, 1, 1);
+  return jan1.addDays(1 - jan1.dayOfWeek());
+}
+
+QColor heatmapColor(qint32 total, int goal) {
+  if (total <= 0)
+    return QColor(255, 255, 255, 90);
+  double ratio = goal > 0 ? static_cast<double>(total) / goal : 1.0;
+  if (ratio < 0.25)
+    return QColor(214, 226, 209);
+  if (ratio < 0.5)
+    return QColor(176, 200, 170);
+  if (ratio < 0.75)
+    return QColor(136, 170, 128);
+  if (ratio < 1.0)
+    return QColor(96, 136, 90);
+  return QColor(64, 100, 60);
+}
+
+// 星期与月份标签在 GUI 线程绘制：并非所有平台都支持在工作线程排版文字
+void paintHeatmapLabels(QPainter &painter, const QSize &size, int year) {
+  const HeatmapLayout layout = heatmapLayout(size);
+  const QDate columnStart = heatmapColumnStart(year);
+  QFont font = painter.font();
+  font.setPixelSize(10);
+  painter.save();
+  painter.setFont(font);
+  painter.setPen(kLabelColor);
+  const char *const weekdays[] = {"一", "三", "五"};
+  for (int i = 0; i < 3; ++i) {
+    QRectF row(0, layout.origin.y() + (i * 2) * layout.cell,
+               kWeekdayLabelWidth - 4, layout.cell);
+    painter.drawText(row, Qt::AlignRight | Qt::AlignVCenter,
+                     QString::fromUtf8(weekdays[i]));
+  }
+  for (int month = 1; month <= 12; ++month) {
+    int column = columnStart.daysTo(QDate(year, month, 1)) / 7;
+    painter.drawText(QPointF(layout.origin.x() + column * layout.cell,
+                             kMonthLabelHeight - 5),
+                     QString("%1月").arg(month));
+  }
+  painter.restore();
+}
+
+QImage renderHeatmap(const TileJob &job) {
+  OASIS_TRACE_SCOPE("HistoryChart::renderHeatmap");
+  QImage image = newTileImage(job.size, job.dpr);
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing);
+
+  const HistoryChartData &data = *job.data;
+  const int year = job.index;
+  const HeatmapLayout layout = heatmapLayout(job.size);
+  const QDate columnStart = heatmapColumnStart(year);
+  const double gap = qMax(1.0, layout.cell * 0.15);
+
+  painter.setPen(Qt::NoPen);
+  for (QDate day(year, 1, 1); day.year() == year; day = day.addDays(1)) {
+    int offset = data.firstDay.isValid() ? data.firstDay.daysTo(day) : -1;
+    qint32 total = offset >= 0 && offset < data.dayCount()
+                       ? data.dayTotals[offset]
+                       : 0;
+    int column = columnStart.daysTo(day) / 7;
+    int row = day.dayOfWeek() - 1;
+    QRectF cell(layout.origin.x() + column * layout.cell,
+                layout.origin.y() + row * layout.cell, layout.cell - gap,
+                layout.cell - gap);
+    painter.setBrush(heatmapColor(total, job.goal));
+    painter.drawRoundedRect(cell, gap, gap);
+  }
+  return image;
+}
+
+QImage renderTimeline(const TileJob &job) {
+  OASIS_TRACE_SCOPE("HistoryChart::renderTimeline");
+  QImage image = newTileImage(job.size, job.dpr);
+  QPainter painter(&image);
+
+  const HistoryChartData &data = *job.data;
+  const double ppd = levelPixelsPerDay(job.level);
+  const double x0 = static_cast<double>(job.index) * kTileWidth;
+  const double bottom = job.size.height() - kAxisHeight;
+  const double plotHeight = qMax(1.0, bottom - kPlotTop);
+  const int days = data.dayCount();
+
+  if (ppd >= kHourlyPixelsPerDay) {
+    // 每小时一根柱
+    const double pph = ppd / 24;
+    const double scale = plotHeight / qMax(1, data.maxHour);
+    qint64 firstHour = qMax<qint64>(0, qFloor(x0 / pph));
+    qint64 lastHour = qMin<qint64>(static_cast<qint64>(days) * 24,
+                                   qCeil((x0 + kTileWidth) / pph));
+    const double width = qMax(1.0, pph - 1);
+    for (qint64 hour = firstHour; hour < lastHour; ++hour) {
+      qint32 value = data.hourBins[hour];
+      if (value <= 0)
+        continue;
+      double height = value * scale;
+      painter.fillRect(QRectF(hour * pph - x0, bottom - height, width, height),
+                       kBarColor);
+    }
+    return image;
+  }
+
+  const double scale =
+      plotHeight / (qMax(data.maxDay, static_cast<qint32>(job.goal)) * 1.1);
+  if (ppd >= kDailyPixelsPerDay) {
+    // 每天一根柱
+    int firstDay = qMax(0, qFloor(x0 / ppd));
+    int lastDay = qMin(days, qCeil((x0 + kTileWidth) / ppd));
+    const double width = qMax(1.0, ppd - 1);
+    for (int day = firstDay; day < lastDay; ++day) {
+      double height = data.dayTotals[day] * scale;
+      painter.fillRect(QRectF(day * ppd - x0, bottom - height, width, height),
+                       kBarColor);
+    }
+  } else {
+    // 一列覆盖多天：只画该列的 min-max 区间和均值点
+    for (int column = 0; column < kTileWidth; ++column) {
+      int from = qMax(0, qFloor((x0 + column) / ppd));
+      int to = qMin(days, qFloor((x0 + column + 1) / ppd));
+      if (from >= to)
+        continue;
+      qint32 low = data.dayTotals[from];
+      qint32 high = low;
+      qint64 sum = 0;
+      for (int day = from; day < to; ++day) {
+        qint32 value = data.dayTotals[day];
+        low = qMin(low, value);
+        high = qMax(high, value);
+        sum += value;
+      }
+      double mean = static_cast<double>(sum) / (to - from);
+      painter.fillRect(QRectF(column, bottom - high * scale, 1,
+                              qMax(1.0, (high - low) * scale)),
+                       kRangeColor);
+      painter.fillRect(QRectF(column, bottom - mean * scale - 1, 1, 2),
+                       kBarColor);
+    }
+  }
+
+  if (job.goal > 0) {
+    painter.setPen(QPen(kGoalColor, 1, Qt::DashLine));
+    double y = bottom - job.goal * scale;
+    painter.drawLine(QPointF(0, y), QPointF(kTileWidth, y));
+  }
+  return image;
+}
+
+QImage renderTile(const TileJob &job) {
+  return job.kind == 0 ? renderHeatmap(job) : renderTimeline(job);
+}
+
+} // namespace
+
+HistoryChart::HistoryChart(const HistoryIndex *index, QWidget *parent)
+    : QWidget(parent), m_index(index), m_mode(Heatmap), m_goal(2000),
+      m_pool(new QThreadPool(this)), m_tiles(kTileBudgetKB), m_generation(0),
+      m_heatmapYear(Clock::instance()->today().year()), m_viewStart(0),
+      m_pixelsPerDay(0), m_dragging(false), m_dragStartX(0),
+      m_dragStartView(0) {
+  // 独立线程池，避免与历史回填争抢全局线程池
+  m_pool->setMaxThreadCount(2);
+  setMouseTracking(true);
+  setFocusPolicy(Qt::StrongFocus);
+  setMinimumSize(kTileWidth, 160);
+  reload();
+}
+
+HistoryChart::~HistoryChart() {
+  m_pool->clear();
+  m_pool->waitForDone();
+}
+
+void HistoryChart::setMode(Mode mode) {
+  if (mode == m_mode)
+    return;
+  m_mode = mode;
+  update();
+}
+
+void HistoryChart::setDailyGoal(int ml) {
+  if (ml == m_goal)
+    return;
+  m_goal = ml;
+  invalidateAll();
+}
+
+void HistoryChart::reload() {
+  OASIS_TRACE_SCOPE("HistoryChart::reload");
+  QSharedPointer<HistoryChartData> data(new HistoryChartData);
+  const int days = m_index->dayCount();
+  data->firstDay = m_index->firstDay();
+  data->dayTotals.resize(days);
+  data->hourBins.resize(days * 24);
+  if (days > 0) {
+    std::memcpy(data->dayTotals.data(), m_index->dayTotals(),
+                days * sizeof(qint32));
+    std::memcpy(data->hourBins.data(), m_index->hourBins(),
+                days * 24 * sizeof(qint32));
+  }
+  for (qint32 total : data->dayTotals)
+    data->maxDay = qMax(data->maxDay, total);
+  for (qint32 bin : data->hourBins)
+    data->maxHour = qMax(data->maxHour, bin);
+
+  QSharedPointer<const HistoryChartData> old = m_data;
+  m_data = data;
+  if (!old || old->firstDay != data->firstDay || old->maxDay != data->maxDay ||
+      old->maxHour != data->maxHour || days < old->dayCount()) {
+    invalidateAll();
+    return;
+  }
+
+  // 通常只有今天变化，只作废覆盖今天的瓦片
+  int changed = old->dayCount();
+  for (int day = 0; day < old->dayCount(); ++day) {
+    if (old->dayTotals[day] != data->dayTotals[day] ||
+        std::memcmp(old->hourBins.constData() + day * 24,
+                    data->hourBins.constData() + day * 24,
+                    24 * sizeof(qint32)) != 0) {
+      changed = day;
+      break;
+    }
+  }
+  if (changed < days)
+    invalidateFrom(data->firstDay.addDays(changed));
+}
+
+void HistoryChart::fitAll() {
+  if (!m_data || m_data->dayCount() == 0 || width() <= 0)
+    return;
+  m_pixelsPerDay = static_cast<double>(width()) / m_data->dayCount();
+  m_viewStart = 0;
+  clampView();
+  update();
+}
+
+void HistoryChart::invalidateAll() {
+  m_tiles.clear();
+  m_pending.clear();
+  ++m_generation;
+  update();
+}
+
+void HistoryChart::invalidateFrom(const QDate &day) {
+  for (const TileKey &key : m_tiles.keys()) {
+    bool stale;
+    if (key.kind == 0) {
+      stale = key.index >= day.year();
+    } else {
+      double endDay = (static_cast<double>(key.index) + 1) * kTileWidth /
+                      levelPixelsPerDay(key.level);
+      stale = m_data->firstDay.addDays(qCeil(endDay)) >= day;
+    }
+    if (stale)
+      m_tiles.remove(key);
+  }
+  m_pending.clear();
+  ++m_generation;
+  update();
+}
+
+const QImage *HistoryChart::tile(const TileKey &key) {
+  if (const QImage *image = m_tiles.object(key))
+    return image;
+  requestTile(key);
+  return nullptr;
+}
+
+void HistoryChart::requestTile(const TileKey &key) {
+  if (m_pending.contains(key) || m_tiles.contains(key))
+    return;
+  m_pending.insert(key);
+
+  TileJob job;
+  job.data = m_data;
+  job.kind = key.kind;
+  job.level = key.level;
+  job.index = key.index;
+  job.size = key.kind == 0 ? size() : QSize(kTileWidth, height());
+  job.dpr = devicePixelRatioF();
+  job.goal = m_goal;
+
+  const quint64 generation = m_generation;
+  QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(this);
+  connect(watcher, &QFutureWatcher<QImage>::finished, this,
+          [this, watcher, key, generation]() {
+            onTileRendered(key, generation, watcher->result());
+            watcher->deleteLater();
+          });
+  watcher->setFuture(QtConcurrent::run(m_pool, renderTile, job));
+}
+
+void HistoryChart::onTileRendered(const TileKey &key, quint64 generation,
+                                  const QImage &image) {
+  if (generation != m_generation)
+    return; // 渲染期间数据或尺寸已变化
+  m_pending.remove(key);
+  m_tiles.insert(key, new QImage(image),
+                 qMax(1, image.bytesPerLine() * image.height() / 1024));
+  update();
+}
+
+int HistoryChart::timelineLevel() const {
+  // 取不小于当前缩放的级别，贴图时只缩小不放大，保持清晰
+  return qBound(kMinLevel, qCeil(std::log2(m_pixelsPerDay)), kMaxLevel);
+}
+
+void HistoryChart::zoomAt(double x, double factor) {
+  double anchorDay = m_viewStart + x / m_pixelsPerDay;
+  m_pixelsPerDay =
+      qBound(levelPixelsPerDay(kMinLevel), m_pixelsPerDay * factor,
+             levelPixelsPerDay(kMaxLevel));
+  m_viewStart = anchorDay - x / m_pixelsPerDay;
+  clampView();
+  update();
+}
+
+void HistoryChart::clampView() {
+  int days = m_data ? m_data->dayCount() : 0;
+  double visibleDays = width() / m_pixelsPerDay;
+  // 两端各允许拖出半屏
+  m_viewStart = qBound(-visibleDays / 2, m_viewStart,
+                       qMax(-visibleDays / 2, days - visibleDays / 2));
+  if (days > 0)
+    emit visibleRangeChanged(
+        m_data->firstDay.addDays(qMax(0, qFloor(m_viewStart))),
+        m_data->firstDay.addDays(
+            qMin(days - 1, qCeil(m_viewStart + visibleDays))));
+}
+
+void HistoryChart::paintEvent(QPaintEvent *event) {
+  OASIS_TRACE_SCOPE("HistoryChart::paintEvent");
+  Q_UNUSED(event);
+  QPainter painter(this);
+  if (!m_data || m_data->dayCount() == 0) {
+    painter.setPen(kLabelColor);
+    painter.drawText(rect(), Qt::AlignCenter, "暂无历史记录");
+    return;
+  }
+  if (m_mode == Heatmap)
+    paintHeatmap(painter);
+  else
+    paintTimeline(painter);
+}
+
+void HistoryChart::paintHeatmap(QPainter &painter) {
+  TileKey key = {0, 0, m_heatmapYear};
+  if (const QImage *image = tile(key))
+    painter.drawImage(0, 0, *image);
+  paintHeatmapLabels(painter, size(), m_heatmapYear);
+
+  painter.setPen(kLabelColor);
+  painter.drawText(rect().adjusted(0, 0, -4, 0), Qt::AlignRight | Qt::AlignTop,
+                   QString("‹ %1 ›").arg(m_heatmapYear));
+
+  // 空闲时预渲染相邻年份
+  TileKey previous = {0, 0, m_heatmapYear - 1};
+  if (m_data->firstDay.year() <= previous.index)
+    requestTile(previous);
+  TileKey next = {0, 0, m_heatmapYear + 1};
+  if (next.index <= Clock::instance()->today().year())
+    requestTile(next);
+}
+
+void HistoryChart::showYear(int year) {
+  int firstYear = m_data && m_data->firstDay.isValid()
+                      ? m_data->firstDay.year()
+                      : m_heatmapYear;
+  int lastYear = Clock::instance()->today().year();
+  m_heatmapYear = qBound(qMin(firstYear, lastYear), year, lastYear);
+  update();
+}
+
+void HistoryChart::paintTimeline(QPainter &painter) {
+  if (m_pixelsPerDay <= 0)
+    return;
+  const int level = timelineLevel();
+  const double levelPpd = levelPixelsPerDay(level);
+  const double scale = m_pixelsPerDay / levelPpd; // (0.5, 1]
+  const double left = m_viewStart * levelPpd;     // 视口左端 (级别像素)
+  const int days = m_data->dayCount();
+
+  int firstTile = qFloor(left / kTileWidth);
+  int lastTile = qFloor((left + width() / scale) / kTileWidth);
+  painter.setRenderHint(QPainter::SmoothPixmapTransform, scale < 1.0);
+  for (int i = firstTile - 1; i <= lastTile + 1; ++i) {
+    // 只覆盖数据范围外的瓦片不必渲染
+    double startDay = static_cast<double>(i) * kTileWidth / levelPpd;
+    double endDay = (static_cast<double>(i) + 1) * kTileWidth / levelPpd;
+    if (endDay <= 0 || startDay >= days)
+      continue;
+
+    TileKey key = {1, level, i};
+    if (i < firstTile || i > lastTile) {
+      requestTile(key); // 两侧预取，平移时无需等待
+      continue;
+    }
+
+    QRectF target((i * kTileWidth - left) * scale, 0, kTileWidth * scale,
+                  height());
+    if (const QImage *image = tile(key)) {
+      painter.drawImage(target, *image);
+      continue;
+    }
+    // 尚未渲染完成：临时放大上一级 (更粗) 的瓦片。它也没有时一并请求，
+    // 粗瓦片像素少、通常先于本级完成
+    if (level > kMinLevel) {
+      TileKey coarse = {1, level - 1, qFloor(i / 2.0)};
+      if (const QImage *image = tile(coarse)) {
+        qreal dpr = image->devicePixelRatio();
+        int half = (i - coarse.index * 2) * kTileWidth / 2;
+        painter.drawImage(target, *image,
+                          QRectF(half * dpr, 0, kTileWidth / 2 * dpr,
+                                 image->height()));
+      }
+    }
+  }
+  paintTimelineAxis(painter);
+}
+
+void HistoryChart::paintTimelineAxis(QPainter &painter) {
+  const double visibleDays = width() / m_pixelsPerDay;
+  const QDate first = m_data->firstDay.addDays(qFloor(m_viewStart));
+  const QDate last = m_data->firstDay.addDays(qCeil(m_viewStart + visibleDays));
+  const int y = height() - kAxisHeight;
+
+  painter.setPen(kLabelColor);
+  painter.drawLine(0, y, width(), y);
+  auto tick = [&](const QDate &day, const QString &label) {
+    double x = (m_data->firstDay.daysTo(day) - m_viewStart) * m_pixelsPerDay;
+    painter.drawLine(QPointF(x, y), QPointF(x, y + 4));
+    painter.drawText(QPointF(x + 2, height() - 4), label);
+  };
+
+  // 标签间距至少约 40 像素
+  if (m_pixelsPerDay * 30 < 40) {
+    for (int year = first.year(); year <= last.year(); ++year)
+      tick(QDate(year, 1, 1), QString::number(year));
+  } else if (m_pixelsPerDay < 12) {
+    for (QDate month(first.year(), first.month(), 1); month <= last;
+         month = month.addMonths(1))
+      tick(month, month.month() == 1 ? QString::number(month.year())
+                                     : QString("%1月").arg(month.month()));
+  } else {
+    int step = m_pixelsPerDay >= 48 ? 1 : 7;
+    for (QDate day = first.addDays(step == 7 ? 1 - first.dayOfWeek() : 0);
+         day <= last; day = day.addDays(step))
+      tick(day, day.toString("M/d"));
+  }
+}
+
+void HistoryChart::resizeEvent(QResizeEvent *event) {
+  QWidget::resizeEvent(event);
+  if (m_pixelsPerDay <= 0 && width() > 0) {
+    // 首次显示最近 90 天
+    m_pixelsPerDay = width() / 90.0;
+    m_viewStart = (m_data ? m_data->dayCount() : 0) - 90;
+    clampView();
+  }
+  invalidateAll(); // 瓦片高度随控件变化
+}
+
+void HistoryChart::wheelEvent(QWheelEvent *event) {
+  double steps = event->angleDelta().y() / 120.0;
+  if (m_mode == Heatmap) {
+    if (steps != 0)
+      showYear(m_heatmapYear + (steps > 0 ? -1 : 1));
+  } else if (m_pixelsPerDay > 0) {
+    zoomAt(event->pos().x(), std::pow(1.25, steps));
+  }
+  event->accept();
+}
+
+void HistoryChart::mousePressEvent(QMouseEvent *event) {
+  if (m_mode == Timeline && event->button() == Qt::LeftButton) {
+    m_dragging = true;
+    m_dragStartX = event->pos().x();
+    m_dragStartView = m_viewStart;
+    setCursor(Qt::ClosedHandCursor);
+  }
+}
+
+void HistoryChart::mouseMoveEvent(QMouseEvent *event) {
+  if (m_dragging) {
+    m_viewStart =
+        m_dragStartView - (event->pos().x() - m_dragStartX) / m_pixelsPerDay;
+    clampView();
+    update();
+    return;
+  }
+  if (m_mode != Heatmap || !m_data || !m_data->firstDay.isValid())
+    return;
+
+  // 悬停提示当日饮水量
+  const HeatmapLayout layout = heatmapLayout(size());
+  int column = qFloor((event->pos().x() - layout.origin.x()) / layout.cell);
+  int row = qFloor((event->pos().y() - layout.origin.y()) / layout.cell);
+  QDate day = heatmapColumnStart(m_heatmapYear).addDays(column * 7 + row);
+  if (column < 0 || row < 0 || row > 6 || day.year() != m_heatmapYear) {
+    QToolTip::hideText();
+    return;
+  }
+  int offset = m_data->firstDay.daysTo(day);
+  qint32 total = offset >= 0 && offset < m_data->dayCount()
+                     ? m_data->dayTotals[offset]
+                     : 0;
+  QToolTip::showText(event->globalPos(),
+                     QString("%1  %2 ml")
+                         .arg(day.toString("yyyy-MM-dd"))
+                         .arg(total),
+                     this);
+}
+
+void HistoryChart::mouseReleaseEvent(QMouseEvent *event) {
+  Q_UNUSED(event);
+  if (m_dragging) {
+    m_dragging = false;
+    unsetCursor();
+  }
+}
+
+void HistoryChart::mouseDoubleClickEvent(QMouseEvent *event) {
+  Q_UNUSED(event);
+  if (m_mode == Timeline)
+    fitAll();
+}
+
+void HistoryChart::keyPressEvent(QKeyEvent *event) {
+  int direction = 0;
+  if (event->key() == Qt::Key_Left)
+    direction = -1;
+  else if (event->key() == Qt::Key_Right)
+    direction = 1;
+
+  if (m_mode == Heatmap && direction != 0) {
+    showYear(m_heatmapYear + direction);
+  } else if (m_mode == Timeline && direction != 0) {
+    m_viewStart += direction * width() / 4 / m_pixelsPerDay;
+    clampView();
+    update();
+  } else if (m_mode == Timeline && (event->key() == Qt::Key_Plus ||
+                                    event->key() == Qt::Key_Equal)) {
+    zoomAt(width() / 2.0, 1.25);
+  } else if (m_mode == Timeline && event->key() == Qt::Key_Minus) {
+    zoomAt(width() / 2.0, 0.8);
+  } else if (m_mode == Timeline && event->key() == Qt::Key_Home) {
+    fitAll();
+  } else {
+    QWidget::keyPressEvent(event);
+  }
+}
@@ -0,0 +1,97 @@
+#ifndef HISTORY_CHART_HPP
+#define HISTORY_CHART_HPP
+
+#include <QCache>
+#include <QDate>
+#include <QSet>
+#include <QSharedPointer>
+#include <QWidget>
+
+class HistoryIndex;
+class QThreadPool;
+struct HistoryChartData;
+
+// 历史饮水图表：年度日历热力图与可缩放的时间线。
+// 图形按瓦片在线程池中光栅化为 QImage 并缓存 (瓦片里不排版文字)，
+// GUI 线程绘制时只贴图并画上标签；
+// 时间线在每一级缩放下按像素列抽稀，每列最多画 min/max/均值三个点。
+class HistoryChart : public QWidget {
+  Q_OBJECT
+public:
+  enum Mode { Heatmap, Timeline };
+
+  explicit HistoryChart(const HistoryIndex *index, QWidget *parent = nullptr);
+  ~HistoryChart();
+
+  void setMode(Mode mode);
+  Mode mode() const { return m_mode; }
+  void setDailyGoal(int ml);
+
+public slots:
+  void reload(); // 从 HistoryIndex 重建数据快照，只作废受影响的瓦片
+  void fitAll();
+
+signals:
+  // 时间线视口平移或缩放后发出，列表和明细缓存据此同步与预取
+  void visibleRangeChanged(const QDate &first, const QDate &last);
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  void resizeEvent(QResizeEvent *event) override;
+  void wheelEvent(QWheelEvent *event) override;
+  void mousePressEvent(QMouseEvent *event) override;
+  void mouseMoveEvent(QMouseEvent *event) override;
+  void mouseReleaseEvent(QMouseEvent *event) override;
+  void mouseDoubleClickEvent(QMouseEvent *event) override;
+  void keyPressEvent(QKeyEvent *event) override;
+
+private:
+  // kind: 0 热力图 (index 为年份)，1 时间线 (level 为缩放级别)
+  struct TileKey {
+    int kind;
+    int level;
+    int index;
+    bool operator==(const TileKey &other) const {
+      return kind == other.kind && level == other.level &&
+             index == other.index;
+    }
+  };
+  friend uint qHash(const TileKey &key, uint seed) {
+    return qHash(key.kind, seed) ^ qHash(key.level, seed * 31) ^
+           qHash(key.index, seed * 131);
+  }
+
+  const QImage *tile(const TileKey &key); // 未缓存时发起异步渲染并返回空
+  void requestTile(const TileKey &key);
+  void onTileRendered(const TileKey &key, quint64 generation,
+                      const QImage &image);
+  void invalidateFrom(const QDate &day); // 作废包含 day 及以后的瓦片
+  void invalidateAll();
+
+  void paintHeatmap(QPainter &painter);
+  void showYear(int year);
+  void paintTimeline(QPainter &painter);
+  void paintTimelineAxis(QPainter &painter);
+  int timelineLevel() const;
+  void zoomAt(double x, double factor);
+  void clampView();
+
+  const HistoryIndex *m_index;
+  QSharedPointer<const HistoryChartData> m_data;
+  Mode m_mode;
+  int m_goal;
+
+  QThreadPool *m_pool;
+  QCache<TileKey, QImage> m_tiles; // 开销以 KB 计
+  QSet<TileKey> m_pending;
+  quint64 m_generation; // 数据、尺寸或目标变化时递增，丢弃过期结果
+
+  int m_heatmapYear;
+  double m_viewStart;   // 视口左端，距 firstDay 的天数
+  double m_pixelsPerDay;
+  bool m_dragging;
+  double m_dragStartX;
+  double m_dragStartView;
+};
+
+#endif // HISTORY_CHART_HPP
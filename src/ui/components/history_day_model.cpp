@@ -0,0 +1,130 @@
+#include "history_day_model.hpp"
+#include "../../core/history_block_cache.hpp"
+#include "../../core/history_index.hpp"
+#include <QStringList>
+#include <algorithm>
+#include <functional>
+
+namespace {
+const int kMaxListedRecords = 8; // 每行最多列出的记录数
+} // namespace
+
+HistoryDayModel::HistoryDayModel(const HistoryIndex *index,
+                                 HistoryBlockCache *cache, QObject *parent)
+    : QAbstractListModel(parent), m_index(index), m_cache(cache) {
+  connect(m_cache, &HistoryBlockCache::blockReady, this,
+          &HistoryDayModel::onBlockReady);
+}
+
+int HistoryDayModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : m_days.size();
+}
+
+QDate HistoryDayModel::dayAt(int row) const {
+  if (row < 0 || row >= m_days.size())
+    return QDate();
+  return m_index->firstDay().addDays(m_days[row]);
+}
+
+int HistoryDayModel::rowForDay(const QDate &day) const {
+  if (m_days.isEmpty() || !day.isValid())
+    return -1;
+  const int offset = int(m_index->firstDay().daysTo(day));
+  int row = int(std::lower_bound(m_days.constBegin(), m_days.constEnd(),
+                                 offset, std::greater<int>()) -
+                m_days.constBegin());
+  return qMin(row, m_days.size() - 1);
+}
+
+QVariant HistoryDayModel::data(const QModelIndex &index, int role) const {
+  if (role != Qt::DisplayRole || !index.isValid())
+    return QVariant();
+  const QDate day = dayAt(index.row());
+  const int total = m_index->dayTotals()[m_days[index.row()]];
+  QString text = QString("%1   %2 ml")
+                     .arg(day.toString("yyyy-MM-dd ddd"))
+                     .arg(total);
+
+  // 重绘会反复调用 data()，每周只在首次显示或块被淘汰后
+  // 才向缓存正式索取，命中统计按块计而不是按重绘计
+  const qint64 week = HistoryBlockCache::weekStartOf(day).toJulianDay();
+  HistoryBlockCache::BlockPtr block = m_cache->cached(day);
+  if (!block || !m_wanted.contains(week)) {
+    block = m_cache->block(day);
+    m_wanted.insert(week);
+  }
+  if (!block)
+    return text + "   加载中…";
+
+  int from = 0;
+  int to = 0;
+  block->dayRange(day, &from, &to);
+  QStringList items;
+  for (int i = from; i < to && items.size() < kMaxListedRecords; ++i) {
+    DrinkRecordView record = block->records.at(i);
+    items << QString("%1 %2")
+                 .arg(record.timestamp().toString("HH:mm"))
+                 .arg(record.amount());
+  }
+  if (to - from > kMaxListedRecords)
+    items << "…";
+  return items.isEmpty() ? text : text + "   " + items.join("  ·  ");
+}
+
+void HistoryDayModel::reload() {
+  beginResetModel();
+  m_firstDay = m_index->firstDay();
+  m_days.clear();
+  m_wanted.clear();
+  const qint32 *totals = m_index->dayTotals();
+  for (int i = m_index->dayCount() - 1; i >= 0; --i) {
+    if (totals[i] > 0)
+      m_days.append(i);
+  }
+  endResetModel();
+}
+
+void HistoryDayModel::updateDay(const QDate &day) {
+  // 首日前移后所有偏移都变了，只能整体重建
+  if (m_index->firstDay() != m_firstDay) {
+    reload();
+    return;
+  }
+  const int offset = int(m_firstDay.daysTo(day));
+  if (offset < 0 || offset >= m_index->dayCount())
+    return;
+  const int row = int(std::lower_bound(m_days.constBegin(), m_days.constEnd(),
+                                       offset, std::greater<int>()) -
+                      m_days.constBegin());
+  const bool listed = row < m_days.size() && m_days[row] == offset;
+  const bool hasDrinks = m_index->dayTotals()[offset] > 0;
+  if (listed && hasDrinks) {
+    emit dataChanged(index(row), index(row),
+                     QVector<int>() << Qt::DisplayRole);
+  } else if (hasDrinks) {
+    beginInsertRows(QModelIndex(), row, row);
+    m_days.insert(row, offset);
+    endInsertRows();
+  } else if (listed) {
+    beginRemoveRows(QModelIndex(), row, row);
+    m_days.remove(row);
+    endRemoveRows();
+  }
+}
+
+void HistoryDayModel::onBlockReady(const QDate &weekStart) {
+  if (m_days.isEmpty())
+    return;
+  const int first = int(m_index->firstDay().daysTo(weekStart));
+  const int last = first + HistoryBlockCache::kBlockDays - 1;
+  // 行按日期降序，先找到本周最后一天，再找到本周之前的第一行
+  int top = int(std::lower_bound(m_days.constBegin(), m_days.constEnd(), last,
+                                 std::greater<int>()) -
+                m_days.constBegin());
+  int bottom = int(std::lower_bound(m_days.constBegin(), m_days.constEnd(),
+                                    first - 1, std::greater<int>()) -
+                   m_days.constBegin());
+  if (top < bottom)
+    emit dataChanged(index(top), index(bottom - 1),
+                     QVector<int>() << Qt::DisplayRole);
+}
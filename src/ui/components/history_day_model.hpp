@@ -0,0 +1,42 @@
+#ifndef HISTORY_DAY_MODEL_HPP
+#define HISTORY_DAY_MODEL_HPP
+
+#include <QAbstractListModel>
+#include <QDate>
+#include <QSet>
+#include <QVector>
+
+class HistoryBlockCache;
+class HistoryIndex;
+
+// 每日明细列表：行为有饮水的日期 (新的在前)，总量取自 HistoryIndex，
+// 当天的逐条记录向 HistoryBlockCache 按需索取，块加载完成后刷新对应行。
+class HistoryDayModel : public QAbstractListModel {
+  Q_OBJECT
+public:
+  HistoryDayModel(const HistoryIndex *index, HistoryBlockCache *cache,
+                  QObject *parent = nullptr);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override;
+
+  QDate dayAt(int row) const;
+  int rowForDay(const QDate &day) const; // 不晚于 day 的最近一行
+
+public slots:
+  void reload();
+  // 只更新某一天的行 (刷新或插入)，不重置模型，列表的滚动与选中保持不变
+  void updateDay(const QDate &day);
+
+private:
+  void onBlockReady(const QDate &weekStart);
+
+  const HistoryIndex *m_index;
+  HistoryBlockCache *m_cache;
+  QDate m_firstDay;     // reload 时的 firstDay，m_days 以它为基准
+  QVector<int> m_days; // 距 firstDay 的天数，降序
+  mutable QSet<qint64> m_wanted; // 已向缓存索取过的周 (儒略日)
+};
+
+#endif // HISTORY_DAY_MODEL_HPP
@@ -0,0 +1,100 @@
+#include "dbus_notification_channel.hpp"
+#include "../core/logging.hpp"
+#include "../core/warming_copy.hpp"
+#include "popup_widget.hpp"
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QVariantMap>
+
+namespace {
+const char kService[] = "org.freedesktop.Notifications";
+const char kPath[] = "/org/freedesktop/Notifications";
+const char kInterface[] = "org.freedesktop.Notifications";
+const int kExpireTimeoutMs = 30000; // 与自绘弹窗的自动隐藏一致
+} // namespace
+
+DBusNotificationChannel::DBusNotificationChannel(QObject *parent)
+    : ReminderChannel(parent), m_lastId(0), m_fallback(nullptr) {
+  QDBusConnection bus = QDBusConnection::sessionBus();
+  // 不限定发送方，便于用替身守护进程或 gdbus emit 调试；按通知 id 过滤
+  bus.connect(QString(), kPath, kInterface, "ActionInvoked", this,
+              SLOT(onActionInvoked(uint, QString)));
+  bus.connect(QString(), kPath, kInterface, "NotificationClosed", this,
+              SLOT(onNotificationClosed(uint, uint)));
+}
+
+bool DBusNotificationChannel::isServiceAvailable() {
+  return QDBusConnection::sessionBus().isConnected();
+}
+
+void DBusNotificationChannel::deliver(int drinkAmount, int style) {
+  QDBusMessage message =
+      QDBusMessage::createMethodCall(kService, kPath, kInterface, "Notify");
+
+  QVariantMap hints;
+  hints.insert("urgency", QVariant::fromValue<uchar>(1)); // normal
+  hints.insert("desktop-entry", QString("oasis"));
+
+  message << QString("Oasis") << m_lastId << QString("oasis")
+          << WarmingCopy::title(style) << WarmingCopy::getRandomCopy(style)
+          << (QStringList() << "confirm" << WarmingCopy::confirmText(style)
+                            << "delay" << WarmingCopy::delayText(style))
+          << hints << kExpireTimeoutMs;
+
+  QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(
+      QDBusConnection::sessionBus().asyncCall(message), this);
+  watcher->setProperty("drinkAmount", drinkAmount);
+  watcher->setProperty("style", style);
+  connect(watcher, &QDBusPendingCallWatcher::finished, this,
+          &DBusNotificationChannel::onNotifyFinished);
+}
+
+void DBusNotificationChannel::onNotifyFinished(
+    QDBusPendingCallWatcher *watcher) {
+  watcher->deleteLater();
+  QDBusPendingReply<uint> reply = *watcher;
+  if (reply.isError()) {
+    qCWarning(lcNotify) << "桌面通知发送失败，改用弹窗:"
+                        << reply.error().message();
+    fallback()->deliver(watcher->property("drinkAmount").toInt(),
+                        watcher->property("style").toInt());
+    return;
+  }
+
+  m_pending.remove(m_lastId);
+  m_lastId = reply.value();
+  m_pending.insert(m_lastId, watcher->property("drinkAmount").toInt());
+}
+
+void DBusNotificationChannel::onActionInvoked(uint id,
+                                              const QString &actionKey) {
+  if (!m_pending.contains(id))
+    return;
+  int ml = m_pending.take(id);
+  if (actionKey == "confirm")
+    emit drinkConfirmed(ml);
+
+  // 部分守护进程点击按钮后不会自动关闭通知
+  QDBusMessage close = QDBusMessage::createMethodCall(
+      kService, kPath, kInterface, "CloseNotification");
+  close << id;
+  QDBusConnection::sessionBus().asyncCall(close);
+}
+
+void DBusNotificationChannel::onNotificationClosed(uint id, uint reason) {
+  Q_UNUSED(reason); // 超时、用户关闭或被替换，处理方式相同
+  m_pending.remove(id);
+  if (id == m_lastId)
+    m_lastId = 0;
+}
+
+ReminderChannel *DBusNotificationChannel::fallback() {
+  if (!m_fallback) {
+    m_fallback = new PopupChannel<PopupWidget>("widget", this);
+    connect(m_fallback, &ReminderChannel::drinkConfirmed, this,
+            &ReminderChannel::drinkConfirmed);
+  }
+  return m_fallback;
+}
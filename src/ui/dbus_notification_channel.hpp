@@ -0,0 +1,34 @@
+#ifndef DBUS_NOTIFICATION_CHANNEL_HPP
+#define DBUS_NOTIFICATION_CHANNEL_HPP
+
+#include "reminder_channel.hpp"
+#include <QHash>
+
+class QDBusPendingCallWatcher;
+
+// 通过 org.freedesktop.Notifications 发送桌面原生通知。Notify 为异步调用，
+// 通知守护进程再慢也不会阻塞事件循环；调用失败时退回自绘弹窗。
+class DBusNotificationChannel : public ReminderChannel {
+  Q_OBJECT
+public:
+  explicit DBusNotificationChannel(QObject *parent = nullptr);
+
+  static bool isServiceAvailable(); // 会话总线是否可用
+
+  QString name() const override { return "dbus"; }
+  void deliver(int drinkAmount, int style) override;
+
+private slots:
+  void onNotifyFinished(QDBusPendingCallWatcher *watcher);
+  void onActionInvoked(uint id, const QString &actionKey);
+  void onNotificationClosed(uint id, uint reason);
+
+private:
+  ReminderChannel *fallback();
+
+  uint m_lastId;               // 新提醒替换上一条，避免堆积
+  QHash<uint, int> m_pending;  // 通知 id -> 饮水量
+  ReminderChannel *m_fallback; // 按需创建
+};
+
+#endif // DBUS_NOTIFICATION_CHANNEL_HPP
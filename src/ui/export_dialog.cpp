@@ -0,0 +1,178 @@
+#include "export_dialog.hpp"
+#include "../core/clock.hpp"
+#include "../core/history_exporter.hpp"
+#include "../core/history_store.hpp"
+#include <QApplication>
+#include <QComboBox>
+#include <QDateEdit>
+#include <QDesktopWidget>
+#include <QDir>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QScopedPointer>
+#include <QThread>
+#include <QVBoxLayout>
+
+ExportDialog::ExportDialog(const QString &historyBackend, QWidget *parent)
+    : QWidget(parent), m_backend(historyBackend), m_thread(new QThread(this)),
+      m_exporter(new HistoryExporter("logs", historyBackend)) {
+  setObjectName("SettingsWidget"); // 复用设置中心的背景样式
+  setWindowTitle("导出饮水记录");
+  setFixedSize(420, 300);
+
+  QVBoxLayout *mainLayout = new QVBoxLayout(this);
+  mainLayout->setContentsMargins(24, 16, 24, 24);
+  mainLayout->setSpacing(12);
+
+  QFormLayout *form = new QFormLayout();
+
+  m_fromEdit = new QDateEdit(this);
+  m_fromEdit->setCalendarPopup(true);
+  m_fromEdit->setDisplayFormat("yyyy-MM-dd");
+  m_toEdit = new QDateEdit(this);
+  m_toEdit->setCalendarPopup(true);
+  m_toEdit->setDisplayFormat("yyyy-MM-dd");
+
+  QHBoxLayout *rangeLayout = new QHBoxLayout();
+  rangeLayout->addWidget(m_fromEdit);
+  rangeLayout->addWidget(new QLabel("至"));
+  rangeLayout->addWidget(m_toEdit);
+  form->addRow("日期区间:", rangeLayout);
+
+  m_formatCombo = new QComboBox(this);
+  m_formatCombo->addItem("CSV (.csv)", HistoryExporter::Csv);
+  m_formatCombo->addItem("JSON Lines (.jsonl)", HistoryExporter::JsonLines);
+  form->addRow("导出格式:", m_formatCombo);
+
+  m_pathEdit = new QLineEdit(this);
+  QPushButton *browseBtn = new QPushButton("浏览...", this);
+  QHBoxLayout *pathLayout = new QHBoxLayout();
+  pathLayout->addWidget(m_pathEdit);
+  pathLayout->addWidget(browseBtn);
+  form->addRow("保存到:", pathLayout);
+
+  m_progressBar = new QProgressBar(this);
+  m_progressBar->setRange(0, 1);
+  m_progressBar->setValue(0);
+
+  m_statusLabel = new QLabel(this);
+  m_statusLabel->setWordWrap(true);
+
+  m_startBtn = new QPushButton("开始导出", this);
+  m_startBtn->setFixedHeight(40);
+
+  mainLayout->addLayout(form);
+  mainLayout->addWidget(m_progressBar);
+  mainLayout->addWidget(m_statusLabel);
+  mainLayout->addStretch();
+  mainLayout->addWidget(m_startBtn);
+
+  connect(browseBtn, &QPushButton::clicked, this, &ExportDialog::browse);
+  connect(m_startBtn, &QPushButton::clicked, this,
+          &ExportDialog::startOrCancel);
+
+  // 导出器常驻工作线程，GUI 线程只接收进度
+  m_exporter->moveToThread(m_thread);
+  connect(m_thread, &QThread::finished, m_exporter, &QObject::deleteLater);
+  connect(m_exporter, &HistoryExporter::progress, this,
+          &ExportDialog::onProgress);
+  connect(m_exporter, &HistoryExporter::finished, this,
+          &ExportDialog::onFinished);
+  m_thread->start();
+
+  setRunning(false);
+}
+
+ExportDialog::~ExportDialog() {
+  m_exporter->cancel();
+  m_thread->quit();
+  m_thread->wait();
+}
+
+void ExportDialog::browse() {
+  bool jsonl = m_formatCombo->currentData().toInt() == HistoryExporter::JsonLines;
+  QString path = QFileDialog::getSaveFileName(
+      this, "导出饮水记录", m_pathEdit->text(),
+      jsonl ? "JSON Lines (*.jsonl)" : "CSV (*.csv)");
+  if (!path.isEmpty())
+    m_pathEdit->setText(path);
+}
+
+void ExportDialog::startOrCancel() {
+  if (!m_startBtn->property("running").toBool()) {
+    QString path = m_pathEdit->text().trimmed();
+    if (path.isEmpty()) {
+      m_statusLabel->setText("请先选择保存位置");
+      return;
+    }
+    QDate from = m_fromEdit->date();
+    QDate to = m_toEdit->date();
+    HistoryExporter::Format format = static_cast<HistoryExporter::Format>(
+        m_formatCombo->currentData().toInt());
+
+    setRunning(true);
+    m_statusLabel->setText("正在导出...");
+    HistoryExporter *exporter = m_exporter;
+    exporter->resetCancel();
+    QMetaObject::invokeMethod(
+        exporter, [=]() { exporter->run(from, to, path, format); },
+        Qt::QueuedConnection);
+  } else {
+    m_exporter->cancel();
+  }
+}
+
+void ExportDialog::onProgress(int doneDays, int totalDays) {
+  m_progressBar->setRange(0, qMax(1, totalDays));
+  m_progressBar->setValue(doneDays);
+}
+
+void ExportDialog::onFinished(bool ok, qint64 records, const QString &error) {
+  setRunning(false);
+  if (ok) {
+    m_progressBar->setValue(m_progressBar->maximum());
+    m_statusLabel->setText(QString("导出完成，共 %1 条记录").arg(records));
+  } else {
+    m_statusLabel->setText(QString("导出失败: %1").arg(error));
+  }
+}
+
+void ExportDialog::setRunning(bool running) {
+  m_startBtn->setProperty("running", running);
+  m_startBtn->setText(running ? "取消导出" : "开始导出");
+  m_fromEdit->setEnabled(!running);
+  m_toEdit->setEnabled(!running);
+  m_formatCombo->setEnabled(!running);
+  m_pathEdit->setEnabled(!running);
+}
+
+void ExportDialog::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+
+  // 默认导出全部历史
+  if (!m_startBtn->property("running").toBool()) {
+    QScopedPointer<HistoryStore> store(HistoryStore::open(m_backend));
+    QList<QDate> days = store->availableDays();
+    QDate today = Clock::instance()->today();
+    m_fromEdit->setDate(days.isEmpty() ? today : days.first());
+    m_toEdit->setDate(today);
+    if (m_pathEdit->text().isEmpty())
+      m_pathEdit->setText(QDir::home().filePath(
+          QString("oasis-%1.csv").arg(today.toString("yyyyMMdd"))));
+    m_progressBar->setValue(0);
+    m_statusLabel->clear();
+  }
+
+  QRect desktop = QApplication::desktop()->availableGeometry();
+  move((desktop.width() - width()) / 2, (desktop.height() - height()) / 2);
+}
+
+void ExportDialog::closeEvent(QCloseEvent *event) {
+  m_exporter->cancel();
+  QWidget::closeEvent(event);
+}
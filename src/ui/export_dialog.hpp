@@ -0,0 +1,49 @@
+#ifndef EXPORT_DIALOG_HPP
+#define EXPORT_DIALOG_HPP
+
+#include <QWidget>
+
+class HistoryExporter;
+class QComboBox;
+class QDateEdit;
+class QLabel;
+class QLineEdit;
+class QProgressBar;
+class QPushButton;
+class QThread;
+
+// 导出饮水记录：选择日期区间、格式与目标文件，在工作线程中流式导出
+class ExportDialog : public QWidget {
+  Q_OBJECT
+public:
+  explicit ExportDialog(const QString &historyBackend = "text",
+                        QWidget *parent = nullptr);
+  ~ExportDialog();
+
+protected:
+  void showEvent(QShowEvent *event) override;
+  void closeEvent(QCloseEvent *event) override;
+
+private slots:
+  void browse();
+  void startOrCancel();
+  void onProgress(int doneDays, int totalDays);
+  void onFinished(bool ok, qint64 records, const QString &error);
+
+private:
+  void setRunning(bool running);
+
+  QDateEdit *m_fromEdit;
+  QDateEdit *m_toEdit;
+  QComboBox *m_formatCombo;
+  QLineEdit *m_pathEdit;
+  QProgressBar *m_progressBar;
+  QLabel *m_statusLabel;
+  QPushButton *m_startBtn;
+
+  QString m_backend;
+  QThread *m_thread;
+  HistoryExporter *m_exporter;
+};
+
+#endif // EXPORT_DIALOG_HPP
@@ -0,0 +1,145 @@
+#include "history_widget.hpp"
+#include "../core/history_block_cache.hpp"
+#include "../core/history_index.hpp"
+#include "../core/settings_manager.hpp"
+#include "components/history_chart.hpp"
+#include "components/history_day_model.hpp"
+#include <QButtonGroup>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QListView>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QVBoxLayout>
+
+namespace {
+// 时间线缩放到这个跨度以内时才预取明细，概览级别用不到逐条记录
+const int kMaxPrefetchDays = 8 * HistoryBlockCache::kBlockDays;
+} // namespace
+
+HistoryWidget::HistoryWidget(HistoryIndex *history, SettingsManager *settings,
+                             QWidget *parent)
+    : QWidget(parent), m_settings(settings),
+      m_cache(new HistoryBlockCache(settings->historyBackend(), "logs", this)),
+      m_lastScroll(0) {
+  setObjectName("SettingsWidget"); // 复用设置中心的背景样式
+  setWindowTitle("历史趋势");
+  resize(760, 480);
+
+  QVBoxLayout *mainLayout = new QVBoxLayout(this);
+  mainLayout->setContentsMargins(24, 16, 24, 24);
+  mainLayout->setSpacing(12);
+
+  QPushButton *heatmapBtn = new QPushButton("热力图", this);
+  QPushButton *timelineBtn = new QPushButton("时间线", this);
+  heatmapBtn->setCheckable(true);
+  timelineBtn->setCheckable(true);
+  heatmapBtn->setChecked(true);
+
+  QButtonGroup *modeGroup = new QButtonGroup(this);
+  modeGroup->addButton(heatmapBtn, HistoryChart::Heatmap);
+  modeGroup->addButton(timelineBtn, HistoryChart::Timeline);
+
+  m_hintLabel = new QLabel(this);
+  m_hintLabel->setStyleSheet("font-size: 11px;");
+
+  QHBoxLayout *toolbar = new QHBoxLayout();
+  toolbar->addWidget(heatmapBtn);
+  toolbar->addWidget(timelineBtn);
+  toolbar->addStretch();
+  toolbar->addWidget(m_hintLabel);
+
+  m_chart = new HistoryChart(history, this);
+
+  m_cache->setBudget(settings->historyCacheBudgetKb());
+  m_dayModel = new HistoryDayModel(history, m_cache, this);
+  m_dayList = new QListView(this);
+  m_dayList->setModel(m_dayModel);
+  m_dayList->setUniformItemSizes(true);
+  m_dayList->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+  mainLayout->addLayout(toolbar);
+  mainLayout->addWidget(m_chart, 3);
+  mainLayout->addWidget(m_dayList, 2);
+
+  connect(modeGroup,
+          static_cast<void (QButtonGroup::*)(int)>(&QButtonGroup::buttonClicked),
+          this, &HistoryWidget::setMode);
+  // 新的饮水只作废覆盖今天的瓦片和本周的明细块
+  connect(history, &HistoryIndex::updated, m_chart, &HistoryChart::reload);
+  connect(history, &HistoryIndex::updated, this,
+          &HistoryWidget::onDrinkRecorded);
+  connect(m_dayList->verticalScrollBar(), &QScrollBar::valueChanged, this,
+          &HistoryWidget::onListScrolled);
+  connect(m_chart, &HistoryChart::visibleRangeChanged, this,
+          &HistoryWidget::onChartRangeChanged);
+
+  setMode(HistoryChart::Heatmap);
+}
+
+void HistoryWidget::refresh() {
+  // 同步合并等可能改写任意一周，明细块全部作废
+  m_cache->setBudget(m_settings->historyCacheBudgetKb());
+  m_cache->clear();
+  m_chart->setDailyGoal(m_settings->dailyGoal());
+  m_chart->reload();
+  m_dayModel->reload();
+}
+
+void HistoryWidget::onDrinkRecorded(const QDate &day) {
+  m_cache->invalidate(day);
+  m_dayModel->updateDay(day);
+}
+
+void HistoryWidget::onListScrolled(int value) {
+  const bool down = value >= m_lastScroll;
+  m_lastScroll = value;
+  QModelIndex top = m_dayList->indexAt(QPoint(0, 0));
+  if (!top.isValid())
+    return;
+  QModelIndex bottom =
+      m_dayList->indexAt(QPoint(0, m_dayList->viewport()->height() - 1));
+  const int lastRow =
+      bottom.isValid() ? bottom.row() : m_dayModel->rowCount() - 1;
+  const int page = lastRow - top.row() + 1;
+
+  // 沿滚动方向预取下一屏；行按日期降序，向下即更早的日期
+  const int from = down ? lastRow + 1 : top.row() - page;
+  const int to = down ? lastRow + page : top.row() - 1;
+  for (int row = qMax(0, from); row <= to; ++row) {
+    QDate day = m_dayModel->dayAt(row);
+    if (!day.isValid())
+      break;
+    m_cache->prefetch(day);
+  }
+}
+
+void HistoryWidget::onChartRangeChanged(const QDate &first,
+                                        const QDate &last) {
+  if (m_chart->mode() != HistoryChart::Timeline)
+    return;
+  // 列表跟随时间线，视口最右端的日期置顶
+  int row = m_dayModel->rowForDay(last);
+  if (row >= 0)
+    m_dayList->scrollTo(m_dayModel->index(row),
+                        QAbstractItemView::PositionAtTop);
+  if (first.daysTo(last) <= kMaxPrefetchDays)
+    m_cache->prefetchRange(first.addDays(-HistoryBlockCache::kBlockDays),
+                           last.addDays(HistoryBlockCache::kBlockDays));
+}
+
+void HistoryWidget::setMode(int mode) {
+  m_chart->setMode(static_cast<HistoryChart::Mode>(mode));
+  m_hintLabel->setText(mode == HistoryChart::Heatmap
+                           ? "滚轮或 ←/→ 切换年份，悬停查看当日饮水量"
+                           : "滚轮缩放，拖动平移，双击查看全部");
+  m_chart->setFocus();
+}
+
+void HistoryWidget::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  // 隐藏期间的新饮水已逐条作废，明细缓存可以沿用
+  m_chart->setDailyGoal(m_settings->dailyGoal());
+  m_chart->reload();
+  m_dayModel->reload();
+}
@@ -0,0 +1,43 @@
+#ifndef HISTORY_WIDGET_HPP
+#define HISTORY_WIDGET_HPP
+
+#include <QDate>
+#include <QWidget>
+
+class HistoryBlockCache;
+class HistoryChart;
+class HistoryDayModel;
+class HistoryIndex;
+class QLabel;
+class QListView;
+class SettingsManager;
+
+// 历史趋势窗口：年度热力图与可缩放时间线，下方为每日明细列表
+class HistoryWidget : public QWidget {
+  Q_OBJECT
+public:
+  explicit HistoryWidget(HistoryIndex *history, SettingsManager *settings,
+                         QWidget *parent = nullptr);
+
+public slots:
+  void refresh(); // 数据或目标变化后调用
+
+protected:
+  void showEvent(QShowEvent *event) override;
+
+private:
+  void setMode(int mode);
+  void onDrinkRecorded(const QDate &day);
+  void onListScrolled(int value);
+  void onChartRangeChanged(const QDate &first, const QDate &last);
+
+  SettingsManager *m_settings;
+  HistoryBlockCache *m_cache;
+  HistoryChart *m_chart;
+  HistoryDayModel *m_dayModel;
+  QListView *m_dayList;
+  QLabel *m_hintLabel;
+  int m_lastScroll;
+};
+
+#endif // HISTORY_WIDGET_HPP
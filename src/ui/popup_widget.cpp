@@ -1,16 +1,20 @@
 #include "popup_widget.hpp"
+#include "../core/metrics.hpp"
+#include "../core/trace.hpp"
 #include "../core/warming_copy.hpp"
 #include <QApplication>
 #include <QDebug>
-#include <QDesktopWidget>
 #include <QEasingCurve>
 #include <QGraphicsDropShadowEffect>
+#include <QGuiApplication>
 #include <QMouseEvent>
 #include <QPainterPath>
+#include <QScreen>
 #include <QVBoxLayout>
 
 PopupWidget::PopupWidget(QWidget *parent)
-    : QWidget(parent), m_opacity(0.0), m_drinkAmount(250), m_reminderStyle(0) {
+    : QWidget(parent), m_opacity(0.0), m_drinkAmount(250), m_reminderStyle(0),
+      m_awaitingFirstFrame(false), m_prewarmed(false) {
 
   // 设置基础窗口属性
   setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::Tool);
@@ -26,6 +30,13 @@ PopupWidget::PopupWidget(QWidget *parent)
 
   setupUi();
   setupAnimations();
+
+  // 屏幕布局变化时刷新缓存的几何信息
+  connect(qApp, &QGuiApplication::primaryScreenChanged, this,
+          &PopupWidget::updateScreenGeometry);
+  updateScreenGeometry();
+
+  QTimer::singleShot(0, this, &PopupWidget::prewarm);
 }
 
 PopupWidget::~PopupWidget() {}
@@ -84,6 +95,8 @@ void PopupWidget::setupAnimations() {
 }
 
 void PopupWidget::setOpacity(qreal opacity) {
+  // m_fadeAnimation 每一帧都会调用这里
+  OASIS_TRACE_SCOPE("PopupWidget::fadeFrame");
   m_opacity = opacity;
   setWindowOpacity(opacity);
 }
@@ -91,53 +104,64 @@ void PopupWidget::setOpacity(qreal opacity) {
 qreal PopupWidget::opacity() const { return m_opacity; }
 
 void PopupWidget::setDrinkAmount(int ml) {
+  // 按钮文案由 prewarm 按风格统一设置，这里只记录饮水量
   m_drinkAmount = ml;
-  if (m_confirmBtn) {
-    m_confirmBtn->setText(m_reminderStyle == 1 ? "执行命令" : "好哒");
-  }
 }
 
 void PopupWidget::setReminderStyle(int style) {
+  // 每次提醒都会重新设置风格，未变化时保留预热结果
+  if (style == m_reminderStyle)
+    return;
   m_reminderStyle = style;
-  if (style == 1) {
-    if (m_titleLabel)
-      m_titleLabel->setText("独立团团部公告箱");
-    if (m_delayBtn)
-      m_delayBtn->setText("待会儿再说");
-  } else if (style == 2) {
-    if (m_titleLabel)
-      m_titleLabel->setText("【摸鱼办】紧急通知");
-    if (m_delayBtn)
-      m_delayBtn->setText("再卷一会儿");
-  } else if (style == 3) {
-    if (m_titleLabel)
-      m_titleLabel->setText("【陈塘关第一混世魔王】");
-    if (m_delayBtn)
-      m_delayBtn->setText("爷就不喝");
-  } else {
-    if (m_titleLabel)
-      m_titleLabel->setText("[干一杯]~(￣▽￣)~*");
-    if (m_delayBtn)
-      m_delayBtn->setText("等会儿");
-  }
+  m_titleLabel->setText(WarmingCopy::title(style));
+  m_delayBtn->setText(WarmingCopy::delayText(style));
+
+  m_prewarmed = false;
+  if (!isVisible())
+    QTimer::singleShot(0, this, &PopupWidget::prewarm);
 }
 
-void PopupWidget::showAnimated() {
+void PopupWidget::updateScreenGeometry() {
+  QScreen *screen = QGuiApplication::primaryScreen();
+  if (!screen)
+    return;
+  m_screenGeometry = screen->availableGeometry();
+  connect(screen, &QScreen::availableGeometryChanged, this,
+          &PopupWidget::updateScreenGeometry, Qt::UniqueConnection);
+}
+
+void PopupWidget::prewarm() {
+  if (m_prewarmed || isVisible())
+    return;
+  OASIS_TRACE_SCOPE("PopupWidget::prewarm");
+
   m_contentLabel->setText(WarmingCopy::getRandomCopy(m_reminderStyle));
+  m_confirmBtn->setText(confirmText());
+
+  // 提前完成样式计算、文字排版与布局
+  ensurePolished();
+  if (layout())
+    layout()->activate();
+  m_contentLabel->heightForWidth(m_contentLabel->width());
+  // 提前创建原生窗口，显示时无需再与窗口系统往返
+  winId();
 
-  if (m_reminderStyle == 1) {
-    m_confirmBtn->setText("执行命令");
-  } else if (m_reminderStyle == 2) {
-    m_confirmBtn->setText("带薪喝水");
-  } else if (m_reminderStyle == 3) {
-    m_confirmBtn->setText("去他爷的，喝！");
-  } else {
-    m_confirmBtn->setText("好哒");
+  m_prewarmed = true;
+}
+
+void PopupWidget::showAnimated() {
+  if (!isVisible()) {
+    m_showLatency.start();
+    m_awaitingFirstFrame = true;
   }
+
+  // 预热被跳过 (例如启动后立即触发) 时退回同步准备
+  prewarm();
+  m_prewarmed = false;
+
   // 定位到屏幕中央以达到强制提醒的目的
-  QRect desktop = QApplication::desktop()->availableGeometry();
-  int x = (desktop.width() - width()) / 2;
-  int y = (desktop.height() - height()) / 2;
+  int x = m_screenGeometry.x() + (m_screenGeometry.width() - width()) / 2;
+  int y = m_screenGeometry.y() + (m_screenGeometry.height() - height()) / 2;
   move(x, y);
 
   m_fadeAnimation->stop();
@@ -157,6 +181,7 @@ void PopupWidget::hideAnimated() {
 }
 
 void PopupWidget::paintEvent(QPaintEvent *event) {
+  OASIS_TRACE_SCOPE("PopupWidget::paintEvent");
   Q_UNUSED(event);
   QPainter painter(this);
   painter.setRenderHint(QPainter::Antialiasing);
@@ -194,6 +219,18 @@ void PopupWidget::paintEvent(QPaintEvent *event) {
   painter.setBrush(QColor(167, 185, 164, 250));       // #A7B9A4 莫兰迪豆沙绿
   painter.setPen(QPen(QColor(255, 255, 255, 60), 1)); // 极淡白边框
   painter.drawRoundedRect(contentRect, radius, radius);
+
+  if (m_awaitingFirstFrame) {
+    m_awaitingFirstFrame = false;
+    Metrics::registry().popupLatency.observe(m_showLatency.nsecsElapsed() /
+                                             1e9);
+  }
+}
+
+void PopupWidget::hideEvent(QHideEvent *event) {
+  QWidget::hideEvent(event);
+  // 隐藏后回到空闲状态，为下一次提醒做准备
+  QTimer::singleShot(0, this, &PopupWidget::prewarm);
 }
 
 void PopupWidget::mousePressEvent(QMouseEvent *event) {
@@ -1,6 +1,7 @@
 #ifndef POPUP_WIDGET_HPP
 #define POPUP_WIDGET_HPP
 
+#include <QElapsedTimer>
 #include <QGraphicsDropShadowEffect>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -27,6 +28,11 @@ public:
   void setOpacity(qreal opacity);
   qreal opacity() const;
 
+public slots:
+  // 空闲时预先选好下一条文案并完成样式、布局与屏幕几何计算，
+  // 让 showAnimated 只剩 move/show/开始动画
+  void prewarm();
+
 signals:
   void drinkConfirmed(int ml);
 
@@ -34,10 +40,13 @@ protected:
   void paintEvent(QPaintEvent *event) override;
   void mousePressEvent(QMouseEvent *event) override;
   void mouseMoveEvent(QMouseEvent *event) override;
+  void hideEvent(QHideEvent *event) override;
 
 private:
   void setupUi();
   void setupAnimations();
+  void updateScreenGeometry();
+  QString confirmText() const;
 
   QPoint m_dragPosition;
   qreal m_opacity;
@@ -46,6 +55,11 @@ private:
   int m_drinkAmount;
   int m_reminderStyle;
 
+  QElapsedTimer m_showLatency; // 触发到首帧的耗时
+  bool m_awaitingFirstFrame;
+  bool m_prewarmed;
+  QRect m_screenGeometry; // 缓存的可用桌面区域
+
   // UI Elements
   QLabel *m_titleLabel;
   QLabel *m_contentLabel;
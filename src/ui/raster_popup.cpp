@@ -0,0 +1,309 @@
+#include "raster_popup.hpp"
+#include "../core/metrics.hpp"
+#include "../core/trace.hpp"
+#include "../core/warming_copy.hpp"
+#include <QEasingCurve>
+#include <QGuiApplication>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPainterPath>
+#include <QScreen>
+#include <QTimer>
+#include <QVariantAnimation>
+#include <QtMath>
+
+namespace {
+const int kWidth = 400;
+const int kHeight = 225;
+const int kShadowSize = 12;
+const int kRadius = 8;
+const int kMargin = 24; // 与 PopupWidget 的布局边距一致
+const int kSpacing = 12;
+const int kButtonHeight = 34;
+const int kButtonPadding = 16;
+const int kButtonRadius = 12;
+
+QFont popupFont(int pixelSize, bool bold) {
+  QFont font = QGuiApplication::font();
+  font.setPixelSize(pixelSize);
+  font.setBold(bold);
+  return font;
+}
+
+const QFont &titleFont() {
+  static const QFont font = popupFont(18, true);
+  return font;
+}
+
+const QFont &contentFont() {
+  static const QFont font = popupFont(14, false);
+  return font;
+}
+
+const QFont &buttonFont() {
+  static const QFont font = popupFont(14, true);
+  return font;
+}
+} // namespace
+
+RasterPopup::RasterPopup(QWindow *parent)
+    : QRasterWindow(parent), m_drinkAmount(250), m_reminderStyle(0),
+      m_prewarmed(false), m_hovered(NoButton), m_pressed(NoButton),
+      m_dragging(false), m_awaitingFirstFrame(false) {
+  setFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::Tool |
+           Qt::WindowDoesNotAcceptFocus);
+
+  QSurfaceFormat format;
+  format.setAlphaBufferSize(8); // 圆角与阴影需要透明背景
+  setFormat(format);
+
+  setMinimumSize(QSize(kWidth, kHeight));
+  setMaximumSize(QSize(kWidth, kHeight));
+  resize(kWidth, kHeight);
+
+  m_title.setTextFormat(Qt::PlainText);
+  m_content.setTextFormat(Qt::PlainText);
+  m_content.setTextWidth(kWidth - 2 * kMargin);
+  m_confirmText.setTextFormat(Qt::PlainText);
+  m_delayText.setTextFormat(Qt::PlainText);
+
+  // 不回弹的缓动，透明度始终在 [0, 1] 内；只改窗口透明度，由合成器完成混合，
+  // 动画帧之间不需要重绘
+  m_fadeAnimation = new QVariantAnimation(this);
+  m_fadeAnimation->setDuration(200);
+  m_fadeAnimation->setEasingCurve(QEasingCurve::OutCubic);
+  connect(m_fadeAnimation, &QVariantAnimation::valueChanged, this,
+          [this](const QVariant &value) {
+            OASIS_TRACE_SCOPE("RasterPopup::fadeFrame");
+            setOpacity(qBound(0.0, value.toReal(), 1.0));
+          });
+  connect(m_fadeAnimation, &QVariantAnimation::finished, this, [this]() {
+    if (opacity() == 0.0)
+      hide();
+  });
+
+  m_autoHideTimer = new QTimer(this);
+  m_autoHideTimer->setSingleShot(true);
+  m_autoHideTimer->setInterval(30000); // 30 秒
+  connect(m_autoHideTimer, &QTimer::timeout, this, &RasterPopup::hideAnimated);
+
+  applyStyleTexts();
+  QTimer::singleShot(0, this, &RasterPopup::prewarm);
+}
+
+void RasterPopup::setDrinkAmount(int ml) { m_drinkAmount = ml; }
+
+void RasterPopup::setReminderStyle(int style) {
+  if (style == m_reminderStyle)
+    return;
+  m_reminderStyle = style;
+  m_prewarmed = false;
+  applyStyleTexts();
+  if (!isVisible())
+    QTimer::singleShot(0, this, &RasterPopup::prewarm);
+}
+
+void RasterPopup::applyStyleTexts() {
+  m_title.setText(WarmingCopy::title(m_reminderStyle));
+  m_confirmText.setText(WarmingCopy::confirmText(m_reminderStyle));
+  m_delayText.setText(WarmingCopy::delayText(m_reminderStyle));
+}
+
+void RasterPopup::prewarm() {
+  if (m_prewarmed || isVisible())
+    return;
+  OASIS_TRACE_SCOPE("RasterPopup::prewarm");
+
+  m_content.setText(WarmingCopy::getRandomCopy(m_reminderStyle));
+
+  // 提前完成文字排版，绘制时只需贴字形
+  m_title.prepare(QTransform(), titleFont());
+  m_content.prepare(QTransform(), contentFont());
+  m_confirmText.prepare(QTransform(), buttonFont());
+  m_delayText.prepare(QTransform(), buttonFont());
+  layoutButtons();
+  create();
+
+  m_prewarmed = true;
+}
+
+void RasterPopup::layoutButtons() {
+  const int top = kHeight - kMargin - kButtonHeight;
+  int confirmWidth =
+      qCeil(m_confirmText.size().width()) + 2 * kButtonPadding;
+  int delayWidth = qCeil(m_delayText.size().width()) + 2 * kButtonPadding;
+
+  m_confirmRect =
+      QRect(kWidth - kMargin - confirmWidth, top, confirmWidth, kButtonHeight);
+  m_delayRect = QRect(m_confirmRect.left() - kSpacing / 2 - delayWidth, top,
+                      delayWidth, kButtonHeight);
+}
+
+void RasterPopup::showAnimated() {
+  if (!isVisible()) {
+    m_showLatency.start();
+    m_awaitingFirstFrame = true;
+  }
+
+  prewarm();
+  m_prewarmed = false;
+
+  // 定位到屏幕中央以达到强制提醒的目的
+  QScreen *target = screen() ? screen() : QGuiApplication::primaryScreen();
+  if (target) {
+    QRect desktop = target->availableGeometry();
+    setPosition(desktop.x() + (desktop.width() - kWidth) / 2,
+                desktop.y() + (desktop.height() - kHeight) / 2);
+  }
+
+  m_fadeAnimation->stop();
+  if (!isVisible())
+    setOpacity(0.0);
+  show();
+  fadeTo(1.0);
+  m_autoHideTimer->start();
+}
+
+void RasterPopup::hideAnimated() {
+  m_autoHideTimer->stop();
+  fadeTo(0.0);
+}
+
+void RasterPopup::fadeTo(qreal target) {
+  m_fadeAnimation->stop();
+  m_fadeAnimation->setStartValue(opacity());
+  m_fadeAnimation->setEndValue(target);
+  m_fadeAnimation->start();
+}
+
+void RasterPopup::paintEvent(QPaintEvent *event) {
+  OASIS_TRACE_SCOPE("RasterPopup::paintEvent");
+  Q_UNUSED(event);
+  QPainter painter(this);
+  painter.setCompositionMode(QPainter::CompositionMode_Source);
+  painter.fillRect(QRect(0, 0, kWidth, kHeight), Qt::transparent);
+  painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+  painter.setRenderHint(QPainter::Antialiasing);
+
+  // 阴影与主体，配色与 PopupWidget 相同
+  QRectF outerRect(0, 0, kWidth, kHeight);
+  QRectF contentRect = outerRect.adjusted(kShadowSize, kShadowSize,
+                                          -kShadowSize, -kShadowSize);
+  QPainterPath shadowPath;
+  shadowPath.addRoundedRect(outerRect, kRadius + kShadowSize / 2,
+                            kRadius + kShadowSize / 2);
+  QPainterPath contentPath;
+  contentPath.addRoundedRect(contentRect, kRadius, kRadius);
+
+  QRadialGradient gradient(contentRect.center(), kShadowSize * 1.5);
+  gradient.setColorAt(0, QColor(40, 60, 40, 80));
+  gradient.setColorAt(0.7, QColor(40, 60, 40, 40));
+  gradient.setColorAt(1, QColor(40, 60, 40, 0));
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(gradient);
+  painter.drawPath(shadowPath.subtracted(contentPath));
+
+  painter.setBrush(QColor(167, 185, 164, 250)); // #A7B9A4 莫兰迪豆沙绿
+  painter.setPen(QPen(QColor(255, 255, 255, 60), 1));
+  painter.drawRoundedRect(contentRect, kRadius, kRadius);
+
+  // 文字
+  painter.setFont(titleFont());
+  painter.setPen(QColor(255, 255, 255));
+  painter.drawStaticText(kMargin, kMargin, m_title);
+
+  painter.setFont(contentFont());
+  painter.setPen(QColor(245, 245, 245));
+  painter.drawStaticText(
+      kMargin, kMargin + qCeil(m_title.size().height()) + kSpacing, m_content);
+
+  // 按钮
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(m_hovered == DelayButton ? QColor(255, 255, 255, 102)
+                                            : QColor(255, 255, 255, 76));
+  painter.drawRoundedRect(m_delayRect, kButtonRadius, kButtonRadius);
+  painter.setBrush(m_hovered == ConfirmButton ? QColor(255, 255, 255)
+                                              : QColor(245, 245, 245));
+  painter.drawRoundedRect(m_confirmRect, kButtonRadius, kButtonRadius);
+
+  painter.setFont(buttonFont());
+  painter.setPen(Qt::white);
+  painter.drawStaticText(
+      m_delayRect.x() + kButtonPadding,
+      m_delayRect.y() + (kButtonHeight - qCeil(m_delayText.size().height())) / 2,
+      m_delayText);
+  painter.setPen(QColor(167, 185, 164));
+  painter.drawStaticText(
+      m_confirmRect.x() + kButtonPadding,
+      m_confirmRect.y() +
+          (kButtonHeight - qCeil(m_confirmText.size().height())) / 2,
+      m_confirmText);
+
+  if (m_awaitingFirstFrame) {
+    m_awaitingFirstFrame = false;
+    Metrics::registry().popupLatency.observe(m_showLatency.nsecsElapsed() /
+                                             1e9);
+  }
+}
+
+RasterPopup::Button RasterPopup::buttonAt(const QPoint &pos) const {
+  if (m_confirmRect.contains(pos))
+    return ConfirmButton;
+  if (m_delayRect.contains(pos))
+    return DelayButton;
+  return NoButton;
+}
+
+void RasterPopup::setHovered(Button button) {
+  if (button == m_hovered)
+    return;
+  m_hovered = button;
+  if (button == NoButton)
+    unsetCursor();
+  else
+    setCursor(Qt::PointingHandCursor);
+  update();
+}
+
+void RasterPopup::mousePressEvent(QMouseEvent *event) {
+  if (event->button() != Qt::LeftButton)
+    return;
+  m_pressed = buttonAt(event->pos());
+  if (m_pressed == NoButton) {
+    m_dragging = true;
+    m_dragPosition = event->globalPos() - position();
+  }
+  event->accept();
+}
+
+void RasterPopup::mouseMoveEvent(QMouseEvent *event) {
+  if (m_dragging && (event->buttons() & Qt::LeftButton)) {
+    setPosition(event->globalPos() - m_dragPosition);
+  } else {
+    setHovered(buttonAt(event->pos()));
+  }
+  event->accept();
+}
+
+void RasterPopup::mouseReleaseEvent(QMouseEvent *event) {
+  if (event->button() != Qt::LeftButton)
+    return;
+  Button released = buttonAt(event->pos());
+  Button pressed = m_pressed;
+  m_pressed = NoButton;
+  m_dragging = false;
+
+  if (released == NoButton || released != pressed)
+    return;
+  if (released == ConfirmButton)
+    emit drinkConfirmed(m_drinkAmount);
+  hideAnimated();
+}
+
+void RasterPopup::hideEvent(QHideEvent *event) {
+  QRasterWindow::hideEvent(event);
+  m_hovered = NoButton;
+  m_pressed = NoButton;
+  m_dragging = false;
+  QTimer::singleShot(0, this, &RasterPopup::prewarm);
+}
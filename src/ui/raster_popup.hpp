@@ -0,0 +1,69 @@
+#ifndef RASTER_POPUP_HPP
+#define RASTER_POPUP_HPP
+
+#include <QElapsedTimer>
+#include <QRasterWindow>
+#include <QStaticText>
+
+class QTimer;
+class QVariantAnimation;
+
+// 轻量提醒弹窗：单个 QRasterWindow，文字与按钮直接绘制并自行命中测试，
+// 没有子控件、布局和样式表。与 PopupWidget 对外接口一致。
+class RasterPopup : public QRasterWindow {
+  Q_OBJECT
+
+public:
+  explicit RasterPopup(QWindow *parent = nullptr);
+
+  void showAnimated();
+  void hideAnimated();
+  void setDrinkAmount(int ml);
+  void setReminderStyle(int style);
+
+public slots:
+  void prewarm();
+
+signals:
+  void drinkConfirmed(int ml);
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  void mousePressEvent(QMouseEvent *event) override;
+  void mouseMoveEvent(QMouseEvent *event) override;
+  void mouseReleaseEvent(QMouseEvent *event) override;
+  void hideEvent(QHideEvent *event) override;
+
+private:
+  enum Button { NoButton, ConfirmButton, DelayButton };
+
+  void applyStyleTexts();
+  void layoutButtons();
+  Button buttonAt(const QPoint &pos) const;
+  void setHovered(Button button);
+  void fadeTo(qreal target);
+
+  int m_drinkAmount;
+  int m_reminderStyle;
+  bool m_prewarmed;
+
+  QStaticText m_title;
+  QStaticText m_content;
+  QStaticText m_confirmText;
+  QStaticText m_delayText;
+  QRect m_confirmRect;
+  QRect m_delayRect;
+  Button m_hovered;
+  Button m_pressed;
+
+  QPoint m_dragPosition;
+  bool m_dragging;
+
+  QVariantAnimation *m_fadeAnimation;
+  QTimer *m_autoHideTimer;
+
+  QElapsedTimer m_showLatency;
+  bool m_awaitingFirstFrame;
+};
+
+#endif // RASTER_POPUP_HPP
@@ -0,0 +1,22 @@
+#include "reminder_channel.hpp"
+#include "../core/logging.hpp"
+#include "popup_widget.hpp"
+#include "raster_popup.hpp"
+
+#ifdef OASIS_HAVE_DBUS
+#include "dbus_notification_channel.hpp"
+#endif
+
+ReminderChannel *ReminderChannel::create(const QString &backend,
+                                         QObject *parent) {
+  if (backend == "dbus") {
+#ifdef OASIS_HAVE_DBUS
+    if (DBusNotificationChannel::isServiceAvailable())
+      return new DBusNotificationChannel(parent);
+#endif
+    qCWarning(lcNotify) << "会话总线不可用，改用弹窗提醒";
+  }
+  if (backend == "raster")
+    return new PopupChannel<RasterPopup>("raster", parent);
+  return new PopupChannel<PopupWidget>("widget", parent);
+}
@@ -0,0 +1,48 @@
+#ifndef REMINDER_CHANNEL_HPP
+#define REMINDER_CHANNEL_HPP
+
+#include <QObject>
+#include <QString>
+
+// 提醒的送达方式。main 只依赖这一接口：deliver 展示一次提醒，
+// 用户确认喝水时发出 drinkConfirmed(ml)。
+class ReminderChannel : public QObject {
+  Q_OBJECT
+public:
+  explicit ReminderChannel(QObject *parent = nullptr) : QObject(parent) {}
+
+  virtual QString name() const = 0;
+  virtual void deliver(int drinkAmount, int style) = 0;
+
+  // backend: "widget" (默认)、"raster" 或 "dbus"
+  static ReminderChannel *create(const QString &backend,
+                                 QObject *parent = nullptr);
+
+signals:
+  void drinkConfirmed(int ml);
+};
+
+// 以自绘窗口送达：PopupWidget 或 RasterPopup
+template <typename Popup> class PopupChannel : public ReminderChannel {
+public:
+  PopupChannel(const QString &name, QObject *parent = nullptr)
+      : ReminderChannel(parent), m_name(name), m_popup(new Popup()) {
+    connect(m_popup, &Popup::drinkConfirmed, this,
+            &ReminderChannel::drinkConfirmed);
+  }
+  ~PopupChannel() { delete m_popup; }
+
+  QString name() const override { return m_name; }
+
+  void deliver(int drinkAmount, int style) override {
+    m_popup->setDrinkAmount(drinkAmount);
+    m_popup->setReminderStyle(style);
+    m_popup->showAnimated();
+  }
+
+private:
+  QString m_name;
+  Popup *m_popup; // 顶层窗口，没有 QObject 父对象
+};
+
+#endif // REMINDER_CHANNEL_HPP
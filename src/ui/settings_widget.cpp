@@ -15,7 +15,7 @@ SettingsWidget::SettingsWidget(SettingsManager *settings, QWidget *parent)
 
   setObjectName("SettingsWidget");
   setWindowTitle("Oasis (干一杯) 设置");
-  setFixedSize(420, 780); // 增加窗口高度以确保第5行完全显示
+  setFixedSize(420, 830); // 增加窗口高度以确保第5行完全显示
 
   QVBoxLayout *mainLayout = new QVBoxLayout(this);
   mainLayout->setContentsMargins(24, 16, 24, 24); // 减少顶部边距，让内容往上移
@@ -77,6 +77,12 @@ SettingsWidget::SettingsWidget(SettingsManager *settings, QWidget *parent)
 
   basicLayout->addRow("", m_autoStartCheck);
 
+  QPushButton *exportBtn = new QPushButton("导出饮水记录...", this);
+  exportBtn->setObjectName("delay"); // 次要操作使用暖色按钮
+  connect(exportBtn, &QPushButton::clicked, this,
+          &SettingsWidget::exportRequested);
+  basicLayout->addRow("历史数据:", exportBtn);
+
   // 提醒设置部分
   QGroupBox *reminderGroup = new QGroupBox("提醒逻辑", this);
   QVBoxLayout *reminderLayout = new QVBoxLayout(reminderGroup);
@@ -22,6 +22,7 @@ protected:
 
 signals:
   void settingsChanged();
+  void exportRequested();
 
 private slots:
   void saveSettings();
@@ -0,0 +1,262 @@
+#include "soak.hpp"
+#include "../core/clock.hpp"
+#include "../core/drink_ingest.hpp"
+#include "../core/history_index.hpp"
+#include "../core/hydration_analytics.hpp"
+#include "../core/plant_model.hpp"
+#include "../core/plant_system.hpp"
+#include "../core/reminder_engine.hpp"
+#include "../core/settings_manager.hpp"
+#include "history_widget.hpp"
+#include "reminder_channel.hpp"
+#include "settings_widget.hpp"
+#include "stats_widget.hpp"
+#include "weekly_report.hpp"
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QScopedPointer>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QThread>
+
+namespace {
+
+// 与模拟相同的起点 (周一零点)，同一参数每次走过的路径相同
+const QDate kStartDay(2025, 1, 6);
+const int kStepMinutes = 15;
+const int kReportTimeoutMs = 10000;
+
+qint64 toKb(qint64 bytes) { return bytes / 1024; }
+
+} // namespace
+
+namespace Soak {
+
+Options::Options()
+    : days(90), warmupDays(7), objectSlack(4), heapSlackKb(256),
+      rssSlackKb(8192) {}
+
+Report::Report()
+    : reminders(0), drinks(0), refreshes(0), settingsChanges(0),
+      weeklyReports(0), elapsedMs(0) {}
+
+Report run(const Options &options) {
+  Report report;
+  QElapsedTimer wallClock;
+  wallClock.start();
+  if (options.days <= options.warmupDays) {
+    report.failures << "天数须大于预热天数";
+    return report;
+  }
+
+  QTemporaryDir sandbox;
+  if (!sandbox.isValid()) {
+    report.failures << "无法创建临时目录";
+    return report;
+  }
+  if (!ObjectCensus::install()) {
+    report.failures << "当前 Qt 版本不支持对象钩子";
+    return report;
+  }
+  const QString previousDir = QDir::currentPath();
+  QDir::setCurrent(sandbox.path());
+  QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope,
+                     sandbox.path());
+  QSettings::setPath(QSettings::IniFormat, QSettings::UserScope,
+                     sandbox.path());
+
+  const qint64 startMSecs =
+      QDateTime(kStartDay, QTime(0, 0)).toMSecsSinceEpoch();
+  VirtualClock clock(startMSecs);
+  Clock::setInstance(&clock);
+  report.days.reserve(options.days);
+
+  {
+    // 按 main 的方式装配，只是植物系统留在当前线程 (虚拟时钟只能单线程用)
+    SettingsManager settings;
+    settings.setReminderInterval(45);
+    settings.setDNDRange(QTime(23, 0), QTime(8, 0));
+    settings.setDNDEnabled(true);
+
+    ReminderEngine engine;
+    PlantSystem plant(settings.historyBackend());
+    plant.recordGoalChange(settings.dailyGoal());
+    DrinkIngest *ingest = new DrinkIngest(&plant);
+
+    HistoryIndex index("logs");
+    HydrationAnalytics analytics;
+    auto goalForDay = [&](const QDate &day) {
+      int goal = plant.snapshot()->goalOn(day);
+      return goal > 0 ? goal : settings.dailyGoal();
+    };
+    analytics.rebuild(&index, clock.today(), goalForDay);
+    QObject::connect(&plant, &PlantSystem::drinkRecorded, &index,
+                     &HistoryIndex::recordDrink);
+    QObject::connect(&plant, &PlantSystem::drinkRecorded, &analytics,
+                     &HydrationAnalytics::recordDrink);
+    QObject::connect(&plant, &PlantSystem::dayRolledOver, &analytics,
+                     &HydrationAnalytics::rollOver);
+
+    QScopedPointer<ReminderChannel> channel(
+        ReminderChannel::create(settings.popupBackend()));
+    StatsWidget stats(&plant, &settings, &index, &analytics);
+    HistoryWidget history(&index, &settings);
+    SettingsWidget settingsWidget(&settings);
+    WeeklyReportRenderer reports("reports");
+
+    // 每隔一次提醒用户点「好哒」，其余的提醒被忽略。点击按弹窗确认
+    // 的路径直接提交给汇入队列，不代替弹窗发出它的信号
+    QObject::connect(&engine, &ReminderEngine::reminderTriggered, [&]() {
+      ++report.reminders;
+      channel->deliver(settings.drinkAmount(), settings.reminderStyle());
+      if (report.reminders % 2 == 0) {
+        ++report.drinks;
+        ingest->submit(settings.drinkAmount(), DrinkIngest::Popup);
+      }
+    });
+
+    int pendingReports = 0;
+    QObject::connect(&reports, &WeeklyReportRenderer::reportReady,
+                     [&](const QDate &, const QString &path, bool) {
+                       --pendingReports;
+                       QLabel *view = new QLabel();
+                       view->setAttribute(Qt::WA_DeleteOnClose);
+                       view->setPixmap(QPixmap(path));
+                       view->show();
+                     });
+    QObject::connect(&reports, &WeeklyReportRenderer::reportFailed,
+                     [&](const QDate &weekStart, const QString &error) {
+                       --pendingReports;
+                       report.failures << QString("%1 周报生成失败: %2")
+                                              .arg(weekStart.toString(
+                                                  Qt::ISODate))
+                                              .arg(error);
+                     });
+
+    auto applySettings = [&]() {
+      engine.setInterval(settings.reminderInterval());
+      engine.setDNDRange(settings.dndStart(), settings.dndEnd());
+      engine.setDNDEnabled(settings.isDNDEnabled());
+      plant.recordGoalChange(settings.dailyGoal());
+      analytics.setDailyGoal(settings.dailyGoal());
+      stats.refresh();
+      history.refresh();
+    };
+
+    engine.setInterval(settings.reminderInterval());
+    engine.setDNDRange(settings.dndStart(), settings.dndEnd());
+    engine.setDNDEnabled(settings.isDNDEnabled());
+    engine.start();
+
+    for (int d = 0; d < options.days; ++d) {
+      const QDate day = kStartDay.addDays(d);
+      const qint64 dayStart = startMSecs + d * 24LL * 3600 * 1000;
+
+      // 周一生成上周的周报
+      if (d > 0 && day.dayOfWeek() == 1) {
+        WeeklyReportData data;
+        data.fillWeek(&index, day.addDays(-7), goalForDay);
+        // 与 main 一样取上周日结束时的连续天数与植物状态
+        const QDate sunday = day.addDays(-1);
+        data.streak = analytics.streakOn(sunday);
+        PlantSystem::PlantStatus status =
+            plant.statusAt(QDateTime(sunday, QTime(23, 59, 59)));
+        data.plantIcon = PlantModel::statusIcon(status);
+        data.plantStatus = PlantModel::statusName(status);
+        ++pendingReports;
+        ++report.weeklyReports;
+        reports.request(data);
+      }
+
+      for (int minute = kStepMinutes; minute <= 24 * 60;
+           minute += kStepMinutes) {
+        clock.advanceTo(dayStart + minute * 60000LL);
+        QCoreApplication::processEvents();
+        if (minute == 10 * 60) {
+          // 托盘快捷补水
+          ++report.drinks;
+          ingest->submit(settings.drinkAmount(), DrinkIngest::Tray);
+        } else if (minute == 12 * 60) {
+          stats.show();
+          stats.refresh();
+          ++report.refreshes;
+        } else if (minute == 18 * 60) {
+          history.show();
+          history.refresh();
+          ++report.refreshes;
+        } else if (minute == 20 * 60 && d % 3 == 2) {
+          // 改目标与提醒间隔，和在设置窗口里保存一样
+          settingsWidget.show();
+          settings.setDailyGoal(settings.dailyGoal() == 2000 ? 2200 : 2000);
+          settings.setReminderInterval(
+              settings.reminderInterval() == 45 ? 60 : 45);
+          applySettings();
+          ++report.settingsChanges;
+        }
+      }
+
+      QElapsedTimer waited;
+      waited.start();
+      while (pendingReports > 0 && waited.elapsed() < kReportTimeoutMs)
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 50);
+      if (pendingReports > 0) {
+        report.failures << QString("%1 周报渲染超时")
+                               .arg(day.toString(Qt::ISODate));
+        break;
+      }
+
+      // 一天结束：用户关掉所有窗口，等后台加载与延迟删除都处理完再采样
+      for (QWidget *window : QApplication::topLevelWidgets()) {
+        if (window->isVisible())
+          window->close();
+      }
+      for (int i = 0; i < 3; ++i) {
+        QThread::msleep(2);
+        QCoreApplication::processEvents();
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+      }
+
+      ObjectCensus::Sample sample = ObjectCensus::take();
+      DayStats today = {sample.liveObjects, sample.rssBytes, sample.heapBytes};
+      report.days.append(today);
+      if (d + 1 == options.warmupDays)
+        report.baseline = sample;
+      report.last = sample;
+    }
+    engine.stop();
+  }
+
+  Clock::setInstance(nullptr);
+  QDir::setCurrent(previousDir);
+  ObjectCensus::uninstall();
+
+  if (report.days.size() == options.days) {
+    const QList<QPair<QByteArray, int> > grown =
+        ObjectCensus::growth(report.baseline, report.last);
+    for (const QPair<QByteArray, int> &item : grown) {
+      if (item.second > options.objectSlack)
+        report.failures << QString("%1 存活对象增加 %2 个")
+                               .arg(QString::fromLatin1(item.first))
+                               .arg(item.second);
+    }
+    const qint64 heapGrowth =
+        toKb(report.last.heapBytes - report.baseline.heapBytes);
+    if (heapGrowth > options.heapSlackKb)
+      report.failures << QString("预热后堆内存增长 %1 KB，上限 %2 KB")
+                             .arg(heapGrowth)
+                             .arg(options.heapSlackKb);
+    const qint64 rssGrowth =
+        toKb(report.last.rssBytes - report.baseline.rssBytes);
+    if (rssGrowth > options.rssSlackKb)
+      report.failures << QString("预热后 RSS 增长 %1 KB，上限 %2 KB")
+                             .arg(rssGrowth)
+                             .arg(options.rssSlackKb);
+  }
+
+  report.elapsedMs = wallClock.elapsed();
+  return report;
+}
+
+} // namespace Soak
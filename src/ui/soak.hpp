@@ -0,0 +1,53 @@
+#ifndef SOAK_HPP
+#define SOAK_HPP
+
+#include "../core/object_census.hpp"
+#include <QStringList>
+#include <QVector>
+
+// 长时间运行的耐久测试：在 VirtualClock 上用与 main 相同的组件快进数月，
+// 每天照常提醒、弹窗、喝水、刷新统计与历史窗口、修改设置并生成周报。
+// 每天结束时关闭所有窗口，统计存活 QObject、RSS 与堆内存；预热期之后
+// 任何类的存活数或内存持续增长都算失败。需要 QApplication，没有显示器时
+// 使用 offscreen 平台。数据写入临时目录，一个进程只应运行一次。
+namespace Soak {
+
+struct Options {
+  Options();
+
+  int days;
+  int warmupDays;  // 预热期末的采样作为基线，缓存与索引在此之前填满
+  int objectSlack; // 每个类允许的存活数增长 (后台加载中的临时对象)
+  int heapSlackKb;
+  int rssSlackKb;
+};
+
+// 每天结束时的一次采样
+struct DayStats {
+  int liveObjects;
+  qint64 rssBytes;
+  qint64 heapBytes;
+};
+
+struct Report {
+  Report();
+
+  QVector<DayStats> days;
+  ObjectCensus::Sample baseline;
+  ObjectCensus::Sample last; // 最后一天
+  int reminders;
+  int drinks;
+  int refreshes;
+  int settingsChanges;
+  int weeklyReports;
+  qint64 elapsedMs; // 实际耗时
+  QStringList failures;
+
+  bool ok() const { return failures.isEmpty(); }
+};
+
+Report run(const Options &options);
+
+} // namespace Soak
+
+#endif // SOAK_HPP
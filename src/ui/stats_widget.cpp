@@ -1,19 +1,26 @@
 #include "stats_widget.hpp"
+#include "../core/clock.hpp"
+#include "../core/history_query.hpp"
+#include "../core/plant_model.hpp"
+#include "../core/trace.hpp"
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QGraphicsDropShadowEffect>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPushButton>
+#include <QTimer>
 #include <QVBoxLayout>
 
 StatsWidget::StatsWidget(PlantSystem *plantSystem, SettingsManager *settings,
+                         HistoryIndex *history, HydrationAnalytics *analytics,
                          QWidget *parent)
-    : QWidget(parent), m_plantSystem(plantSystem), m_settings(settings) {
+    : QWidget(parent), m_plantSystem(plantSystem), m_settings(settings),
+      m_history(history), m_analytics(analytics), m_refreshPending(false) {
   setWindowFlags(Qt::Popup | Qt::FramelessWindowHint |
                  Qt::NoDropShadowWindowHint);
   setAttribute(Qt::WA_TranslucentBackground);
-  setFixedSize(280, 480); // 增加尺寸以容纳饮水记录列表
+  setFixedSize(280, 540); // 增加尺寸以容纳饮水记录列表和习惯分析
 
   QVBoxLayout *layout = new QVBoxLayout(this);
   layout->setContentsMargins(24, 24, 24, 24);
@@ -65,6 +72,14 @@ StatsWidget::StatsWidget(PlantSystem *plantSystem, SettingsManager *settings,
   m_growthLabel->setStyleSheet("font-size: 11px; color: #F5F5F5;");
   m_growthLabel->setAlignment(Qt::AlignCenter);
 
+  m_periodLabel = new QLabel(this);
+  m_periodLabel->setStyleSheet("font-size: 11px; color: #F5F5F5;");
+  m_periodLabel->setAlignment(Qt::AlignCenter);
+
+  m_insightLabel = new QLabel(this);
+  m_insightLabel->setStyleSheet("font-size: 11px; color: #F5F5F5;");
+  m_insightLabel->setAlignment(Qt::AlignCenter);
+
   // 饮水记录列表
   QLabel *recordTitle = new QLabel("今日饮水记录", this);
   recordTitle->setStyleSheet(
@@ -95,6 +110,8 @@ StatsWidget::StatsWidget(PlantSystem *plantSystem, SettingsManager *settings,
   layout->addWidget(m_harvestButton, 0, Qt::AlignCenter);
   layout->addWidget(m_harvestLabel);
   layout->addWidget(m_growthLabel);
+  layout->addWidget(m_periodLabel);
+  layout->addWidget(m_insightLabel);
   layout->addSpacing(8);
   layout->addWidget(recordTitle);
   layout->addWidget(m_recordList);
@@ -102,14 +119,30 @@ StatsWidget::StatsWidget(PlantSystem *plantSystem, SettingsManager *settings,
 
   refresh();
 
+  // 一杯水会先后触发 plantUpdated 与 updated，合并成一次刷新
   connect(m_plantSystem, &PlantSystem::plantUpdated, this,
-          &StatsWidget::refresh);
+          &StatsWidget::scheduleRefresh);
+  connect(m_analytics, &HydrationAnalytics::updated, this,
+          &StatsWidget::scheduleRefresh);
 
   // 阴影已改为在 paintEvent 中手动绘制,以完美贴合圆角
 }
 
+void StatsWidget::scheduleRefresh() {
+  if (m_refreshPending)
+    return;
+  m_refreshPending = true;
+  QTimer::singleShot(0, this, [this]() {
+    m_refreshPending = false;
+    refresh();
+  });
+}
+
 void StatsWidget::refresh() {
-  int intake = m_plantSystem->todayWaterIntake();
+  OASIS_TRACE_SCOPE("StatsWidget::refresh");
+  // 植物状态归状态线程所有，这里只读取一份快照
+  PlantSnapshotPtr plant = m_plantSystem->snapshot();
+  int intake = plant->todayWaterIntake();
   int goal = m_settings->dailyGoal();
   m_progressBar->setRange(0, goal);
   m_progressBar->setValue(intake);
@@ -119,7 +152,7 @@ void StatsWidget::refresh() {
   m_amountLabel->setText(QString::number(intake) + " / " +
                          QString::number(goal) + " ml");
 
-  int harvestCount = m_plantSystem->harvestCount();
+  int harvestCount = plant->state.harvestCount;
   if (harvestCount > 0) {
     m_harvestLabel->setText(QString("🏆 已收成: %1 次成果").arg(harvestCount));
     m_harvestLabel->show();
@@ -128,52 +161,55 @@ void StatsWidget::refresh() {
   }
 
   m_growthLabel->setText(
-      QString("当前代际成长值: %1 / 500").arg(m_plantSystem->growthValue()));
+      QString("当前代际成长值: %1 / %2")
+          .arg(plant->state.growthValue)
+          .arg(PlantModel::kHarvestGrowth));
+
+  QDate today = Clock::instance()->today();
+  qint64 weekTotal = HistoryQuery(m_history)
+                         .range(today.addDays(1 - today.dayOfWeek()), today)
+                         .sum();
+  qint64 monthTotal =
+      HistoryQuery(m_history)
+          .range(QDate(today.year(), today.month(), 1), today)
+          .sum();
+  m_periodLabel->setText(
+      QString("本周 %1 ml · 本月 %2 ml").arg(weekTotal).arg(monthTotal));
+
+  // 分析指标均为增量维护，这里只是读取
+  QStringList hours;
+  for (int hour : m_analytics->typicalHours())
+    hours << QString::number(hour);
+  m_insightLabel->setText(
+      QString("🔥 连续达标 %1 天 · 最长 %2 天\n"
+              "7日均 %3 ml · 30日均 %4 ml\n"
+              "达标率 %5% · 常喝时段 %6 点")
+          .arg(m_analytics->currentStreak())
+          .arg(m_analytics->longestStreak())
+          .arg(qRound(m_analytics->movingAverage7()))
+          .arg(qRound(m_analytics->movingAverage30()))
+          .arg(qRound(m_analytics->goalHitRate() * 100))
+          .arg(hours.isEmpty() ? QString("-") : hours.join("/")));
 
   // 更新饮水记录列表
   m_recordList->clear();
-  QList<PlantSystem::DrinkRecord> records = m_plantSystem->todayDrinkRecords();
+  const DrinkRecordStore &records = plant->todayDrinkRecords();
   if (records.isEmpty()) {
     m_recordList->addItem("暂无记录");
   } else {
-    // 倒序显示（最新的在上面）
+    // 倒序显示（最新的在上面），只在这里才转换为 QDateTime
     for (int i = records.size() - 1; i >= 0; --i) {
-      const auto &record = records[i];
-      QString timeStr = record.timestamp.toString("hh:mm");
-      QString text = QString("%1  %2 ml").arg(timeStr).arg(record.amount);
+      DrinkRecordView record = records.at(i);
+      QString timeStr = record.timestamp().toString("hh:mm");
+      QString text = QString("%1  %2 ml").arg(timeStr).arg(record.amount());
       m_recordList->addItem(text);
     }
   }
 
-  QString statusText;
-  QString iconText;
-  switch (m_plantSystem->status()) {
-  case PlantSystem::Seedling:
-    statusText = "状态: 萌芽期";
-    iconText = "🌱";
-    break;
-  case PlantSystem::Small:
-    statusText = "状态: 小苗期";
-    iconText = "🌿";
-    break;
-  case PlantSystem::Medium:
-    statusText = "状态: 成长期";
-    iconText = "🌳";
-    break;
-  case PlantSystem::Large:
-    statusText = "状态: 繁茂期";
-    iconText = "🌲";
-    break;
-  case PlantSystem::Flowering:
-    statusText = "状态: 开花期";
-    iconText = "🌸";
-    break;
-  case PlantSystem::Wilting:
-    statusText = "状态: 缺水枯萎";
-    iconText = "🍂";
-    break;
-  }
-  if (m_plantSystem->status() == PlantSystem::Flowering) {
+  PlantSystem::PlantStatus status = plant->status();
+  QString statusText = "状态: " + PlantModel::statusName(status);
+  QString iconText = PlantModel::statusIcon(status);
+  if (status == PlantSystem::Flowering) {
     statusText += " (满级)";
     m_harvestButton->show();
   } else {
@@ -184,6 +220,7 @@ void StatsWidget::refresh() {
 }
 
 void StatsWidget::paintEvent(QPaintEvent *event) {
+  OASIS_TRACE_SCOPE("StatsWidget::paintEvent");
   Q_UNUSED(event);
   QPainter painter(this);
   painter.setRenderHint(QPainter::Antialiasing);
@@ -1,6 +1,8 @@
 #ifndef STATS_WIDGET_HPP
 #define STATS_WIDGET_HPP
 
+#include "../core/history_index.hpp"
+#include "../core/hydration_analytics.hpp"
 #include "../core/plant_system.hpp"
 #include "../core/settings_manager.hpp"
 #include "components/circular_progress.hpp"
@@ -14,6 +16,7 @@ class StatsWidget : public QWidget {
   Q_OBJECT
 public:
   explicit StatsWidget(PlantSystem *plantSystem, SettingsManager *settings,
+                       HistoryIndex *history, HydrationAnalytics *analytics,
                        QWidget *parent = nullptr);
 
 public slots:
@@ -25,8 +28,12 @@ protected:
   void showEvent(QShowEvent *event) override;
 
 private:
+  void scheduleRefresh();
+
   PlantSystem *m_plantSystem;
   SettingsManager *m_settings;
+  HistoryIndex *m_history;
+  HydrationAnalytics *m_analytics;
   CircularProgressBar *m_progressBar;
   QLabel *m_percentLabel;
   QLabel *m_amountLabel;
@@ -34,7 +41,10 @@ private:
   QPushButton *m_harvestButton; // 收成按钮
   QLabel *m_harvestLabel;       // 收成勋章
   QLabel *m_growthLabel;
+  QLabel *m_periodLabel;  // 本周/本月累计
+  QLabel *m_insightLabel; // 连续达标、移动平均、达标率、常喝时段
   QListWidget *m_recordList; // 饮水记录列表
+  bool m_refreshPending;
 };
 
 #endif // STATS_WIDGET_HPP
@@ -0,0 +1,149 @@
+#include "tray_progress_icon.hpp"
+#include "../core/logging.hpp"
+#include "../core/trace.hpp"
+#include <QDir>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPalette>
+#include <QPixmap>
+#include <QScreen>
+#include <QStandardPaths>
+#include <QSystemTrayIcon>
+#include <QtConcurrent>
+#include <QtMath>
+
+namespace {
+
+// 各平台托盘常见的逻辑尺寸；QIcon 按面板实际请求的大小挑选
+const int kSizes[] = {16, 22, 24, 32, 48, 64};
+const int kSizeCount = sizeof(kSizes) / sizeof(kSizes[0]);
+const int kRenderVersion = 1; // 改动画法后递增，旧缓存自动失效
+
+struct FrameSpec {
+  bool dark;
+  qreal dpr;
+  QString cachePath;
+};
+
+// 一张图集：每行一种尺寸，每列一个档位，格子按最大尺寸对齐
+int cellSize(qreal dpr) { return qCeil(kSizes[kSizeCount - 1] * dpr); }
+
+void paintCup(QPainter *painter, const QRectF &rect, int percent, bool dark) {
+  const qreal s = rect.width();
+  const qreal pen = qMax<qreal>(1.0, s / 16);
+  QPainterPath cup;
+  cup.moveTo(rect.left() + s * 0.14, rect.top() + s * 0.12);
+  cup.lineTo(rect.left() + s * 0.86, rect.top() + s * 0.12);
+  cup.lineTo(rect.left() + s * 0.76, rect.top() + s * 0.92);
+  cup.lineTo(rect.left() + s * 0.24, rect.top() + s * 0.92);
+  cup.closeSubpath();
+
+  painter->setRenderHint(QPainter::Antialiasing);
+  painter->setPen(Qt::NoPen);
+  painter->setBrush(dark ? QColor(255, 255, 255, 40) : QColor(255, 255, 255,
+                                                              170));
+  painter->drawPath(cup);
+
+  // 水位：达标后换成莫兰迪绿
+  if (percent > 0) {
+    const qreal top = rect.top() + s * 0.12;
+    const qreal bottom = rect.top() + s * 0.92;
+    const qreal level = bottom - (bottom - top) * percent / 100.0;
+    painter->save();
+    painter->setClipPath(cup);
+    painter->setBrush(percent >= 100 ? QColor("#A7B9A4")
+                                     : (dark ? QColor("#8FC3E0")
+                                             : QColor("#5B9BC2")));
+    painter->drawRect(QRectF(rect.left(), level, s, bottom - level));
+    painter->restore();
+  }
+
+  QPen outline(dark ? QColor("#E0E0E0") : QColor("#4A4A4A"), pen);
+  outline.setJoinStyle(Qt::RoundJoin);
+  painter->setPen(outline);
+  painter->setBrush(Qt::NoBrush);
+  painter->drawPath(cup);
+}
+
+// 在工作线程中运行：先读磁盘缓存，没有或尺寸不符时重画并写回
+QImage loadOrRender(const FrameSpec &spec) {
+  OASIS_TRACE_SCOPE("TrayProgressIcon::loadOrRender");
+  const int cell = cellSize(spec.dpr);
+  const QSize atlasSize(cell * TrayProgressIcon::kFrameCount,
+                        cell * kSizeCount);
+  QImage atlas(spec.cachePath);
+  if (atlas.size() == atlasSize)
+    return atlas.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+  atlas = QImage(atlasSize, QImage::Format_ARGB32_Premultiplied);
+  atlas.fill(Qt::transparent);
+  QPainter painter(&atlas);
+  for (int row = 0; row < kSizeCount; ++row) {
+    const qreal side = kSizes[row] * spec.dpr;
+    for (int frame = 0; frame < TrayProgressIcon::kFrameCount; ++frame)
+      paintCup(&painter, QRectF(frame * cell, row * cell, side, side),
+               frame * TrayProgressIcon::kStepPercent, spec.dark);
+  }
+  painter.end();
+
+  QDir().mkpath(QFileInfo(spec.cachePath).absolutePath());
+  if (!atlas.save(spec.cachePath, "PNG"))
+    qCWarning(lcApp) << "无法缓存托盘图标:" << spec.cachePath;
+  return atlas;
+}
+
+} // namespace
+
+TrayProgressIcon::TrayProgressIcon(QSystemTrayIcon *tray, QObject *parent)
+    : QObject(parent), m_tray(tray), m_bucket(-1), m_shown(-1) {
+  FrameSpec spec;
+  spec.dark =
+      QGuiApplication::palette().color(QPalette::Window).lightness() < 128;
+  spec.dpr = 1.0;
+  for (QScreen *screen : QGuiApplication::screens())
+    spec.dpr = qMax(spec.dpr, screen->devicePixelRatio());
+  spec.cachePath =
+      QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+          .filePath(QString("tray/cup-v%1-%2-%3x.png")
+                        .arg(kRenderVersion)
+                        .arg(spec.dark ? "dark" : "light")
+                        .arg(qRound(spec.dpr * 100) / 100.0));
+
+  connect(&m_watcher, &QFutureWatcher<QImage>::finished, this,
+          &TrayProgressIcon::onFramesReady);
+  m_watcher.setFuture(QtConcurrent::run(loadOrRender, spec));
+}
+
+void TrayProgressIcon::setProgress(int current, int goal) {
+  int percent = qBound(0, current * 100 / (goal > 0 ? goal : 1), 100);
+  m_bucket = percent / kStepPercent;
+  if (m_frames.isEmpty() || m_bucket == m_shown)
+    return;
+  m_tray->setIcon(m_frames[m_bucket]);
+  m_shown = m_bucket;
+}
+
+void TrayProgressIcon::onFramesReady() {
+  // QPixmap 只能在界面线程创建，这里切图集并组装每一档的 QIcon
+  const QImage atlas = m_watcher.result();
+  if (atlas.isNull())
+    return;
+  const int cell = atlas.height() / kSizeCount;
+  const qreal dpr = qreal(cell) / kSizes[kSizeCount - 1];
+  m_frames.resize(kFrameCount);
+  for (int frame = 0; frame < kFrameCount; ++frame) {
+    for (int row = 0; row < kSizeCount; ++row) {
+      const int side = qCeil(kSizes[row] * dpr);
+      QPixmap pixmap = QPixmap::fromImage(
+          atlas.copy(frame * cell, row * cell, side, side));
+      pixmap.setDevicePixelRatio(dpr);
+      m_frames[frame].addPixmap(pixmap);
+    }
+  }
+  if (m_bucket >= 0) {
+    m_tray->setIcon(m_frames[m_bucket]);
+    m_shown = m_bucket;
+  }
+}
@@ -0,0 +1,35 @@
+#ifndef TRAY_PROGRESS_ICON_HPP
+#define TRAY_PROGRESS_ICON_HPP
+
+#include <QFutureWatcher>
+#include <QIcon>
+#include <QImage>
+#include <QObject>
+#include <QVector>
+
+class QSystemTrayIcon;
+
+// 托盘图标显示今日进度 (杯中水位)。每 5% 一帧、每种托盘尺寸一张，
+// 启动时在后台一次画好并按主题与 DPI 缓存到磁盘；进度只在跨过 5% 档位
+// 时才换图标，其余时候不触碰托盘。
+class TrayProgressIcon : public QObject {
+  Q_OBJECT
+public:
+  static const int kStepPercent = 5;
+  static const int kFrameCount = 100 / kStepPercent + 1;
+
+  explicit TrayProgressIcon(QSystemTrayIcon *tray, QObject *parent = nullptr);
+
+  void setProgress(int current, int goal);
+
+private:
+  void onFramesReady();
+
+  QSystemTrayIcon *m_tray;
+  QVector<QIcon> m_frames; // 按档位，帧未就绪时为空
+  QFutureWatcher<QImage> m_watcher;
+  int m_bucket;    // 期望显示的档位
+  int m_shown;     // 托盘上当前的档位，-1 表示仍是默认图标
+};
+
+#endif // TRAY_PROGRESS_ICON_HPP
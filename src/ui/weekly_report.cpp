@@ -0,0 +1,246 @@
+#include "weekly_report.hpp"
+#include "../core/history_query.hpp"
+#include "../core/logging.hpp"
+#include "../core/trace.hpp"
+#include "components/circular_progress.hpp"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFontDatabase>
+#include <QFutureWatcher>
+#include <QPainter>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+namespace {
+const int kReportVersion = 1; // 版式变化时递增，让旧文件失效
+const int kWidth = 600;
+const int kHeight = 340;
+const int kMargin = 24;
+const char *const kWeekdays[7] = {"一", "二", "三", "四", "五", "六", "日"};
+
+struct RenderResult {
+  QString path;
+  QString error;
+  bool cached;
+};
+
+// 在工作线程中执行：同一内容的文件已存在时不再渲染
+RenderResult renderJob(const QString &dir, const WeeklyReportData &data,
+                       const QByteArray &hash) {
+  RenderResult result;
+  result.cached = false;
+  QDir reportDir(dir);
+  if (!reportDir.mkpath(".")) {
+    result.error = QString("无法创建目录 %1").arg(dir);
+    return result;
+  }
+  const QString prefix =
+      QString("week-%1-").arg(data.weekStart.toString("yyyy-MM-dd"));
+  const QString path = reportDir.filePath(
+      prefix + QString::fromLatin1(hash.left(12)) + ".png");
+  if (QFile::exists(path)) {
+    result.path = path;
+    result.cached = true;
+    return result;
+  }
+
+  QImage image = WeeklyReportRenderer::render(data);
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly) || !image.save(&file, "PNG") ||
+      !file.commit()) {
+    result.error = file.errorString();
+    return result;
+  }
+  result.path = path;
+
+  // 同一周的旧版本已过时
+  const QStringList stale =
+      reportDir.entryList(QStringList() << prefix + "*.png", QDir::Files);
+  for (const QString &name : stale) {
+    if (reportDir.filePath(name) != path)
+      reportDir.remove(name);
+  }
+  return result;
+}
+} // namespace
+
+WeeklyReportData::WeeklyReportData() : streak(0) {
+  for (int i = 0; i < 7; ++i) {
+    totals[i] = 0;
+    goals[i] = 0;
+  }
+}
+
+void WeeklyReportData::fillWeek(
+    const HistoryIndex *index, const QDate &monday,
+    const std::function<int(const QDate &)> &goalForDay) {
+  weekStart = monday;
+  QVector<qint64> days = HistoryQuery(index)
+                             .range(monday, monday.addDays(6))
+                             .groupBy(HistoryQuery::ByDay)
+                             .totals();
+  for (int i = 0; i < 7; ++i) {
+    totals[i] = i < days.size() ? int(days[i]) : 0;
+    goals[i] = goalForDay(monday.addDays(i));
+  }
+}
+
+QByteArray WeeklyReportData::contentHash() const {
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+  out << qint32(kReportVersion) << qint32(WeeklyReportRenderer::kPixelRatio)
+      << qint64(weekStart.toJulianDay());
+  for (int i = 0; i < 7; ++i)
+    out << qint32(totals[i]) << qint32(goals[i]);
+  out << qint32(streak) << plantIcon << plantStatus;
+  return QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex();
+}
+
+WeeklyReportRenderer::WeeklyReportRenderer(const QString &dir,
+                                           QObject *parent)
+    : QObject(parent), m_dir(dir), m_pool(new QThreadPool(this)) {
+  m_pool->setMaxThreadCount(1);
+}
+
+WeeklyReportRenderer::~WeeklyReportRenderer() {
+  m_pool->clear();
+  m_pool->waitForDone();
+}
+
+void WeeklyReportRenderer::request(const WeeklyReportData &data) {
+  const QByteArray hash = data.contentHash();
+  if (m_pending.contains(hash))
+    return;
+
+  const QDate weekStart = data.weekStart;
+  auto deliver = [this, weekStart, hash](const RenderResult &result) {
+    m_pending.remove(hash);
+    if (result.path.isEmpty()) {
+      qCWarning(lcApp) << "Weekly report for" << weekStart
+                       << "failed:" << result.error;
+      emit reportFailed(weekStart, result.error);
+      return;
+    }
+    qCDebug(lcApp) << "Weekly report for" << weekStart
+                   << (result.cached ? "reused" : "written to")
+                   << result.path;
+    emit reportReady(weekStart, result.path, result.cached);
+  };
+
+  // 平台不支持在非 GUI 线程排版文字时只能就地渲染
+  if (!QFontDatabase::supportsThreadedFontRendering()) {
+    deliver(renderJob(m_dir, data, hash));
+    return;
+  }
+
+  m_pending.insert(hash);
+  QFutureWatcher<RenderResult> *watcher =
+      new QFutureWatcher<RenderResult>(this);
+  connect(watcher, &QFutureWatcher<RenderResult>::finished, this,
+          [watcher, deliver]() {
+            deliver(watcher->result());
+            watcher->deleteLater();
+          });
+  watcher->setFuture(QtConcurrent::run(m_pool, renderJob, m_dir, data, hash));
+}
+
+QImage WeeklyReportRenderer::render(const WeeklyReportData &data) {
+  OASIS_TRACE_SCOPE("WeeklyReportRenderer::render");
+  QImage image(QSize(kWidth, kHeight) * kPixelRatio,
+               QImage::Format_ARGB32_Premultiplied);
+  image.setDevicePixelRatio(kPixelRatio);
+  image.fill(Qt::transparent);
+
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing);
+
+  qint64 weekTotal = 0;
+  qint64 weekGoal = 0;
+  int hitDays = 0;
+  int maxValue = 1;
+  for (int i = 0; i < 7; ++i) {
+    weekTotal += data.totals[i];
+    weekGoal += data.goals[i];
+    if (data.goals[i] > 0 && data.totals[i] >= data.goals[i])
+      ++hitDays;
+    maxValue = qMax(maxValue, qMax(data.totals[i], data.goals[i]));
+  }
+
+  // 卡片底色与统计面板一致
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(QColor(179, 193, 161)); // #B3C1A1 莫兰迪鼠尾草绿
+  painter.drawRoundedRect(QRectF(0, 0, kWidth, kHeight), 12, 12);
+
+  // 标题与日期
+  QFont font = painter.font();
+  font.setPixelSize(18);
+  font.setBold(true);
+  painter.setFont(font);
+  painter.setPen(Qt::white);
+  QRectF header(kMargin, 16, kWidth - 2 * kMargin, 28);
+  painter.drawText(header, Qt::AlignLeft | Qt::AlignVCenter, "本周饮水报告");
+  font.setPixelSize(12);
+  font.setBold(false);
+  painter.setFont(font);
+  painter.drawText(header, Qt::AlignRight | Qt::AlignVCenter,
+                   QString("%1 – %2")
+                       .arg(data.weekStart.toString("yyyy-MM-dd"))
+                       .arg(data.weekStart.addDays(6).toString("MM-dd")));
+
+  // 左侧：本周完成度圆环，圆心是植物
+  const double fraction = weekGoal > 0 ? double(weekTotal) / weekGoal : 0.0;
+  QRectF ring(kMargin, 60, 170, 170);
+  CircularProgressBar::paint(painter, ring, fraction, data.plantIcon, 44, 10);
+  font.setPixelSize(14);
+  font.setBold(true);
+  painter.setFont(font);
+  painter.drawText(QRectF(kMargin, 236, 170, 22), Qt::AlignCenter,
+                   QString("完成 %1%").arg(qRound(fraction * 100)));
+  font.setPixelSize(12);
+  font.setBold(false);
+  painter.setFont(font);
+  painter.drawText(QRectF(kMargin, 258, 170, 18), Qt::AlignCenter,
+                   QString("%1 / %2 L")
+                       .arg(weekTotal / 1000.0, 0, 'f', 1)
+                       .arg(weekGoal / 1000.0, 0, 'f', 1));
+
+  // 右侧：每日柱状图，虚线为当日目标
+  QRectF chart(230, 64, kWidth - 230 - kMargin, 180);
+  const double slot = chart.width() / 7;
+  const double barWidth = slot * 0.5;
+  for (int i = 0; i < 7; ++i) {
+    const double x = chart.left() + slot * i;
+    const bool hit = data.goals[i] > 0 && data.totals[i] >= data.goals[i];
+    const double barHeight = chart.height() * data.totals[i] / maxValue;
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(hit ? QColor("#5A6B58") : QColor(255, 255, 255, 160));
+    painter.drawRoundedRect(QRectF(x + (slot - barWidth) / 2,
+                                   chart.bottom() - barHeight, barWidth,
+                                   barHeight),
+                            4, 4);
+    if (data.goals[i] > 0) {
+      const double y =
+          chart.bottom() - chart.height() * data.goals[i] / maxValue;
+      painter.setPen(QPen(QColor(255, 255, 255, 200), 1, Qt::DashLine));
+      painter.drawLine(QPointF(x + 4, y), QPointF(x + slot - 4, y));
+    }
+    painter.setPen(Qt::white);
+    painter.drawText(QRectF(x, chart.bottom() + 4, slot, 16), Qt::AlignCenter,
+                     QString::fromUtf8(kWeekdays[i]));
+  }
+
+  // 底部：连续达标、本周达标天数与植物状态
+  QRectF footer(kMargin, kHeight - 48, kWidth - 2 * kMargin, 24);
+  font.setPixelSize(13);
+  painter.setFont(font);
+  painter.drawText(footer, Qt::AlignLeft | Qt::AlignVCenter,
+                   QString("🔥 连续达标 %1 天").arg(data.streak));
+  painter.drawText(footer, Qt::AlignHCenter | Qt::AlignVCenter,
+                   QString("本周达标 %1/7 天").arg(hitDays));
+  painter.drawText(footer, Qt::AlignRight | Qt::AlignVCenter,
+                   QString("植物状态: %1").arg(data.plantStatus));
+  return image;
+}
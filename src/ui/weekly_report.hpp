@@ -0,0 +1,57 @@
+#ifndef WEEKLY_REPORT_HPP
+#define WEEKLY_REPORT_HPP
+
+#include <QDate>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <functional>
+
+class HistoryIndex;
+class QThreadPool;
+
+// 一份周报需要的全部内容；渲染结果只取决于这些字段
+struct WeeklyReportData {
+  QDate weekStart;  // 周一
+  int totals[7];    // 周一..周日的饮水量 (ml)
+  int goals[7];     // 当日生效的目标 (ml)
+  int streak;       // 连续达标天数
+  QString plantIcon;
+  QString plantStatus;
+
+  WeeklyReportData();
+  // 从历史索引取出 monday 开始一周的每日总量与目标
+  void fillWeek(const HistoryIndex *index, const QDate &monday,
+                const std::function<int(const QDate &)> &goalForDay);
+  QByteArray contentHash() const;
+};
+
+// 周报卡片：完成度圆环 + 每日柱状图 + 连续达标 + 植物状态，保存为 PNG。
+// 渲染在工作线程中用 QPainter 画到 QImage 上，托盘不会因此卡顿；
+// 文件名带内容哈希，内容没变的周直接复用已有文件。
+class WeeklyReportRenderer : public QObject {
+  Q_OBJECT
+public:
+  explicit WeeklyReportRenderer(const QString &dir = "reports",
+                                QObject *parent = nullptr);
+  ~WeeklyReportRenderer();
+
+  static const int kPixelRatio = 2; // PNG 按 2 倍像素密度输出
+
+  void request(const WeeklyReportData &data);
+
+  // 纯绘制，可在任意线程调用
+  static QImage render(const WeeklyReportData &data);
+
+signals:
+  // cached 为 true 表示内容未变，沿用了之前生成的文件
+  void reportReady(const QDate &weekStart, const QString &path, bool cached);
+  void reportFailed(const QDate &weekStart, const QString &error);
+
+private:
+  QString m_dir;
+  QThreadPool *m_pool;
+  QSet<QByteArray> m_pending; // 渲染中的内容哈希
+};
+
+#endif // WEEKLY_REPORT_HPP
@@ -0,0 +1,145 @@
+// oasis-notifier：每个登录会话中运行的提醒接收端，配合 `Oasis --daemon`。
+//
+//   oasis-notifier            收到提醒时调用 notify-send 弹出桌面通知
+//   oasis-notifier --tty      只在终端打印并响铃 (SSH、终端服务器)
+//   oasis-notifier --reload   让守护进程重新读取本用户的设置后退出
+//
+// 不依赖 Qt，平时只阻塞在一个套接字的 read 上；守护进程重启后自动重连。
+#include "../src/daemon/daemon_protocol.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const unsigned kMaxBackoffSecs = 60;
+
+int connectTo(const std::string &path) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path))
+    return -1;
+  std::strcpy(address.sun_path, path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  fcntl(fd, F_SETFD, FD_CLOEXEC); // 不要泄露给 notify-send
+  if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) !=
+      0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+std::vector<std::string> splitTabs(const std::string &line) {
+  std::vector<std::string> fields;
+  size_t start = 0;
+  for (;;) {
+    size_t tab = line.find('\t', start);
+    fields.push_back(line.substr(start, tab - start));
+    if (tab == std::string::npos)
+      return fields;
+    start = tab + 1;
+  }
+}
+
+void deliver(const std::string &line, bool tty) {
+  std::vector<std::string> fields = splitTabs(line);
+  if (fields.size() < 4 || fields[0] != OasisDaemon::kRemind)
+    return;
+  const std::string &title = fields[2];
+  const std::string &body = fields[3];
+  if (tty) {
+    std::printf("\a[Oasis] %s %s (%s ml)\n", title.c_str(), body.c_str(),
+                fields[1].c_str());
+    std::fflush(stdout);
+    return;
+  }
+  // SIGCHLD 已忽略，子进程退出后由内核回收
+  if (fork() == 0) {
+    execlp("notify-send", "notify-send", "-a", "Oasis", title.c_str(),
+           body.c_str(), static_cast<char *>(nullptr));
+    _exit(127);
+  }
+}
+
+void printUsage() {
+  std::fprintf(stderr,
+               "用法: oasis-notifier [--tty] [--reload] [--socket PATH]\n");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  bool tty = false;
+  bool reload = false;
+  std::string path = OasisDaemon::kDefaultSocketPath;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--tty") == 0) {
+      tty = true;
+    } else if (std::strcmp(argv[i], "--reload") == 0) {
+      reload = true;
+    } else if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+      path = argv[++i];
+    } else {
+      printUsage();
+      return 2;
+    }
+  }
+
+  if (reload) {
+    int fd = connectTo(path);
+    if (fd < 0) {
+      std::fprintf(stderr, "无法连接守护进程: %s\n", path.c_str());
+      return 1;
+    }
+    std::string request = std::string(OasisDaemon::kReload) + "\n";
+    bool ok = write(fd, request.data(), request.size()) ==
+              static_cast<ssize_t>(request.size());
+    close(fd);
+    return ok ? 0 : 1;
+  }
+
+  std::signal(SIGCHLD, SIG_IGN);
+  std::signal(SIGPIPE, SIG_IGN);
+  unsigned backoff = 1;
+  for (;;) {
+    int fd = connectTo(path);
+    if (fd < 0) {
+      sleep(backoff);
+      backoff = backoff * 2 > kMaxBackoffSecs ? kMaxBackoffSecs : backoff * 2;
+      continue;
+    }
+    backoff = 1;
+
+    std::string pending;
+    char buffer[1024];
+    for (;;) {
+      ssize_t n = read(fd, buffer, sizeof(buffer));
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        break;
+      pending.append(buffer, static_cast<size_t>(n));
+      size_t newline;
+      while ((newline = pending.find('\n')) != std::string::npos) {
+        deliver(pending.substr(0, newline), tty);
+        pending.erase(0, newline + 1);
+      }
+      if (pending.size() > static_cast<size_t>(OasisDaemon::kMaxLineBytes))
+        pending.clear();
+    }
+    close(fd);
+  }
+}
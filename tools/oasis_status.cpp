@@ -0,0 +1,116 @@
+// oasis-status：读取共享内存状态页，供 waybar / polybar / i3blocks 调用。
+//
+//   oasis-status              1250/2000ml 62% 成长期 · 下次 14:30
+//   oasis-status --json       waybar 自定义模块使用的 JSON
+//   oasis-status --field intake|goal|percent|status|next
+//
+// 不依赖 Qt，只做一次 open + mmap。
+#include "../src/core/status_page.hpp"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+namespace {
+
+int percentOf(const OasisStatus::Snapshot &s) {
+  return s.goalMl > 0 ? s.intakeMl * 100 / s.goalMl : 0;
+}
+
+std::string clockTime(int64_t epoch) {
+  if (epoch <= 0)
+    return "";
+  time_t t = static_cast<time_t>(epoch);
+  struct tm local;
+  localtime_r(&t, &local);
+  char buf[8];
+  std::strftime(buf, sizeof(buf), "%H:%M", &local);
+  return buf;
+}
+
+std::string jsonEscape(const char *text) {
+  std::string out;
+  for (const char *p = text; *p; ++p) {
+    if (*p == '"' || *p == '\\')
+      out += '\\';
+    out += *p;
+  }
+  return out;
+}
+
+void printUsage() {
+  std::fprintf(stderr,
+               "用法: oasis-status [--json] [--field "
+               "intake|goal|percent|status|next] [--path FILE]\n");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  bool json = false;
+  const char *field = nullptr;
+  std::string path = OasisStatus::defaultPath();
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (std::strcmp(argv[i], "--field") == 0 && i + 1 < argc) {
+      field = argv[++i];
+    } else if (std::strcmp(argv[i], "--path") == 0 && i + 1 < argc) {
+      path = argv[++i];
+    } else {
+      printUsage();
+      return 2;
+    }
+  }
+
+  const OasisStatus::Page *page = OasisStatus::attach(path);
+  OasisStatus::Snapshot s;
+  if (!page || !OasisStatus::read(page, &s)) {
+    // 未运行时输出空文本，状态栏模块随之隐藏
+    if (json)
+      std::printf("{\"text\":\"\",\"class\":\"stopped\"}\n");
+    return 1;
+  }
+  OasisStatus::detach(page);
+
+  const int percent = percentOf(s);
+  const std::string next = clockTime(s.nextReminderAt);
+
+  if (field) {
+    if (std::strcmp(field, "intake") == 0)
+      std::printf("%d\n", s.intakeMl);
+    else if (std::strcmp(field, "goal") == 0)
+      std::printf("%d\n", s.goalMl);
+    else if (std::strcmp(field, "percent") == 0)
+      std::printf("%d\n", percent);
+    else if (std::strcmp(field, "status") == 0)
+      std::printf("%s\n", s.statusName);
+    else if (std::strcmp(field, "next") == 0)
+      std::printf("%s\n", next.c_str());
+    else {
+      printUsage();
+      return 2;
+    }
+    return 0;
+  }
+
+  std::string text = std::to_string(s.intakeMl) + "/" +
+                     std::to_string(s.goalMl) + "ml " +
+                     std::to_string(percent) + "%";
+  std::string detail = s.statusName;
+  if (s.paused)
+    detail += " · 已暂停";
+  else if (!next.empty())
+    detail += " · 下次 " + next;
+
+  if (json) {
+    std::printf("{\"text\":\"%s\",\"tooltip\":\"%s\",\"percentage\":%d,"
+                "\"class\":\"%s\"}\n",
+                jsonEscape(text.c_str()).c_str(),
+                jsonEscape(detail.c_str()).c_str(), percent > 100 ? 100 : percent,
+                s.paused ? "paused" : (percent >= 100 ? "done" : "active"));
+  } else {
+    std::printf("%s %s\n", text.c_str(), detail.c_str());
+  }
+  return 0;
+}